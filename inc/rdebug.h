@@ -73,7 +73,8 @@ namespace rdebug {
 	///
 	bool init(rtmLibInterface* _libInterface = 0);
 
-	/// Shut down rdebug library and release internal resources
+	/// Shut down rdebug library and release internal resources, worker threads included.
+	/// Call once all the resolvers are deleted.
 	///
 	void shutDown(); 
 
@@ -83,15 +84,66 @@ namespace rdebug {
 	///
 	void symbolSetServerSource(const char* _symStore);
 
+	/// Sets directory for symbol cache files, caching is off until it's set. Symbol tables of each module
+	/// are written there once built, and mapped as they are by resolvers created later. Line tables are
+	/// included for modules without a compilation unit index, others decode units as addresses hit them.
+	/// Directory has to exist, files are named after the module and its build ID.
+	///
+	/// @param _cachePath
+	///
+	void symbolSetCachePath(const char* _cachePath);
+
+	/// Sets memory budget for decoded DWARF line and inline tables of each module, 256MB by default.
+	/// Tables are decoded per compilation unit as addresses hit them, units that weren't used recently
+	/// are dropped once the budget is exceeded and decoded again if needed.
+	///
+	/// @param _bytes
+	///
+	void symbolSetDwarfCacheSize(uint64_t _bytes);
+
+	/// Sets directories searched for separate debug files of stripped ELF modules, separated by ';'.
+	/// Files are looked up by build ID in .build-id subdirectory and by .gnu_debuglink name, same as GDB.
+	/// Defaults to /usr/lib/debug on Linux. Modules without a debug file fall back to function symbols
+	/// from their MiniDebugInfo (.gnu_debugdata) section, if they have one.
+	///
+	/// @param _debugFilePath
+	///
+	void symbolSetDebugFilePath(const char* _debugFilePath);
+
 	/// Creates debug symbol resolver based on 
 	///
 	/// @param _moduleInfos
 	/// @param _numInfos
 	/// @param _tc
 	/// @param _executable
+	/// @param _callback		Called for each module with loaded symbols, modules are set up on worker threads
+	///							so it can be called from any of them, but never from two at the same time
+	/// @param _data
 	///
 	uintptr_t symbolResolverCreate(ModuleInfo* _moduleInfos, uint32_t _numInfos, const char* _executable, module_load_cb _callback = 0, void* _data = 0);
 
+	/// Query behaviour for modules whose symbols are still being loaded, see symbolResolverCreateAsync
+	struct SymbolLoad
+	{
+		enum Enum
+		{
+			Wait,	// query loads symbols of that module, or waits for the loader to finish them
+			Skip	// query returns right away, frame has module name and offset within the module
+		};
+	};
+
+	/// Same as symbolResolverCreate, but returns without loading symbols. Symbols of all modules are
+	/// loaded in the background, a query waits for the module it needs only or skips it, depending on _onQuery.
+	///
+	/// @param _moduleInfos
+	/// @param _numInfos
+	/// @param _executable
+	/// @param _onQuery
+	/// @param _callback		Called from loader threads as each module with symbols gets loaded, never from two at the same time
+	/// @param _data
+	///
+	uintptr_t symbolResolverCreateAsync(ModuleInfo* _moduleInfos, uint32_t _numInfos, const char* _executable, SymbolLoad::Enum _onQuery, module_load_cb _callback = 0, void* _data = 0);
+
 	/// Creates debug symbol resolver based on 
 	///
 	uintptr_t symbolResolverCreateForCurrentProcess();
@@ -110,6 +162,50 @@ namespace rdebug {
 	///
 	void symbolResolverGetFrame(uintptr_t _resolver, uint64_t _address, StackFrame* _frame);
 
+	/// Same as symbolResolverGetFrame for an address captured at a given time. Modules are matched by
+	/// their load and unload times as well, so modules loaded at the same address one after another
+	/// (a plugin unloaded and loaded again) are told apart.
+	///
+	/// @param _resolver
+	/// @param _address
+	/// @param _operationTime	Time the address was captured at, same time base as ModuleInfo load/unload times
+	/// @param _frame
+	///
+	void symbolResolverGetFrameAtTime(uintptr_t _resolver, uint64_t _address, uint64_t _operationTime, StackFrame* _frame);
+
+	/// Resolves an array of addresses, frame at each index corresponds to the address at the same index.
+	/// Addresses are sorted, deduplicated and grouped per module internally, so this is much faster than
+	/// calling symbolResolverGetFrame for each address when there are many of them.
+	///
+	/// @param _resolver
+	/// @param _addresses
+	/// @param _frames
+	/// @param _numAddresses
+	///
+	void symbolResolverGetFrames(uintptr_t _resolver, const uint64_t* _addresses, StackFrame* _frames, uint32_t _numAddresses);
+
+	/// Same as symbolResolverGetFrames, with the work spread over a pool of worker threads.
+	/// Addresses of each module are split into chunks, workers that run out of chunks steal them from others.
+	///
+	/// @param _resolver
+	/// @param _addresses
+	/// @param _frames
+	/// @param _numAddresses
+	/// @param _numThreads		Number of worker threads, 0 for one per hardware thread
+	///
+	void symbolResolverGetFramesParallel(uintptr_t _resolver, const uint64_t* _addresses, StackFrame* _frames, uint32_t _numAddresses, uint32_t _numThreads = 0);
+
+	/// Resolves address to a chain of inlined calls, innermost function first.
+	/// First frame is the same as the one returned by symbolResolverGetFrame, each next
+	/// frame is the caller with file and line of the call site. Returns number of frames written.
+	///
+	/// @param _resolver
+	/// @param _address
+	/// @param _frames
+	/// @param _maxFrames
+	///
+	uint32_t symbolResolverGetInlineFrames(uintptr_t _resolver, uint64_t _address, StackFrame* _frames, uint32_t _maxFrames);
+
 	/// Creates debug symbol resolver based on 
 	///
 	/// @param _resolver
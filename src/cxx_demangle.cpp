@@ -0,0 +1,2760 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <rdebug_pch.h>
+#include <rdebug/src/cxx_demangle.h>
+
+// Itanium C++ ABI demangler, see https://itanium-cxx-abi.github.io/cxx-abi/abi.html#mangling
+// Mangled name is parsed into a small tree held in a fixed size pool, the tree is then printed
+// to the output buffer. Substitutions and template parameters are references to earlier nodes,
+// so nothing is ever copied and no memory is allocated. Formatting follows c++filt (libiberty).
+
+namespace rdebug {
+
+enum CxxNodeKind
+{
+	CXX_NAME,				// m_str, m_len
+	CXX_NAME_NUMBER,		// m_str followed by number in m_len
+	CXX_STD_ABBREVIATION,	// m_str, m_len, m_a is base name used for constructors
+	CXX_NESTED,				// m_a::m_b
+	CXX_TEMPLATE,			// m_a<m_b>
+	CXX_LIST,				// m_len elements starting at m_index in reference pool
+	CXX_PACK,				// template argument pack, same layout as list
+	CXX_QUALIFIED,			// m_a with m_cv qualifiers
+	CXX_POINTER,			// m_a*
+	CXX_REFERENCE,			// m_a& or m_a&& (m_ref)
+	CXX_FUNCTION,			// function type, m_a return type, m_b parameters, m_cv, m_ref, m_flag noexcept
+	CXX_ENCODING,			// function, m_a return type (optional), m_b parameters, m_c name, m_cv, m_ref
+	CXX_ARRAY,				// m_a element type, m_b dimension (optional)
+	CXX_POINTER_TO_MEMBER,	// m_a class type, m_b member type
+	CXX_VECTOR,				// m_a element type, m_b dimension
+	CXX_CTOR_DTOR,			// m_a is class name, m_flag set for destructor
+	CXX_SPECIAL,			// m_str prefix, m_a; without prefix m_a for m_b
+	CXX_CTOR_VTABLE,		// m_a in m_b
+	CXX_LAMBDA,				// m_b parameters, m_len number
+	CXX_UNNAMED_TYPE,		// m_len number
+	CXX_ABI_TAG,			// m_a[abi:m_str]
+	CXX_LOCAL,				// m_a::m_b, m_a is an encoding
+	CXX_CONVERSION,			// operator m_a
+	CXX_OPERATOR,			// operator m_str
+	CXX_STRUCT_BINDING,		// [m_b]
+	CXX_TEMPLATE_PARAM,		// m_len index, resolved against template arguments in scope when printed
+	CXX_PACK_EXPANSION,		// m_a...
+	CXX_LITERAL,			// m_a type, m_str value
+	CXX_FUNCTION_PARAM,		// {parm#m_len}
+	CXX_ENCLOSED,			// m_str(m_a)
+	CXX_SIZEOF_PACK,		// sizeof...(m_a), printed as pack length when m_a is a known pack
+	CXX_UNARY,				// m_str operator, m_a
+	CXX_BINARY,				// m_a m_str m_b
+	CXX_TERNARY,			// m_a ? m_b : m_c
+	CXX_CALL,				// m_a(m_b)
+	CXX_CAST,				// (m_a)m_b
+	CXX_CLONE				// m_a [clone m_str]
+};
+
+enum CxxQualifier
+{
+	CXX_CONST		= 1,
+	CXX_VOLATILE	= 2,
+	CXX_RESTRICT	= 4
+};
+
+enum CxxLiteralKind
+{
+	CXX_LIT_DEFAULT,
+	CXX_LIT_INT,
+	CXX_LIT_UNSIGNED,
+	CXX_LIT_LONG,
+	CXX_LIT_UNSIGNED_LONG,
+	CXX_LIT_LONG_LONG,
+	CXX_LIT_UNSIGNED_LONG_LONG,
+	CXX_LIT_BOOL
+};
+
+struct CxxNode
+{
+	uint8_t				m_kind;
+	uint8_t				m_cv;
+	uint8_t				m_ref;			// 1 - lvalue, 2 - rvalue
+	uint8_t				m_flag;
+	uint32_t			m_len;
+	uint32_t			m_index;
+	union
+	{
+		const char*		m_str;
+		const CxxNode*	m_c;
+	};
+	const CxxNode*		m_a;
+	const CxxNode*		m_b;
+};
+
+struct CxxNameState
+{
+	uint8_t	m_cv;
+	uint8_t	m_ref;
+	bool	m_ctorDtorConversion;
+	bool	m_endsWithTemplateArgs;
+};
+
+struct CxxScope
+{
+	const CxxNode*	m_args;		// template argument list
+	const CxxScope*	m_next;		// enclosing scope
+};
+
+struct CxxSavedScope
+{
+	const CxxNode*	m_param;
+	const CxxScope*	m_scope;
+};
+
+struct CxxBuiltin
+{
+	char		m_code;
+	const char*	m_name;
+	uint8_t		m_literal;
+};
+
+static const CxxBuiltin s_builtins[] =
+{
+	{ 'v', "void",					CXX_LIT_DEFAULT },
+	{ 'w', "wchar_t",				CXX_LIT_DEFAULT },
+	{ 'b', "bool",					CXX_LIT_BOOL },
+	{ 'c', "char",					CXX_LIT_DEFAULT },
+	{ 'a', "signed char",			CXX_LIT_DEFAULT },
+	{ 'h', "unsigned char",			CXX_LIT_DEFAULT },
+	{ 's', "short",					CXX_LIT_DEFAULT },
+	{ 't', "unsigned short",		CXX_LIT_DEFAULT },
+	{ 'i', "int",					CXX_LIT_INT },
+	{ 'j', "unsigned int",			CXX_LIT_UNSIGNED },
+	{ 'l', "long",					CXX_LIT_LONG },
+	{ 'm', "unsigned long",			CXX_LIT_UNSIGNED_LONG },
+	{ 'x', "long long",				CXX_LIT_LONG_LONG },
+	{ 'y', "unsigned long long",	CXX_LIT_UNSIGNED_LONG_LONG },
+	{ 'n', "__int128",				CXX_LIT_DEFAULT },
+	{ 'o', "unsigned __int128",		CXX_LIT_DEFAULT },
+	{ 'f', "float",					CXX_LIT_DEFAULT },
+	{ 'd', "double",				CXX_LIT_DEFAULT },
+	{ 'e', "long double",			CXX_LIT_DEFAULT },
+	{ 'g', "__float128",			CXX_LIT_DEFAULT },
+	{ 'z', "...",					CXX_LIT_DEFAULT }
+};
+
+static const CxxBuiltin s_builtinsD[] =
+{
+	{ 'a', "auto",					CXX_LIT_DEFAULT },
+	{ 'c', "decltype(auto)",		CXX_LIT_DEFAULT },
+	{ 'd', "decimal64",				CXX_LIT_DEFAULT },
+	{ 'e', "decimal128",			CXX_LIT_DEFAULT },
+	{ 'f', "decimal32",				CXX_LIT_DEFAULT },
+	{ 'h', "half",					CXX_LIT_DEFAULT },
+	{ 'i', "char32_t",				CXX_LIT_DEFAULT },
+	{ 'n', "decltype(nullptr)",		CXX_LIT_DEFAULT },
+	{ 's', "char16_t",				CXX_LIT_DEFAULT },
+	{ 'u', "char8_t",				CXX_LIT_DEFAULT }
+};
+
+struct CxxOperator
+{
+	char		m_code[3];
+	const char*	m_name;
+	uint8_t		m_arity;
+};
+
+static const CxxOperator s_operators[] =
+{
+	{ "aN", "&=",		2 },
+	{ "aS", "=",		2 },
+	{ "aa", "&&",		2 },
+	{ "ad", "&",		1 },
+	{ "an", "&",		2 },
+	{ "aw", "co_await",	1 },
+	{ "cl", "()",		2 },
+	{ "cm", ",",		2 },
+	{ "co", "~",		1 },
+	{ "dV", "/=",		2 },
+	{ "da", " delete[]",1 },
+	{ "de", "*",		1 },
+	{ "dl", " delete",	1 },
+	{ "ds", ".*",		2 },
+	{ "dt", ".",		2 },
+	{ "dv", "/",		2 },
+	{ "eO", "^=",		2 },
+	{ "eo", "^",		2 },
+	{ "eq", "==",		2 },
+	{ "ge", ">=",		2 },
+	{ "gt", ">",		2 },
+	{ "ix", "[]",		2 },
+	{ "lS", "<<=",		2 },
+	{ "le", "<=",		2 },
+	{ "ls", "<<",		2 },
+	{ "lt", "<",		2 },
+	{ "mI", "-=",		2 },
+	{ "mL", "*=",		2 },
+	{ "mi", "-",		2 },
+	{ "ml", "*",		2 },
+	{ "mm", "--",		1 },
+	{ "na", " new[]",	3 },
+	{ "ne", "!=",		2 },
+	{ "ng", "-",		1 },
+	{ "nt", "!",		1 },
+	{ "nw", " new",		3 },
+	{ "oR", "|=",		2 },
+	{ "oo", "||",		2 },
+	{ "or", "|",		2 },
+	{ "pL", "+=",		2 },
+	{ "pl", "+",		2 },
+	{ "pm", "->*",		2 },
+	{ "pp", "++",		1 },
+	{ "ps", "+",		1 },
+	{ "pt", "->",		2 },
+	{ "qu", "?",		3 },
+	{ "rM", "%=",		2 },
+	{ "rS", ">>=",		2 },
+	{ "rm", "%",		2 },
+	{ "rs", ">>",		2 },
+	{ "ss", "<=>",		2 },
+	{ "st", "sizeof ",	1 },
+	{ "sz", "sizeof ",	1 }
+};
+
+static inline bool isDigit(char _c)	{ return (_c >= '0') && (_c <= '9'); }
+static inline bool isLower(char _c)	{ return (_c >= 'a') && (_c <= 'z'); }
+static inline bool isUpper(char _c)	{ return (_c >= 'A') && (_c <= 'Z'); }
+
+static inline uint32_t cxxStrLen(const char* _str)
+{
+	uint32_t len = 0;
+	while (_str[len]) ++len;
+	return len;
+}
+
+class CxxDemangler
+{
+	public:
+		enum
+		{
+			MAX_NODES		= 2048,
+			MAX_REFS		= 2048,
+			MAX_STACK		= 512,
+			MAX_SUBS		= 256,
+			MAX_SCOPES		= 128,
+			MAX_SAVED		= 32,
+			MAX_DEPTH		= 192
+		};
+
+	private:
+		const char*		m_pos;
+		const char*		m_end;
+		uint32_t		m_depth;
+
+		CxxNode			m_nodes[MAX_NODES];
+		uint32_t		m_numNodes;
+		const CxxNode*	m_refs[MAX_REFS];
+		uint32_t		m_numRefs;
+		const CxxNode*	m_stack[MAX_STACK];
+		uint32_t		m_numStack;
+		const CxxNode*	m_subs[MAX_SUBS];
+		uint32_t		m_numSubs;
+
+		char*			m_out;
+		uint32_t		m_outSize;
+		uint32_t		m_outPos;
+		char			m_lastChar;		// last character written, not restored when output is rolled back (same as c++filt)
+		const CxxNode*	m_packNode;
+		uint32_t		m_packIndex;
+		const CxxScope*	m_scope;			// template arguments that template parameters refer to
+		const CxxNode*	m_currentTemplate;	// innermost template being printed, for conversion operators
+		uint32_t		m_lambdaArg;		// printing generic lambda parameters
+		bool			m_error;
+		CxxScope		m_scopes[MAX_SCOPES];
+		uint32_t		m_numScopes;
+		CxxSavedScope	m_saved[MAX_SAVED];
+		uint32_t		m_numSaved;
+
+	public:
+		CxxDemangler(const char* _mangled)
+			: m_pos(_mangled)
+			, m_end(_mangled + cxxStrLen(_mangled))
+			, m_depth(0)
+			, m_numNodes(0)
+			, m_numRefs(0)
+			, m_numStack(0)
+			, m_numSubs(0)
+			, m_out(0)
+			, m_outSize(0)
+			, m_outPos(0)
+			, m_lastChar('\0')
+			, m_packNode(0)
+			, m_packIndex(0)
+			, m_scope(0)
+			, m_currentTemplate(0)
+			, m_lambdaArg(0)
+			, m_error(false)
+			, m_numScopes(0)
+			, m_numSaved(0)
+		{}
+
+		const CxxNode*	parse();
+		bool			print(const CxxNode* _node, char* _buffer, uint32_t _bufferSize);
+
+	private:
+		// parsing
+		inline char peek(uint32_t _offset = 0) const { return (m_pos + _offset < m_end) ? m_pos[_offset] : '\0'; }
+		inline bool atEnd() const { return m_pos >= m_end; }
+
+		inline bool consume(char _c)
+		{
+			if (peek() != _c)
+				return false;
+			++m_pos;
+			return true;
+		}
+
+		inline bool consume(char _c1, char _c2)
+		{
+			if ((peek() != _c1) || (peek(1) != _c2))
+				return false;
+			m_pos += 2;
+			return true;
+		}
+
+		CxxNode*		makeNode(uint8_t _kind);
+		const CxxNode*	makeName(const char* _str, uint32_t _len, uint8_t _literal = CXX_LIT_DEFAULT);
+		const CxxNode*	makeName(const char* _str) { return makeName(_str, cxxStrLen(_str)); }
+		const CxxNode*	make(uint8_t _kind, const CxxNode* _a, const CxxNode* _b = 0);
+		const CxxNode*	makeStr(uint8_t _kind, const char* _str, const CxxNode* _a);
+		const CxxNode*	makeNumber(uint8_t _kind, uint32_t _number, const char* _str = "");
+
+		bool			push(const CxxNode* _node);
+		const CxxNode*	popList(uint32_t _begin, uint8_t _kind = CXX_LIST);
+		bool			addSubstitution(const CxxNode* _node);
+
+		bool			parseNumber(uint64_t& _value);
+		bool			parseNumber(uint32_t& _value);
+		bool			parseSeqId(uint32_t& _value);
+		bool			parseDiscriminator();
+		bool			parseCallOffset();
+		uint8_t			parseCVQualifiers();
+
+		const CxxNode*	parseEncoding();
+		const CxxNode*	parseSpecialName();
+		const CxxNode*	parseName(CxxNameState* _state);
+		const CxxNode*	parseUnscopedName(CxxNameState* _state, bool& _isSubstitution);
+		const CxxNode*	parseUnqualifiedName(CxxNameState* _state);
+		const CxxNode*	parseNestedName(CxxNameState* _state);
+		const CxxNode*	parseLocalName(CxxNameState* _state);
+		const CxxNode*	parseSourceName();
+		const CxxNode*	parseOperatorName(CxxNameState* _state);
+		const CxxNode*	parseCtorDtorName(const CxxNode* _soFar, CxxNameState* _state);
+		const CxxNode*	parseAbiTags(const CxxNode* _node);
+		const CxxNode*	parseSubstitution();
+		const CxxNode*	parseTemplateParam();
+		const CxxNode*	parseTemplateArgs();
+		const CxxNode*	parseTemplateArg();
+		const CxxNode*	parseType();
+		const CxxNode*	parseFunctionType();
+		const CxxNode*	parseArrayType();
+		const CxxNode*	parseDecltype();
+		const CxxNode*	parseExprPrimary();
+		const CxxNode*	parseExpr();
+		const CxxNode*	parseUnresolvedName();
+		const CxxNode*	parseSimpleId();
+		const CxxNode*	parseClone(const CxxNode* _encoding);
+
+		// printing
+		void			write(const char* _str, uint32_t _len);
+		void			write(const char* _str) { write(_str, cxxStrLen(_str)); }
+		void			writeNumber(uint64_t _number);
+		bool			full() const { return m_outPos + 1 >= m_outSize; }
+
+		const CxxNode*			lookupParam(const CxxNode* _param, const CxxScope*& _scope) const;
+		static const CxxNode*	templateArgs(const CxxNode* _encoding);
+		const CxxNode*			resolveType(const CxxNode* _node, const CxxScope*& _scope) const;
+		const CxxScope*			savedScope(const CxxNode* _param);
+		const CxxNode*			collapseReference(const CxxNode* _node, uint8_t& _ref, const CxxScope*& _scope);
+		bool					isArrayOrFunction(const CxxNode* _node) const;
+		bool					hasRHS(const CxxNode* _node) const;
+		static const CxxNode*	baseName(const CxxNode* _node);
+		const CxxNode*			findPack(const CxxNode* _node, uint32_t _depth) const;
+
+		void			printNode(const CxxNode* _node);
+		void			printLeft(const CxxNode* _node);
+		void			printRight(const CxxNode* _node);
+		void			printList(const CxxNode* _list);
+		void			printQualifiers(uint8_t _cv, uint8_t _ref);
+		void			printSubExpr(const CxxNode* _node);
+		void			printLiteral(const CxxNode* _node);
+		void			printPackExpansion(const CxxNode* _node);
+		void			printParam(const CxxNode* _node, bool _left);
+		void			printFunction(const CxxNode* _encoding, bool _returnType);
+};
+
+CxxNode* CxxDemangler::makeNode(uint8_t _kind)
+{
+	if (m_numNodes == MAX_NODES)
+		return 0;
+
+	CxxNode* node = &m_nodes[m_numNodes++];
+	node->m_kind	= _kind;
+	node->m_cv		= 0;
+	node->m_ref		= 0;
+	node->m_flag	= 0;
+	node->m_len		= 0;
+	node->m_index	= 0;
+	node->m_str		= "";
+	node->m_a		= 0;
+	node->m_b		= 0;
+	return node;
+}
+
+const CxxNode* CxxDemangler::makeName(const char* _str, uint32_t _len, uint8_t _literal)
+{
+	CxxNode* node = makeNode(CXX_NAME);
+	if (node)
+	{
+		node->m_str		= _str;
+		node->m_len		= _len;
+		node->m_flag	= _literal;
+	}
+	return node;
+}
+
+const CxxNode* CxxDemangler::make(uint8_t _kind, const CxxNode* _a, const CxxNode* _b)
+{
+	CxxNode* node = makeNode(_kind);
+	if (node)
+	{
+		node->m_a = _a;
+		node->m_b = _b;
+	}
+	return node;
+}
+
+const CxxNode* CxxDemangler::makeStr(uint8_t _kind, const char* _str, const CxxNode* _a)
+{
+	CxxNode* node = makeNode(_kind);
+	if (node)
+	{
+		node->m_str	= _str;
+		node->m_len	= cxxStrLen(_str);
+		node->m_a	= _a;
+	}
+	return node;
+}
+
+const CxxNode* CxxDemangler::makeNumber(uint8_t _kind, uint32_t _number, const char* _str)
+{
+	CxxNode* node = makeNode(_kind);
+	if (node)
+	{
+		node->m_str	= _str;
+		node->m_len	= _number;
+	}
+	return node;
+}
+
+bool CxxDemangler::push(const CxxNode* _node)
+{
+	if (!_node || (m_numStack == MAX_STACK))
+		return false;
+	m_stack[m_numStack++] = _node;
+	return true;
+}
+
+const CxxNode* CxxDemangler::popList(uint32_t _begin, uint8_t _kind)
+{
+	uint32_t count = m_numStack - _begin;
+	if (m_numRefs + count > MAX_REFS)
+		return 0;
+
+	CxxNode* node = makeNode(_kind);
+	if (!node)
+		return 0;
+
+	node->m_index	= m_numRefs;
+	node->m_len		= count;
+	for (uint32_t i=0; i<count; ++i)
+		m_refs[m_numRefs++] = m_stack[_begin + i];
+
+	m_numStack = _begin;
+	return node;
+}
+
+bool CxxDemangler::addSubstitution(const CxxNode* _node)
+{
+	if (!_node || (m_numSubs == MAX_SUBS))
+		return false;
+	m_subs[m_numSubs++] = _node;
+	return true;
+}
+
+bool CxxDemangler::parseNumber(uint64_t& _value)
+{
+	if (!isDigit(peek()))
+		return false;
+
+	_value = 0;
+	while (isDigit(peek()))
+	{
+		if (_value > (~0ull / 10))
+			return false;
+		_value = _value * 10 + (uint64_t)(*m_pos++ - '0');
+	}
+	return true;
+}
+
+bool CxxDemangler::parseNumber(uint32_t& _value)
+{
+	uint64_t value;
+	if (!parseNumber(value) || (value > 0xffffffffull))
+		return false;
+	_value = (uint32_t)value;
+	return true;
+}
+
+bool CxxDemangler::parseSeqId(uint32_t& _value)
+{
+	_value = 0;
+	while (isDigit(peek()) || isUpper(peek()))
+	{
+		char c = *m_pos++;
+		_value = _value * 36 + (uint32_t)(isDigit(c) ? c - '0' : c - 'A' + 10);
+		if (_value > 0xffffff)
+			return false;
+	}
+	return true;
+}
+
+bool CxxDemangler::parseDiscriminator()
+{
+	// _ <digit> or __ <number> _, lone underscore belongs to the enclosing production
+	if ((peek() == '_') && isDigit(peek(1)))
+	{
+		m_pos += 2;
+		return true;
+	}
+
+	if ((peek() == '_') && (peek(1) == '_') && isDigit(peek(2)))
+	{
+		m_pos += 2;
+		uint64_t number;
+		return parseNumber(number) && consume('_');
+	}
+	return true;
+}
+
+bool CxxDemangler::parseCallOffset()
+{
+	uint64_t offset;
+	if (consume('h'))
+	{
+		consume('n');
+		return parseNumber(offset) && consume('_');
+	}
+
+	if (consume('v'))
+	{
+		consume('n');
+		if (!parseNumber(offset) || !consume('_'))
+			return false;
+		consume('n');
+		return parseNumber(offset) && consume('_');
+	}
+	return false;
+}
+
+uint8_t CxxDemangler::parseCVQualifiers()
+{
+	uint8_t cv = 0;
+	if (consume('r')) cv |= CXX_RESTRICT;
+	if (consume('V')) cv |= CXX_VOLATILE;
+	if (consume('K')) cv |= CXX_CONST;
+	return cv;
+}
+
+const CxxNode* CxxDemangler::parse()
+{
+	if (!consume('_', 'Z'))
+		return 0;
+
+	const CxxNode* encoding = parseEncoding();
+	if (!encoding)
+		return 0;
+
+	encoding = parseClone(encoding);
+	if (!encoding || !atEnd())
+		return 0;
+
+	return encoding;
+}
+
+const CxxNode* CxxDemangler::parseClone(const CxxNode* _encoding)
+{
+	// GCC clone suffixes, e.g. .cold, .constprop.0, .isra.0
+	while (_encoding && (peek() == '.') && (isLower(peek(1)) || (peek(1) == '_') || isDigit(peek(1))))
+	{
+		const char* start = m_pos;
+		++m_pos;
+		while (isLower(peek()) || (peek() == '_'))
+			++m_pos;
+		while ((peek() == '.') && isDigit(peek(1)))
+		{
+			++m_pos;
+			while (isDigit(peek()))
+				++m_pos;
+		}
+
+		CxxNode* clone = makeNode(CXX_CLONE);
+		if (!clone)
+			return 0;
+		clone->m_a		= _encoding;
+		clone->m_str	= start;
+		clone->m_len	= (uint32_t)(m_pos - start);
+		_encoding = clone;
+	}
+	return _encoding;
+}
+
+const CxxNode* CxxDemangler::parseEncoding()
+{
+	if ((peek() == 'G') || (peek() == 'T'))
+		return parseSpecialName();
+
+	if (++m_depth > MAX_DEPTH)
+		return 0;
+
+	CxxNameState state;
+	state.m_cv						= 0;
+	state.m_ref						= 0;
+	state.m_ctorDtorConversion		= false;
+	state.m_endsWithTemplateArgs	= false;
+
+	const CxxNode* name = parseName(&state);
+	if (!name)
+		return 0;
+
+	if (atEnd() || (peek() == 'E') || (peek() == '.'))
+	{
+		--m_depth;
+		return name;
+	}
+
+	const CxxNode* ret = 0;
+	if (state.m_endsWithTemplateArgs && !state.m_ctorDtorConversion)
+	{
+		ret = parseType();
+		if (!ret)
+			return 0;
+	}
+
+	uint32_t begin = m_numStack;
+	if (!consume('v'))
+	{
+		do
+		{
+			if (!push(parseType()))
+				return 0;
+		} while (!atEnd() && (peek() != 'E') && (peek() != '.'));
+	}
+
+	const CxxNode* params = popList(begin);
+	if (!params)
+		return 0;
+
+	CxxNode* encoding = makeNode(CXX_ENCODING);
+	if (!encoding)
+		return 0;
+	encoding->m_a	= ret;
+	encoding->m_b	= params;
+	encoding->m_c	= name;
+	encoding->m_cv	= state.m_cv;
+	encoding->m_ref	= state.m_ref;
+
+	--m_depth;
+	return encoding;
+}
+
+const CxxNode* CxxDemangler::parseSpecialName()
+{
+	if (consume('T'))
+	{
+		char c = *m_pos++;
+		switch (c)
+		{
+		case 'V':	return makeStr(CXX_SPECIAL, "vtable for ", parseType());
+		case 'T':	return makeStr(CXX_SPECIAL, "VTT for ", parseType());
+		case 'I':	return makeStr(CXX_SPECIAL, "typeinfo for ", parseType());
+		case 'S':	return makeStr(CXX_SPECIAL, "typeinfo name for ", parseType());
+		case 'H':	return makeStr(CXX_SPECIAL, "TLS init function for ", parseName(0));
+		case 'W':	return makeStr(CXX_SPECIAL, "TLS wrapper function for ", parseName(0));
+		case 'A':	return makeStr(CXX_SPECIAL, "template parameter object for ", parseTemplateArg());
+
+		case 'h':
+			--m_pos;
+			if (!parseCallOffset())
+				return 0;
+			return makeStr(CXX_SPECIAL, "non-virtual thunk to ", parseEncoding());
+
+		case 'v':
+			--m_pos;
+			if (!parseCallOffset())
+				return 0;
+			return makeStr(CXX_SPECIAL, "virtual thunk to ", parseEncoding());
+
+		case 'c':
+			if (!parseCallOffset() || !parseCallOffset())
+				return 0;
+			return makeStr(CXX_SPECIAL, "covariant return thunk to ", parseEncoding());
+
+		case 'C':
+			{
+				const CxxNode* derived = parseType();
+				uint64_t offset;
+				if (!derived || !parseNumber(offset) || !consume('_'))
+					return 0;
+				const CxxNode* base = parseType();
+				if (!base)
+					return 0;
+				return make(CXX_CTOR_VTABLE, base, derived);
+			}
+		};
+		return 0;
+	}
+
+	if (consume('G'))
+	{
+		char c = *m_pos++;
+		switch (c)
+		{
+		case 'V':	return makeStr(CXX_SPECIAL, "guard variable for ", parseName(0));
+		case 'A':	return makeStr(CXX_SPECIAL, "hidden alias for ", parseEncoding());
+
+		case 'R':
+			{
+				const CxxNode* name = parseName(0);
+				if (!name)
+					return 0;
+				uint32_t seqId = 0;
+				if (!consume('_'))
+				{
+					if (!parseSeqId(seqId) || !consume('_'))
+						return 0;
+					++seqId;
+				}
+				const CxxNode* number = makeNumber(CXX_NAME_NUMBER, seqId, "reference temporary #");
+				return make(CXX_SPECIAL, number, name);
+			}
+
+		case 'T':
+			if (consume('t'))
+				return makeStr(CXX_SPECIAL, "transaction clone for ", parseEncoding());
+			if (consume('n'))
+				return makeStr(CXX_SPECIAL, "non-transaction clone for ", parseEncoding());
+			return 0;
+		};
+	}
+	return 0;
+}
+
+const CxxNode* CxxDemangler::parseName(CxxNameState* _state)
+{
+	if (peek() == 'N')
+		return parseNestedName(_state);
+
+	if (peek() == 'Z')
+		return parseLocalName(_state);
+
+	bool isSubstitution = false;
+	const CxxNode* name = parseUnscopedName(_state, isSubstitution);
+	if (!name)
+		return 0;
+
+	if (peek() == 'I')
+	{
+		if (!isSubstitution && !addSubstitution(name))
+			return 0;
+
+		const CxxNode* args = parseTemplateArgs();
+		if (!args)
+			return 0;
+
+		if (_state)
+			_state->m_endsWithTemplateArgs = true;
+		return make(CXX_TEMPLATE, name, args);
+	}
+
+	// substitution must be followed by template arguments
+	return isSubstitution ? 0 : name;
+}
+
+const CxxNode* CxxDemangler::parseUnscopedName(CxxNameState* _state, bool& _isSubstitution)
+{
+	if ((peek() == 'S') && (peek(1) != 't'))
+	{
+		_isSubstitution = true;
+		return parseSubstitution();
+	}
+
+	if (consume('S', 't'))
+	{
+		consume('L');
+		const CxxNode* name = parseUnqualifiedName(_state);
+		return name ? make(CXX_NESTED, makeName("std", 3), name) : 0;
+	}
+
+	consume('L');	// internal linkage
+	return parseUnqualifiedName(_state);
+}
+
+const CxxNode* CxxDemangler::parseSourceName()
+{
+	uint32_t len;
+	if (!parseNumber(len) || (len == 0) || (len > (uint32_t)(m_end - m_pos)))
+		return 0;
+
+	const char* name = m_pos;
+	m_pos += len;
+
+	// GCC anonymous namespace, _GLOBAL_ followed by one of [._$] and N
+	if ((len >= 10) && (name[0] == '_') && (name[1] == 'G') && (name[2] == 'L') && (name[3] == 'O') &&
+		(name[4] == 'B') && (name[5] == 'A') && (name[6] == 'L') && (name[7] == '_') &&
+		((name[8] == '.') || (name[8] == '_') || (name[8] == '$')) && (name[9] == 'N'))
+		return makeName("(anonymous namespace)");
+
+	return makeName(name, len);
+}
+
+const CxxNode* CxxDemangler::parseUnqualifiedName(CxxNameState* _state)
+{
+	const CxxNode* name = 0;
+
+	if (isDigit(peek()))
+		name = parseSourceName();
+	else
+	if (consume('U', 'l'))
+	{
+		// closure type, {lambda(parameters)#number}
+		uint32_t begin = m_numStack;
+		if (!consume('v'))
+		{
+			while (peek() != 'E')
+			{
+				if (atEnd() || !push(parseType()))
+					return 0;
+			}
+		}
+
+		const CxxNode* params = popList(begin);
+		if (!params || !consume('E'))
+			return 0;
+
+		uint32_t number = 0;
+		if (!consume('_'))
+		{
+			if (!parseNumber(number) || !consume('_'))
+				return 0;
+			++number;
+		}
+
+		CxxNode* lambda = makeNode(CXX_LAMBDA);
+		if (!lambda)
+			return 0;
+		lambda->m_b		= params;
+		lambda->m_len	= number + 1;
+		name = lambda;
+	}
+	else
+	if (consume('U', 't'))
+	{
+		uint32_t number = 0;
+		if (!consume('_'))
+		{
+			if (!parseNumber(number) || !consume('_'))
+				return 0;
+			++number;
+		}
+		name = makeNumber(CXX_UNNAMED_TYPE, number + 1);
+	}
+	else
+	if (consume('D', 'C'))
+	{
+		uint32_t begin = m_numStack;
+		while (!consume('E'))
+		{
+			if (atEnd() || !push(parseSourceName()))
+				return 0;
+		}
+		name = make(CXX_STRUCT_BINDING, 0, popList(begin));
+	}
+	else
+	if (isLower(peek()))
+		name = parseOperatorName(_state);
+
+	return name ? parseAbiTags(name) : 0;
+}
+
+const CxxNode* CxxDemangler::parseAbiTags(const CxxNode* _node)
+{
+	while (_node && consume('B'))
+	{
+		const CxxNode* tag = parseSourceName();
+		if (!tag)
+			return 0;
+
+		CxxNode* node = makeNode(CXX_ABI_TAG);
+		if (!node)
+			return 0;
+		node->m_a	= _node;
+		node->m_str	= tag->m_str;
+		node->m_len	= tag->m_len;
+		_node = node;
+	}
+	return _node;
+}
+
+const CxxNode* CxxDemangler::parseOperatorName(CxxNameState* _state)
+{
+	if (consume('c', 'v'))
+	{
+		const CxxNode* type = parseType();
+
+		if (_state)
+			_state->m_ctorDtorConversion = true;
+		return type ? make(CXX_CONVERSION, type) : 0;
+	}
+
+	if (consume('l', 'i'))
+	{
+		const CxxNode* name = parseSourceName();
+		if (!name)
+			return 0;
+		CxxNode* node = makeNode(CXX_OPERATOR);
+		if (!node)
+			return 0;
+		node->m_str	= "\"\" ";
+		node->m_len	= 3;
+		node->m_a	= name;
+		return node;
+	}
+
+	if (consume('v') && isDigit(peek()))
+	{
+		++m_pos;
+		const CxxNode* name = parseSourceName();
+		return name ? makeStr(CXX_OPERATOR, " ", name) : 0;
+	}
+
+	for (uint32_t i=0; i<RTM_NUM_ELEMENTS(s_operators); ++i)
+	{
+		const CxxOperator& op = s_operators[i];
+		if ((op.m_code[0] == peek()) && (op.m_code[1] == peek(1)))
+		{
+			m_pos += 2;
+			return makeStr(CXX_OPERATOR, op.m_name, 0);
+		}
+	}
+	return 0;
+}
+
+const CxxNode* CxxDemangler::parseCtorDtorName(const CxxNode* _soFar, CxxNameState* _state)
+{
+	if (_state)
+		_state->m_ctorDtorConversion = true;
+
+	CxxNode* node = makeNode(CXX_CTOR_DTOR);
+	if (!node)
+		return 0;
+	node->m_a = _soFar;
+
+	if (consume('C'))
+	{
+		bool inheriting = consume('I');
+		if ((peek() < '1') || (peek() > '5'))
+			return 0;
+		++m_pos;
+		if (inheriting && !parseName(0))
+			return 0;
+	}
+	else
+	if (consume('D'))
+	{
+		if ((peek() != '0') && (peek() != '1') && (peek() != '2') && (peek() != '4') && (peek() != '5'))
+			return 0;
+		++m_pos;
+		node->m_flag = 1;
+	}
+	else
+		return 0;
+
+	return parseAbiTags(node);
+}
+
+const CxxNode* CxxDemangler::parseNestedName(CxxNameState* _state)
+{
+	if (!consume('N'))
+		return 0;
+
+	uint8_t cv = parseCVQualifiers();
+	uint8_t ref = 0;
+	if (consume('O'))
+		ref = 2;
+	else
+	if (consume('R'))
+		ref = 1;
+
+	if (_state)
+	{
+		_state->m_cv	= cv;
+		_state->m_ref	= ref;
+	}
+
+	const CxxNode* soFar = 0;
+	while (!consume('E'))
+	{
+		if (atEnd())
+			return 0;
+
+		consume('L');	// internal linkage
+
+		if (consume('M'))
+		{
+			// closure in a data member initializer
+			if (!soFar)
+				return 0;
+			continue;
+		}
+
+		if (peek() == 'S')
+		{
+			if (soFar)
+				return 0;
+
+			if (consume('S', 't'))
+				soFar = makeName("std", 3);
+			else
+			{
+				soFar = parseSubstitution();
+				if (!soFar)
+					return 0;
+				continue;	// already a substitution candidate
+			}
+			if (!soFar)
+				return 0;
+			continue;		// std:: alone is not a substitution candidate
+		}
+
+		if (peek() == 'I')
+		{
+			if (!soFar)
+				return 0;
+
+			const CxxNode* args = parseTemplateArgs();
+			if (!args)
+				return 0;
+
+			soFar = make(CXX_TEMPLATE, soFar, args);
+			if (_state)
+				_state->m_endsWithTemplateArgs = true;
+
+			if (!addSubstitution(soFar))
+				return 0;
+			continue;
+		}
+
+		const CxxNode* component;
+		if (peek() == 'T')
+			component = parseTemplateParam();
+		else
+		if ((peek() == 'D') && ((peek(1) == 't') || (peek(1) == 'T')))
+			component = parseDecltype();
+		else
+		if ((peek() == 'C') || ((peek() == 'D') && (peek(1) != 'C')))
+		{
+			if (!soFar)
+				return 0;
+			component = parseCtorDtorName(soFar, _state);
+		}
+		else
+			component = parseUnqualifiedName(_state);
+
+		if (!component)
+			return 0;
+
+		soFar = soFar ? make(CXX_NESTED, soFar, component) : component;
+		if (_state)
+			_state->m_endsWithTemplateArgs = false;
+
+		if (!addSubstitution(soFar))
+			return 0;
+	}
+
+	// complete name is not a substitution candidate
+	if (!soFar || (m_numSubs == 0))
+		return 0;
+
+	if (m_subs[m_numSubs - 1] == soFar)
+		--m_numSubs;
+	return soFar;
+}
+
+const CxxNode* CxxDemangler::parseLocalName(CxxNameState* _state)
+{
+	if (!consume('Z'))
+		return 0;
+
+	const CxxNode* encoding = parseEncoding();
+	if (!encoding || !consume('E'))
+		return 0;
+
+	if (consume('s'))
+	{
+		if (!parseDiscriminator())
+			return 0;
+		return make(CXX_LOCAL, encoding, makeName("string literal"));
+	}
+
+	if (consume('d'))
+	{
+		uint32_t number = 0;
+		if (!consume('_'))
+		{
+			if (!parseNumber(number) || !consume('_'))
+				return 0;
+			++number;
+		}
+		const CxxNode* entity = parseName(_state);
+		if (!entity)
+			return 0;
+		return make(CXX_LOCAL, encoding, make(CXX_NESTED, makeNumber(CXX_NAME_NUMBER, number + 1, "{default arg#"), entity));
+	}
+
+	const CxxNode* entity = parseName(_state);
+	if (!entity || !parseDiscriminator())
+		return 0;
+
+	return make(CXX_LOCAL, encoding, entity);
+}
+
+const CxxNode* CxxDemangler::parseSubstitution()
+{
+	if (!consume('S'))
+		return 0;
+
+	if (isLower(peek()))
+	{
+		const char* name;
+		const char* full	= 0;
+		const char* base;
+		switch (*m_pos++)
+		{
+		case 'a':	name = "std::allocator";	base = "allocator";		break;
+		case 'b':	name = "std::basic_string";	base = "basic_string";	break;
+		case 's':	name = "std::string";		base = "basic_string";
+					full = "std::basic_string<char, std::char_traits<char>, std::allocator<char> >";	break;
+		case 'i':	name = "std::istream";		base = "basic_istream";
+					full = "std::basic_istream<char, std::char_traits<char> >";		break;
+		case 'o':	name = "std::ostream";		base = "basic_ostream";
+					full = "std::basic_ostream<char, std::char_traits<char> >";		break;
+		case 'd':	name = "std::iostream";		base = "basic_iostream";
+					full = "std::basic_iostream<char, std::char_traits<char> >";	break;
+		default:
+			return 0;
+		};
+
+		// c++filt prints full names of std::basic_string and stream typedefs
+		if (full)
+			name = full;
+
+		CxxNode* node = makeNode(CXX_STD_ABBREVIATION);
+		if (!node)
+			return 0;
+		node->m_str	= name;
+		node->m_len	= cxxStrLen(name);
+		node->m_a	= makeName(base);
+		return parseAbiTags(node);
+	}
+
+	uint32_t index = 0;
+	if (!consume('_'))
+	{
+		if (!parseSeqId(index) || !consume('_'))
+			return 0;
+		++index;
+	}
+
+	return index < m_numSubs ? m_subs[index] : 0;
+}
+
+const CxxNode* CxxDemangler::parseTemplateParam()
+{
+	if (!consume('T'))
+		return 0;
+
+	uint32_t index = 0;
+	if (!consume('_'))
+	{
+		if (!parseNumber(index) || !consume('_'))
+			return 0;
+		++index;
+	}
+
+	// arguments are known only when printing, a parameter of a local name or of a
+	// lambda inside template arguments can refer to a different template
+	return makeNumber(CXX_TEMPLATE_PARAM, index);
+}
+
+const CxxNode* CxxDemangler::parseTemplateArgs()
+{
+	if (!consume('I'))
+		return 0;
+
+	uint32_t begin = m_numStack;
+	while (!consume('E'))
+	{
+		if (atEnd() || !push(parseTemplateArg()))
+			return 0;
+	}
+
+	return popList(begin);
+}
+
+const CxxNode* CxxDemangler::parseTemplateArg()
+{
+	if (consume('X'))
+	{
+		const CxxNode* expr = parseExpr();
+		return (expr && consume('E')) ? expr : 0;
+	}
+
+	if (consume('J'))
+	{
+		uint32_t begin = m_numStack;
+		while (!consume('E'))
+		{
+			if (atEnd() || !push(parseTemplateArg()))
+				return 0;
+		}
+		return popList(begin, CXX_PACK);
+	}
+
+	if (peek() == 'L')
+		return parseExprPrimary();
+
+	return parseType();
+}
+
+const CxxNode* CxxDemangler::parseType()
+{
+	if (++m_depth > MAX_DEPTH)
+		return 0;
+
+	const CxxNode* result = 0;
+	char c = peek();
+
+	switch (c)
+	{
+	case 'r':
+	case 'V':
+	case 'K':
+		{
+			uint8_t cv = parseCVQualifiers();
+			if (peek() == 'F')
+			{
+				// cv qualified function type, qualifiers belong to the (member) function
+				const CxxNode* function = parseFunctionType();
+				if (!function)
+					return 0;
+				((CxxNode*)function)->m_cv = cv;
+				result = function;
+				break;
+			}
+
+			const CxxNode* type = parseType();
+			if (!type)
+				return 0;
+
+			CxxNode* node = makeNode(CXX_QUALIFIED);
+			if (!node)
+				return 0;
+			node->m_a	= type;
+			node->m_cv	= cv;
+			result = node;
+		}
+		break;
+
+	case 'U':
+		{
+			// vendor qualifier, printed after the type
+			++m_pos;
+			const CxxNode* qualifier = parseSourceName();
+			if (!qualifier)
+				return 0;
+			if (peek() == 'I')
+			{
+				if (!parseTemplateArgs())
+					return 0;
+			}
+			const CxxNode* type = parseType();
+			if (!type)
+				return 0;
+			result = make(CXX_NESTED, type, qualifier);
+		}
+		break;
+
+	case 'F':
+		result = parseFunctionType();
+		break;
+
+	case 'A':
+		result = parseArrayType();
+		break;
+
+	case 'M':
+		{
+			++m_pos;
+			const CxxNode* classType = parseType();
+			if (!classType)
+				return 0;
+			const CxxNode* memberType = parseType();
+			if (!memberType)
+				return 0;
+			result = make(CXX_POINTER_TO_MEMBER, classType, memberType);
+		}
+		break;
+
+	case 'T':
+		{
+			// elaborated type specifiers
+			if ((peek(1) == 's') || (peek(1) == 'u') || (peek(1) == 'e'))
+			{
+				m_pos += 2;
+				result = parseName(0);
+				break;
+			}
+
+			result = parseTemplateParam();
+			if (!result)
+				return 0;
+
+			// template template parameter with arguments
+			if (peek() == 'I')
+			{
+				if (!addSubstitution(result))
+					return 0;
+				const CxxNode* args = parseTemplateArgs();
+				if (!args)
+					return 0;
+				result = make(CXX_TEMPLATE, result, args);
+			}
+		}
+		break;
+
+	case 'P':
+		++m_pos;
+		result = make(CXX_POINTER, parseType());
+		if (!result || !result->m_a)
+			return 0;
+		break;
+
+	case 'R':
+	case 'O':
+		{
+			++m_pos;
+			const CxxNode* type = parseType();
+			if (!type)
+				return 0;
+
+			CxxNode* node = makeNode(CXX_REFERENCE);
+			if (!node)
+				return 0;
+			node->m_a	= type;
+			node->m_ref	= (c == 'R') ? 1 : 2;
+			result = node;
+		}
+		break;
+
+	case 'C':
+	case 'G':
+		{
+			// complex and imaginary
+			++m_pos;
+			const CxxNode* type = parseType();
+			if (!type)
+				return 0;
+
+			CxxNode* node = makeNode(CXX_NESTED);
+			if (!node)
+				return 0;
+			node->m_a		= type;
+			node->m_b		= makeName(c == 'C' ? "_Complex" : "_Imaginary");
+			node->m_flag	= 1;
+			result = node;
+		}
+		break;
+
+	case 'S':
+		{
+			if (peek(1) == 't')
+			{
+				result = parseName(0);
+				break;
+			}
+
+			result = parseSubstitution();
+			if (!result)
+				return 0;
+
+			if (peek() != 'I')
+			{
+				// plain substitution is not added again
+				--m_depth;
+				return result;
+			}
+
+			const CxxNode* args = parseTemplateArgs();
+			if (!args)
+				return 0;
+			result = make(CXX_TEMPLATE, result, args);
+		}
+		break;
+
+	case 'u':
+		{
+			++m_pos;
+			result = parseSourceName();
+			if (result && (peek() == 'I'))
+			{
+				const CxxNode* args = parseTemplateArgs();
+				if (!args)
+					return 0;
+				result = make(CXX_TEMPLATE, result, args);
+			}
+		}
+		break;
+
+	case 'D':
+		{
+			char d = peek(1);
+			if ((d == 't') || (d == 'T'))
+			{
+				result = parseDecltype();
+				break;
+			}
+
+			if (d == 'p')
+			{
+				m_pos += 2;
+				const CxxNode* pattern = parseType();
+				if (!pattern)
+					return 0;
+				result = make(CXX_PACK_EXPANSION, pattern);
+				break;
+			}
+
+			if (d == 'v')
+			{
+				m_pos += 2;
+				uint32_t dimension;
+				if (!parseNumber(dimension) || !consume('_'))
+					return 0;
+				const CxxNode* type = parseType();
+				if (!type)
+					return 0;
+				result = make(CXX_VECTOR, type, makeNumber(CXX_NAME_NUMBER, dimension));
+				break;
+			}
+
+			if ((d == 'o') || (d == 'O') || (d == 'w') || (d == 'x'))
+			{
+				// exception specification of a function type
+				m_pos += 2;
+				if (d == 'O')
+				{
+					if (!parseExpr() || !consume('E'))
+						return 0;
+				}
+				if (d == 'w')
+				{
+					while (!consume('E'))
+					{
+						if (atEnd() || !parseType())
+							return 0;
+					}
+				}
+				if (peek() != 'F')
+					return 0;
+
+				const CxxNode* function = parseFunctionType();
+				if (!function)
+					return 0;
+				if ((d == 'o') || (d == 'O'))
+					((CxxNode*)function)->m_flag = 1;
+				result = function;
+				break;
+			}
+
+			if (d == 'F')
+			{
+				// _FloatN
+				m_pos += 2;
+				uint32_t bits;
+				if (!parseNumber(bits))
+					return 0;
+				consume('x');
+				if (!consume('_'))
+					return 0;
+				--m_depth;
+				return makeNumber(CXX_NAME_NUMBER, bits, "_Float");
+			}
+
+			for (uint32_t i=0; i<RTM_NUM_ELEMENTS(s_builtinsD); ++i)
+			{
+				if (s_builtinsD[i].m_code == d)
+				{
+					m_pos += 2;
+					--m_depth;
+					return makeName(s_builtinsD[i].m_name);
+				}
+			}
+			return 0;
+		}
+
+	case 'N':
+	case 'Z':
+	case '0': case '1': case '2': case '3': case '4':
+	case '5': case '6': case '7': case '8': case '9':
+		result = parseName(0);
+		break;
+
+	default:
+		for (uint32_t i=0; i<RTM_NUM_ELEMENTS(s_builtins); ++i)
+		{
+			if (s_builtins[i].m_code == c)
+			{
+				++m_pos;
+				--m_depth;
+				return makeName(s_builtins[i].m_name, cxxStrLen(s_builtins[i].m_name), s_builtins[i].m_literal);
+			}
+		}
+		return 0;
+	};
+
+	if (!result || !addSubstitution(result))
+		return 0;
+
+	--m_depth;
+	return result;
+}
+
+const CxxNode* CxxDemangler::parseFunctionType()
+{
+	if (!consume('F'))
+		return 0;
+
+	consume('Y');	// extern "C"
+
+	const CxxNode* ret = parseType();
+	if (!ret)
+		return 0;
+
+	uint8_t ref = 0;
+	uint32_t begin = m_numStack;
+	for (;;)
+	{
+		if (consume('E'))
+			break;
+		if (consume('v'))
+			continue;
+		if (consume('R', 'E'))
+		{
+			ref = 1;
+			break;
+		}
+		if (consume('O', 'E'))
+		{
+			ref = 2;
+			break;
+		}
+		if (atEnd() || !push(parseType()))
+			return 0;
+	}
+
+	const CxxNode* params = popList(begin);
+	if (!params)
+		return 0;
+
+	CxxNode* node = makeNode(CXX_FUNCTION);
+	if (!node)
+		return 0;
+	node->m_a	= ret;
+	node->m_b	= params;
+	node->m_ref	= ref;
+	return node;
+}
+
+const CxxNode* CxxDemangler::parseArrayType()
+{
+	if (!consume('A'))
+		return 0;
+
+	const CxxNode* dimension = 0;
+	if (isDigit(peek()))
+	{
+		const char* start = m_pos;
+		uint64_t number;
+		parseNumber(number);
+		dimension = makeName(start, (uint32_t)(m_pos - start));
+	}
+	else
+	if (peek() != '_')
+	{
+		dimension = parseExpr();
+		if (!dimension)
+			return 0;
+	}
+
+	if (!consume('_'))
+		return 0;
+
+	const CxxNode* type = parseType();
+	if (!type)
+		return 0;
+
+	return make(CXX_ARRAY, type, dimension);
+}
+
+const CxxNode* CxxDemangler::parseDecltype()
+{
+	if (!consume('D') || (!consume('t') && !consume('T')))
+		return 0;
+
+	const CxxNode* expr = parseExpr();
+	if (!expr || !consume('E'))
+		return 0;
+
+	return makeStr(CXX_ENCLOSED, "decltype (", expr);
+}
+
+const CxxNode* CxxDemangler::parseExprPrimary()
+{
+	if (!consume('L'))
+		return 0;
+
+	// external name
+	if (consume('_', 'Z'))
+	{
+		const CxxNode* encoding = parseEncoding();
+		return (encoding && consume('E')) ? encoding : 0;
+	}
+
+	const CxxNode* type = parseType();
+	if (!type)
+		return 0;
+
+	const char* start = m_pos;
+	while (!atEnd() && (peek() != 'E'))
+		++m_pos;
+
+	CxxNode* node = makeNode(CXX_LITERAL);
+	if (!node || !consume('E'))
+		return 0;
+	node->m_a	= type;
+	node->m_str	= start;
+	node->m_len	= (uint32_t)(m_pos - 1 - start);
+	return node;
+}
+
+const CxxNode* CxxDemangler::parseUnresolvedName()
+{
+	// only the simple forms, <simple-id>, sr <type> <base-unresolved-name> and
+	// sr <unresolved-qualifier-level>+ E <base-unresolved-name> as emitted by GCC
+	consume('g', 's');
+
+	if (consume('s', 'r'))
+	{
+		const CxxNode* scope = 0;
+		const CxxNode* name = 0;
+		if (isDigit(peek()))
+		{
+			// levels are terminated with 'E' only when followed by the base name,
+			// otherwise the last simple id is the base name itself
+			while (isDigit(peek()) || ((peek() == 'o') && (peek(1) == 'n')))
+			{
+				const CxxNode* level = parseSimpleId();
+				if (!level)
+					return 0;
+				if (name)
+					scope = scope ? make(CXX_NESTED, scope, name) : name;
+				name = level;
+			}
+
+			if ((peek() == 'E') && (isDigit(peek(1)) || ((peek(1) == 'o') && (peek(2) == 'n'))))
+			{
+				++m_pos;
+				scope = scope ? make(CXX_NESTED, scope, name) : name;
+				name = parseSimpleId();
+			}
+			if (!scope)
+				return 0;
+		}
+		else
+		{
+			scope = (peek() == 'T') ? parseTemplateParam() : parseType();
+			name = scope ? parseSimpleId() : 0;
+		}
+
+		return name ? make(CXX_NESTED, scope, name) : 0;
+	}
+
+	return parseSimpleId();
+}
+
+const CxxNode* CxxDemangler::parseSimpleId()
+{
+	const CxxNode* name = consume('o', 'n') ? parseOperatorName(0) : parseSourceName();
+	if (!name)
+		return 0;
+
+	if (peek() == 'I')
+	{
+		const CxxNode* args = parseTemplateArgs();
+		if (!args)
+			return 0;
+		name = make(CXX_TEMPLATE, name, args);
+	}
+	return name;
+}
+
+const CxxNode* CxxDemangler::parseExpr()
+{
+	if (++m_depth > MAX_DEPTH)
+		return 0;
+
+	const CxxNode* result = 0;
+	char c = peek();
+
+	if (c == 'L')
+		result = parseExprPrimary();
+	else
+	if (c == 'T')
+		result = parseTemplateParam();
+	else
+	if (consume('f', 'p'))
+	{
+		if (consume('T'))
+			result = makeName("this", 4);
+		else
+		{
+			parseCVQualifiers();
+			uint32_t index = 0;
+			if (!consume('_'))
+			{
+				if (!parseNumber(index) || !consume('_'))
+					return 0;
+				++index;
+			}
+			result = makeNumber(CXX_FUNCTION_PARAM, index + 1);
+		}
+	}
+	else
+	if (consume('s', 't'))
+		result = makeStr(CXX_ENCLOSED, "sizeof (", parseType());
+	else
+	if (consume('s', 'z'))
+		result = makeStr(CXX_ENCLOSED, "sizeof (", parseExpr());
+	else
+	if (consume('a', 't'))
+		result = makeStr(CXX_ENCLOSED, "alignof (", parseType());
+	else
+	if (consume('a', 'z'))
+		result = makeStr(CXX_ENCLOSED, "alignof (", parseExpr());
+	else
+	if (consume('n', 'x'))
+		result = makeStr(CXX_ENCLOSED, "noexcept (", parseExpr());
+	else
+	if (consume('s', 'Z'))
+	{
+		const CxxNode* pack = (peek() == 'T') ? parseTemplateParam() : parseExpr();
+		result = pack ? make(CXX_SIZEOF_PACK, pack) : 0;
+	}
+	else
+	if (consume('s', 'p'))
+		result = make(CXX_PACK_EXPANSION, parseExpr());
+	else
+	if (consume('c', 'l'))
+	{
+		const CxxNode* function = parseExpr();
+		if (!function)
+			return 0;
+		uint32_t begin = m_numStack;
+		while (!consume('E'))
+		{
+			if (atEnd() || !push(parseExpr()))
+				return 0;
+		}
+		result = make(CXX_CALL, function, popList(begin));
+	}
+	else
+	if (consume('c', 'v'))
+	{
+		const CxxNode* type = parseType();
+		if (!type)
+			return 0;
+
+		uint32_t begin = m_numStack;
+		if (consume('_'))
+		{
+			while (!consume('E'))
+			{
+				if (atEnd() || !push(parseExpr()))
+					return 0;
+			}
+		}
+		else
+		if (!push(parseExpr()))
+			return 0;
+		result = make(CXX_CAST, type, popList(begin));
+	}
+	else
+	if (isDigit(c) || ((c == 's') && (peek(1) == 'r')) || ((c == 'g') && (peek(1) == 's')) || ((c == 'o') && (peek(1) == 'n')))
+		result = parseUnresolvedName();
+	else
+	if (isLower(c) && isLower(peek(1)))
+	{
+		for (uint32_t i=0; i<RTM_NUM_ELEMENTS(s_operators); ++i)
+		{
+			const CxxOperator& op = s_operators[i];
+			if ((op.m_code[0] != c) || (op.m_code[1] != peek(1)))
+				continue;
+
+			m_pos += 2;
+			if (op.m_arity == 1)
+			{
+				const CxxNode* operand = parseExpr();
+				if (!operand)
+					return 0;
+				result = makeStr(CXX_UNARY, op.m_name, operand);
+			}
+			else
+			if ((op.m_arity == 2) && (op.m_code[0] != 'c'))
+			{
+				const CxxNode* left = parseExpr();
+				if (!left)
+					return 0;
+				const CxxNode* right = ((op.m_code[0] == 'd') && (op.m_code[1] == 't')) || ((op.m_code[0] == 'p') && (op.m_code[1] == 't')) ?
+										parseUnresolvedName() : parseExpr();
+				if (!right)
+					return 0;
+				CxxNode* node = makeNode(CXX_BINARY);
+				if (!node)
+					return 0;
+				node->m_str	= op.m_name;
+				node->m_len	= cxxStrLen(op.m_name);
+				node->m_a	= left;
+				node->m_b	= right;
+				result = node;
+			}
+			else
+			if ((op.m_code[0] == 'q') && (op.m_code[1] == 'u'))
+			{
+				const CxxNode* condition = parseExpr();
+				const CxxNode* left = condition ? parseExpr() : 0;
+				const CxxNode* right = left ? parseExpr() : 0;
+				if (!right)
+					return 0;
+				CxxNode* node = makeNode(CXX_TERNARY);
+				if (!node)
+					return 0;
+				node->m_a	= condition;
+				node->m_b	= left;
+				node->m_c	= right;
+				result = node;
+			}
+			break;
+		}
+	}
+
+	if (!result)
+		return 0;
+
+	--m_depth;
+	return result;
+}
+
+//--------------------------------------------------------------------------
+/// Printing
+//--------------------------------------------------------------------------
+
+void CxxDemangler::write(const char* _str, uint32_t _len)
+{
+	for (uint32_t i=0; i<_len; ++i)
+	{
+		if (m_outPos + 1 < m_outSize)
+			m_out[m_outPos] = _str[i];
+		++m_outPos;
+	}
+
+	if (_len)
+		m_lastChar = _str[_len - 1];
+}
+
+void CxxDemangler::writeNumber(uint64_t _number)
+{
+	char digits[24];
+	uint32_t count = 0;
+	do
+	{
+		digits[count++] = (char)('0' + _number % 10);
+		_number /= 10;
+	} while (_number);
+
+	while (count)
+		write(&digits[--count], 1);
+}
+
+const CxxNode* CxxDemangler::lookupParam(const CxxNode* _param, const CxxScope*& _scope) const
+{
+	// argument is printed in the scope enclosing the one it was found in
+	if (!_scope || !_scope->m_args || (_param->m_len >= _scope->m_args->m_len))
+		return 0;
+
+	const CxxNode* arg = m_refs[_scope->m_args->m_index + _param->m_len];
+	_scope = _scope->m_next;
+	return arg;
+}
+
+const CxxNode* CxxDemangler::templateArgs(const CxxNode* _encoding)
+{
+	// template arguments of a function template are in scope of its return type and parameters
+	const CxxNode* name = _encoding->m_c;
+	if (name && (name->m_kind == CXX_LOCAL))
+	{
+		name = name->m_b;
+		if (name && (name->m_kind == CXX_NESTED) && name->m_a && (name->m_a->m_kind == CXX_NAME_NUMBER))
+			name = name->m_b;	// default argument
+	}
+	return (name && (name->m_kind == CXX_TEMPLATE)) ? name->m_b : 0;
+}
+
+const CxxNode* CxxDemangler::resolveType(const CxxNode* _node, const CxxScope*& _scope) const
+{
+	for (uint32_t i=0; _node && (i<MAX_DEPTH); ++i)
+	{
+		if ((_node->m_kind == CXX_TEMPLATE_PARAM) && !m_lambdaArg)
+		{
+			const CxxNode* arg = lookupParam(_node, _scope);
+			if (!arg)
+				break;
+			_node = arg;
+		}
+		else
+		if ((_node->m_kind == CXX_PACK) && (_node == m_packNode) && (m_packIndex < _node->m_len))
+			_node = m_refs[_node->m_index + m_packIndex];
+		else
+			break;
+	}
+	return _node;
+}
+
+const CxxScope* CxxDemangler::savedScope(const CxxNode* _param)
+{
+	for (uint32_t i=0; i<m_numSaved; ++i)
+		if (m_saved[i].m_param == _param)
+			return m_saved[i].m_scope;
+
+	if (m_numSaved == MAX_SAVED)
+		return m_scope;
+
+	// scopes live on the stack of printing functions, keep a copy
+	const CxxScope* copy = 0;
+	CxxScope* last = 0;
+	for (const CxxScope* scope = m_scope; scope; scope = scope->m_next)
+	{
+		if (m_numScopes == MAX_SCOPES)
+			return m_scope;
+
+		CxxScope* node = &m_scopes[m_numScopes++];
+		node->m_args = scope->m_args;
+		node->m_next = 0;
+		if (last)
+			last->m_next = node;
+		else
+			copy = node;
+		last = node;
+	}
+
+	m_saved[m_numSaved].m_param = _param;
+	m_saved[m_numSaved].m_scope = copy;
+	++m_numSaved;
+	return copy;
+}
+
+const CxxNode* CxxDemangler::collapseReference(const CxxNode* _node, uint8_t& _ref, const CxxScope*& _scope)
+{
+	// referenced template parameter reached again through a substitution is resolved
+	// in scope it was first printed in (same as c++filt)
+	if (_node->m_a && (_node->m_a->m_kind == CXX_TEMPLATE_PARAM) && !m_lambdaArg)
+		_scope = savedScope(_node->m_a);
+
+	// T& & -> T&, T&& & -> T&, T& && -> T&, T&& && -> T&&
+	_ref = _node->m_ref;
+	const CxxNode* target = resolveType(_node->m_a, _scope);
+	for (uint32_t i=0; target && (target->m_kind == CXX_REFERENCE) && (i<MAX_DEPTH); ++i)
+	{
+		if (target->m_ref == 1)
+			_ref = 1;
+		target = resolveType(target->m_a, _scope);
+	}
+	return target;
+}
+
+bool CxxDemangler::isArrayOrFunction(const CxxNode* _node) const
+{
+	const CxxScope* scope = m_scope;
+	_node = resolveType(_node, scope);
+	while (_node && (_node->m_kind == CXX_QUALIFIED))
+		_node = resolveType(_node->m_a, scope);
+	return _node && ((_node->m_kind == CXX_ARRAY) || (_node->m_kind == CXX_FUNCTION));
+}
+
+bool CxxDemangler::hasRHS(const CxxNode* _node) const
+{
+	const CxxScope* scope = m_scope;
+	for (uint32_t i=0; _node && (i<MAX_DEPTH); ++i)
+	{
+		_node = resolveType(_node, scope);
+		if (!_node)
+			break;
+
+		switch (_node->m_kind)
+		{
+		case CXX_FUNCTION:
+		case CXX_ARRAY:				return true;
+		case CXX_QUALIFIED:
+		case CXX_POINTER:
+		case CXX_REFERENCE:			_node = _node->m_a;	break;
+		case CXX_POINTER_TO_MEMBER:	_node = _node->m_b;	break;
+		default:					return false;
+		};
+	}
+	return false;
+}
+
+const CxxNode* CxxDemangler::baseName(const CxxNode* _node)
+{
+	for (uint32_t i=0; _node && (i<MAX_DEPTH); ++i)
+	{
+		switch (_node->m_kind)
+		{
+		case CXX_NESTED:			_node = _node->m_b;	break;
+		case CXX_TEMPLATE:
+		case CXX_ABI_TAG:
+		case CXX_STD_ABBREVIATION:	_node = _node->m_a;	break;
+		default:					return _node;
+		};
+	}
+	return _node;
+}
+
+const CxxNode* CxxDemangler::findPack(const CxxNode* _node, uint32_t _depth) const
+{
+	if (!_node || (_depth > MAX_DEPTH))
+		return 0;
+
+	switch (_node->m_kind)
+	{
+	case CXX_PACK:
+		return _node;
+
+	case CXX_PACK_EXPANSION:	// nested expansion has its own pack
+	case CXX_NAME:
+	case CXX_NAME_NUMBER:
+	case CXX_STD_ABBREVIATION:
+	case CXX_OPERATOR:
+	case CXX_LITERAL:
+	case CXX_FUNCTION_PARAM:
+	case CXX_UNNAMED_TYPE:
+	case CXX_LAMBDA:
+	case CXX_SIZEOF_PACK:
+		return 0;
+
+	case CXX_TEMPLATE_PARAM:
+		{
+			const CxxScope* scope = m_scope;
+			const CxxNode* arg = lookupParam(_node, scope);
+			return (arg && (arg->m_kind == CXX_PACK)) ? arg : 0;
+		}
+
+	case CXX_LIST:
+		for (uint32_t i=0; i<_node->m_len; ++i)
+		{
+			const CxxNode* pack = findPack(m_refs[_node->m_index + i], _depth + 1);
+			if (pack)
+				return pack;
+		}
+		return 0;
+	};
+
+	const CxxNode* pack = findPack(_node->m_a, _depth + 1);
+	if (!pack)
+		pack = findPack(_node->m_b, _depth + 1);
+	if (!pack && ((_node->m_kind == CXX_ENCODING) || (_node->m_kind == CXX_TERNARY)))
+		pack = findPack(_node->m_c, _depth + 1);
+	return pack;
+}
+
+void CxxDemangler::printNode(const CxxNode* _node)
+{
+	printLeft(_node);
+	printRight(_node);
+}
+
+void CxxDemangler::printList(const CxxNode* _list)
+{
+	if (!_list)
+		return;
+
+	bool first = true;
+	for (uint32_t i=0; i<_list->m_len; ++i)
+	{
+		uint32_t rollback = m_outPos;
+		if (!first)
+			write(", ", 2);
+
+		uint32_t start = m_outPos;
+		printNode(m_refs[_list->m_index + i]);
+
+		// empty pack expansions print nothing, drop the separator as well
+		if (m_outPos == start)
+			m_outPos = rollback;
+		else
+			first = false;
+	}
+}
+
+void CxxDemangler::printQualifiers(uint8_t _cv, uint8_t _ref)
+{
+	if (_cv & CXX_CONST)	write(" const");
+	if (_cv & CXX_VOLATILE)	write(" volatile");
+	if (_cv & CXX_RESTRICT)	write(" restrict");
+	if (_ref == 1)			write(" &");
+	if (_ref == 2)			write(" &&");
+}
+
+void CxxDemangler::printSubExpr(const CxxNode* _node)
+{
+	bool simple = _node && ((_node->m_kind == CXX_NAME) || (_node->m_kind == CXX_NESTED) || (_node->m_kind == CXX_FUNCTION_PARAM));
+	if (!simple)
+		write("(", 1);
+	printNode(_node);
+	if (!simple)
+		write(")", 1);
+}
+
+void CxxDemangler::printLiteral(const CxxNode* _node)
+{
+	const CxxNode* type = _node->m_a;
+	uint8_t kind = (type && (type->m_kind == CXX_NAME)) ? type->m_flag : (uint8_t)CXX_LIT_DEFAULT;
+
+	const char* value = _node->m_str;
+	uint32_t len = _node->m_len;
+	bool negative = (len > 0) && (value[0] == 'n');
+	if (negative)
+	{
+		++value;
+		--len;
+	}
+
+	if (kind == CXX_LIT_BOOL)
+	{
+		if ((len == 1) && (value[0] == '0'))	{ write("false"); return; }
+		if ((len == 1) && (value[0] == '1'))	{ write("true"); return; }
+	}
+
+	if ((kind == CXX_LIT_DEFAULT) || (kind == CXX_LIT_BOOL))
+	{
+		write("(", 1);
+		printNode(type);
+		write(")", 1);
+	}
+
+	if (negative)
+		write("-", 1);
+	write(value, len);
+
+	switch (kind)
+	{
+	case CXX_LIT_UNSIGNED:				write("u");		break;
+	case CXX_LIT_LONG:					write("l");		break;
+	case CXX_LIT_UNSIGNED_LONG:			write("ul");	break;
+	case CXX_LIT_LONG_LONG:				write("ll");	break;
+	case CXX_LIT_UNSIGNED_LONG_LONG:	write("ull");	break;
+	};
+}
+
+void CxxDemangler::printPackExpansion(const CxxNode* _node)
+{
+	const CxxNode* pack = findPack(_node->m_a, 0);
+	if (!pack)
+	{
+		printNode(_node->m_a);
+		write("...");
+		return;
+	}
+
+	const CxxNode*	packNode	= m_packNode;
+	uint32_t		packIndex	= m_packIndex;
+
+	bool first = true;
+	for (uint32_t i=0; i<pack->m_len; ++i)
+	{
+		m_packNode	= pack;
+		m_packIndex	= i;
+
+		uint32_t rollback = m_outPos;
+		if (!first)
+			write(", ", 2);
+
+		uint32_t start = m_outPos;
+		printNode(_node->m_a);
+		if (m_outPos == start)
+			m_outPos = rollback;
+		else
+			first = false;
+	}
+
+	m_packNode	= packNode;
+	m_packIndex	= packIndex;
+}
+
+void CxxDemangler::printParam(const CxxNode* _node, bool _left)
+{
+	// generic lambda parameters (same as c++filt)
+	if (m_lambdaArg)
+	{
+		if (_left)
+		{
+			write("auto:");
+			writeNumber(_node->m_len + 1);
+		}
+		return;
+	}
+
+	const CxxScope* scope = m_scope;
+	const CxxNode* arg = lookupParam(_node, scope);
+	if (!arg)
+	{
+		m_error = true;
+		return;
+	}
+
+	const CxxScope* outer = m_scope;
+	m_scope = scope;
+	if (_left)
+		printLeft(arg);
+	else
+		printRight(arg);
+	m_scope = outer;
+}
+
+void CxxDemangler::printFunction(const CxxNode* _encoding, bool _returnType)
+{
+	// name is printed in the enclosing scope, return type and parameters in scope of its template arguments
+	const CxxScope*	outer	= m_scope;
+	CxxScope		scope	= { templateArgs(_encoding), m_scope };
+	const CxxScope*	inner	= scope.m_args ? &scope : m_scope;
+	const CxxNode*	ret		= _returnType ? _encoding->m_a : 0;
+
+	m_scope = inner;
+	if (ret)
+	{
+		printLeft(ret);
+		if (!hasRHS(ret))
+			write(" ", 1);
+	}
+	m_scope = outer;
+	printNode(_encoding->m_c);
+	m_scope = inner;
+	write("(", 1);
+	printList(_encoding->m_b);
+	write(")", 1);
+	printQualifiers(_encoding->m_cv, _encoding->m_ref);
+	if (ret)
+		printRight(ret);
+	m_scope = outer;
+}
+
+void CxxDemangler::printLeft(const CxxNode* _node)
+{
+	if (!_node || full() || (++m_depth > MAX_DEPTH * 4))
+		return;
+
+	switch (_node->m_kind)
+	{
+	case CXX_NAME:
+	case CXX_STD_ABBREVIATION:
+		write(_node->m_str, _node->m_len);
+		break;
+
+	case CXX_NAME_NUMBER:
+		write(_node->m_str);
+		writeNumber(_node->m_len);
+		if (_node->m_str[0] == '{')
+			write("}", 1);
+		break;
+
+	case CXX_NESTED:
+		if (_node->m_flag)
+		{
+			// complex and imaginary
+			printNode(_node->m_a);
+			write(" ", 1);
+			printNode(_node->m_b);
+			break;
+		}
+		printNode(_node->m_a);
+		write("::", 2);
+		printNode(_node->m_b);
+		break;
+
+	case CXX_TEMPLATE:
+		{
+			const CxxNode* current = m_currentTemplate;
+			m_currentTemplate = _node;
+			printNode(_node->m_a);
+			if (m_lastChar == '<')
+				write(" ", 1);
+			write("<", 1);
+			printList(_node->m_b);
+			if (m_lastChar == '>')
+				write(" ", 1);
+			write(">", 1);
+			m_currentTemplate = current;
+		}
+		break;
+
+	case CXX_LIST:
+		printList(_node);
+		break;
+
+	case CXX_PACK:
+		if ((m_packNode == _node) && (m_packIndex < _node->m_len))
+			printLeft(m_refs[_node->m_index + m_packIndex]);
+		else
+			printList(_node);
+		break;
+
+	case CXX_QUALIFIED:
+		{
+			// qualifiers already present on substituted type are not repeated
+			const CxxScope* scope = m_scope;
+			const CxxNode* inner = resolveType(_node->m_a, scope);
+			uint8_t cv = (inner && (inner->m_kind == CXX_QUALIFIED)) ? inner->m_cv : 0;
+			printLeft(_node->m_a);
+			printQualifiers(_node->m_cv & ~cv, 0);
+		}
+		break;
+
+	case CXX_POINTER:
+	case CXX_REFERENCE:
+		{
+			// collapsed reference target is printed in scope it was resolved from
+			uint8_t ref = 0;
+			const CxxScope* outer = m_scope;
+			const CxxNode* target = _node->m_kind == CXX_POINTER ? _node->m_a : collapseReference(_node, ref, m_scope);
+			printLeft(target);
+			if (isArrayOrFunction(target))
+			{
+				if ((m_lastChar != ' ') && (m_lastChar != '('))
+					write(" ", 1);
+				write("(", 1);
+			}
+			m_scope = outer;
+			if (_node->m_kind == CXX_POINTER)
+				write("*", 1);
+			else
+				write(ref == 1 ? "&" : "&&");
+		}
+		break;
+
+	case CXX_FUNCTION:
+		printLeft(_node->m_a);
+		if (!hasRHS(_node->m_a))
+			write(" ", 1);
+		break;
+
+	case CXX_ENCODING:
+		printFunction(_node, true);
+		break;
+
+	case CXX_ARRAY:
+		printLeft(_node->m_a);
+		break;
+
+	case CXX_POINTER_TO_MEMBER:
+		printLeft(_node->m_b);
+		if (isArrayOrFunction(_node->m_b))
+			write("(", 1);
+		else
+			write(" ", 1);
+		printNode(_node->m_a);
+		write("::*", 3);
+		break;
+
+	case CXX_VECTOR:
+		printNode(_node->m_a);
+		write(" __vector(");
+		printNode(_node->m_b);
+		write(")", 1);
+		break;
+
+	case CXX_CTOR_DTOR:
+		if (_node->m_flag)
+			write("~", 1);
+		printNode(baseName(_node->m_a));
+		break;
+
+	case CXX_SPECIAL:
+		if (_node->m_len)
+			write(_node->m_str, _node->m_len);
+		else
+		{
+			// reference temporary, number node is stored as the prefix
+			printNode(_node->m_a);
+			write(" for ");
+			printNode(_node->m_b);
+			break;
+		}
+		printNode(_node->m_a);
+		break;
+
+	case CXX_CTOR_VTABLE:
+		write("construction vtable for ");
+		printNode(_node->m_a);
+		write("-in-");
+		printNode(_node->m_b);
+		break;
+
+	case CXX_LAMBDA:
+		write("{lambda(");
+		++m_lambdaArg;
+		printList(_node->m_b);
+		--m_lambdaArg;
+		write(")#");
+		writeNumber(_node->m_len);
+		write("}", 1);
+		break;
+
+	case CXX_UNNAMED_TYPE:
+		write("{unnamed type#");
+		writeNumber(_node->m_len);
+		write("}", 1);
+		break;
+
+	case CXX_ABI_TAG:
+		printNode(_node->m_a);
+		write("[abi:");
+		write(_node->m_str, _node->m_len);
+		write("]", 1);
+		break;
+
+	case CXX_LOCAL:
+		// enclosing function is printed without return type
+		if (_node->m_a->m_kind == CXX_ENCODING)
+			printFunction(_node->m_a, false);
+		else
+			printNode(_node->m_a);
+		if (_node->m_b)
+		{
+			write("::", 2);
+			printNode(_node->m_b);
+		}
+		break;
+
+	case CXX_CONVERSION:
+		write("operator ");
+		{
+			// type can reference template parameters of the enclosing template
+			const CxxScope*	outer	= m_scope;
+			CxxScope		scope	= { m_currentTemplate ? m_currentTemplate->m_b : 0, m_scope };
+			if (scope.m_args)
+				m_scope = &scope;
+			printNode(_node->m_a);
+			m_scope = outer;
+		}
+		break;
+
+	case CXX_OPERATOR:
+		write("operator");
+		write(_node->m_str, _node->m_len);
+		if (_node->m_a)
+			printNode(_node->m_a);
+		break;
+
+	case CXX_STRUCT_BINDING:
+		write("[", 1);
+		printList(_node->m_b);
+		write("]", 1);
+		break;
+
+	case CXX_TEMPLATE_PARAM:
+		printParam(_node, true);
+		break;
+
+	case CXX_PACK_EXPANSION:
+		printPackExpansion(_node);
+		break;
+
+	case CXX_LITERAL:
+		printLiteral(_node);
+		break;
+
+	case CXX_FUNCTION_PARAM:
+		write("{parm#");
+		writeNumber(_node->m_len);
+		write("}", 1);
+		break;
+
+	case CXX_ENCLOSED:
+		write(_node->m_str, _node->m_len);
+		printNode(_node->m_a);
+		write(")", 1);
+		break;
+
+	case CXX_SIZEOF_PACK:
+		{
+			// size of known pack is printed as a number (same as c++filt)
+			const CxxScope* scope = m_scope;
+			const CxxNode* pack = (_node->m_a->m_kind == CXX_TEMPLATE_PARAM) ? lookupParam(_node->m_a, scope) : 0;
+			if (pack && (pack->m_kind == CXX_PACK))
+				writeNumber(pack->m_len);
+			else
+			{
+				write("sizeof...(");
+				printNode(_node->m_a);
+				write(")", 1);
+			}
+		}
+		break;
+
+	case CXX_UNARY:
+		write(_node->m_str, _node->m_len);
+		{
+			// address of member function is printed as &Class::member (same as c++filt)
+			const CxxNode* operand = _node->m_a;
+			if ((_node->m_str[0] == '&') && operand && (operand->m_kind == CXX_ENCODING) && !operand->m_cv && !operand->m_ref &&
+				(operand->m_c->m_kind == CXX_NESTED))
+				printNode(operand->m_c);
+			else
+				printSubExpr(_node->m_a);
+		}
+		break;
+
+	case CXX_BINARY:
+		{
+			bool greater = (_node->m_len == 1) && (_node->m_str[0] == '>');
+			if (greater)
+				write("(", 1);
+			printSubExpr(_node->m_a);
+			write(_node->m_str, _node->m_len);
+			if ((_node->m_str[0] == '.') || ((_node->m_str[0] == '-') && (_node->m_str[1] == '>')))
+				printNode(_node->m_b);
+			else
+				printSubExpr(_node->m_b);
+			if (greater)
+				write(")", 1);
+		}
+		break;
+
+	case CXX_TERNARY:
+		printSubExpr(_node->m_a);
+		write("?", 1);
+		printSubExpr(_node->m_b);
+		write(" : ");
+		printSubExpr(_node->m_c);
+		break;
+
+	case CXX_CALL:
+		printSubExpr(_node->m_a);
+		write("(", 1);
+		printList(_node->m_b);
+		write(")", 1);
+		break;
+
+	case CXX_CAST:
+		write("(", 1);
+		printNode(_node->m_a);
+		write(")", 1);
+		if (_node->m_b && (_node->m_b->m_len == 1))
+			printSubExpr(m_refs[_node->m_b->m_index]);
+		else
+		{
+			write("(", 1);
+			printList(_node->m_b);
+			write(")", 1);
+		}
+		break;
+
+	case CXX_CLONE:
+		printNode(_node->m_a);
+		write(" [clone ");
+		write(_node->m_str, _node->m_len);
+		write("]", 1);
+		break;
+	};
+
+	--m_depth;
+}
+
+void CxxDemangler::printRight(const CxxNode* _node)
+{
+	if (!_node || full() || (++m_depth > MAX_DEPTH * 4))
+		return;
+
+	switch (_node->m_kind)
+	{
+	case CXX_QUALIFIED:
+		printRight(_node->m_a);
+		break;
+
+	case CXX_TEMPLATE_PARAM:
+		printParam(_node, false);
+		break;
+
+	case CXX_PACK:
+		if ((m_packNode == _node) && (m_packIndex < _node->m_len))
+			printRight(m_refs[_node->m_index + m_packIndex]);
+		break;
+
+	case CXX_POINTER:
+	case CXX_REFERENCE:
+		{
+			uint8_t ref = 0;
+			const CxxScope* outer = m_scope;
+			const CxxNode* target = _node->m_kind == CXX_POINTER ? _node->m_a : collapseReference(_node, ref, m_scope);
+			if (isArrayOrFunction(target))
+				write(")", 1);
+			printRight(target);
+			m_scope = outer;
+		}
+		break;
+
+	case CXX_FUNCTION:
+		write("(", 1);
+		printList(_node->m_b);
+		write(")", 1);
+		printQualifiers(_node->m_cv, _node->m_ref);
+		if (_node->m_flag)
+			write(" noexcept");
+		printRight(_node->m_a);
+		break;
+
+	case CXX_ARRAY:
+		if (m_lastChar != ']')
+			write(" ", 1);
+		write("[", 1);
+		if (_node->m_b)
+			printNode(_node->m_b);
+		write("]", 1);
+		printRight(_node->m_a);
+		break;
+
+	case CXX_POINTER_TO_MEMBER:
+		if (isArrayOrFunction(_node->m_b))
+			write(")", 1);
+		printRight(_node->m_b);
+		break;
+	};
+
+	--m_depth;
+}
+
+bool CxxDemangler::print(const CxxNode* _node, char* _buffer, uint32_t _bufferSize)
+{
+	m_out		= _buffer;
+	m_outSize	= _bufferSize;
+	m_outPos	= 0;
+	m_depth		= 0;
+
+	printNode(_node);
+
+	uint32_t end = m_outPos < _bufferSize ? m_outPos : _bufferSize - 1;
+	_buffer[end] = '\0';
+
+	// template parameter without argument in scope
+	return !m_error;
+}
+
+bool cxxDemangle(const char* _mangled, char* _buffer, uint32_t _bufferSize)
+{
+	if (!_mangled || !_buffer || (_bufferSize == 0))
+		return false;
+
+	if ((_mangled[0] != '_') || (_mangled[1] != 'Z'))
+		return false;
+
+	CxxDemangler demangler(_mangled);
+	const CxxNode* node = demangler.parse();
+	if (!node)
+		return false;
+
+	return demangler.print(node, _buffer, _bufferSize);
+}
+
+static inline bool isHexLower(char _c)
+{
+	return isDigit(_c) || ((_c >= 'a') && (_c <= 'f'));
+}
+
+bool isRustSymbol(const char* _name)
+{
+	if (!_name)
+		return false;
+
+	// extra underscore on macOS, legacy names from dbghelp come without any
+	uint32_t underscores = 0;
+	while ((_name[0] == '_') && (underscores < 2))
+	{
+		++_name;
+		++underscores;
+	}
+
+	// v0 paths start with an uppercase tag, a bare R is too common a start of plain names to accept
+	if (_name[0] == 'R')
+		return underscores && isUpper(_name[1]);
+
+	if ((_name[0] != 'Z') || (_name[1] != 'N'))
+		return false;
+
+	// walk the length prefixed path, the last element has to be the hash
+	const char* pos = _name + 2;
+	const char* last = 0;
+	uint32_t lastLen = 0;
+	while (isDigit(*pos))
+	{
+		uint32_t len = 0;
+		while (isDigit(*pos) && (len < 0x10000))
+			len = len * 10 + (uint32_t)(*pos++ - '0');
+
+		last	= pos;
+		lastLen	= len;
+		for (uint32_t i=0; i<len; ++i)
+			if (*pos++ == '\0')
+				return false;
+	}
+
+	if ((*pos++ != 'E') || (lastLen != 17) || (last[0] != 'h'))
+		return false;
+
+	for (uint32_t i=1; i<17; ++i)
+		if (!isHexLower(last[i]))
+			return false;
+
+	// nothing follows the path but a compiler added suffix, C++ names would have their parameter types there
+	return (*pos == '\0') || (*pos == '.');
+}
+
+} // namespace rdebug
@@ -0,0 +1,24 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_RDEBUG_CXX_DEMANGLE_H
+#define RTM_RDEBUG_CXX_DEMANGLE_H
+
+#include <stdint.h>
+
+namespace rdebug {
+
+/// Demangles Itanium C++ ABI symbol name (GCC, Clang, PlayStation toolchains), output matches c++filt.
+/// Works on stack memory only, no heap allocations are made. Output is truncated to fit the buffer.
+/// Returns false if name is not mangled or can't be demangled, buffer contents are undefined in that case.
+bool cxxDemangle(const char* _mangled, char* _buffer, uint32_t _bufferSize);
+
+/// True for Rust v0 symbols (_R) and legacy ones, legacy symbols are valid Itanium names too and are
+/// told apart by the 17h<16 hex digits> hash that ends their path.
+bool isRustSymbol(const char* _name);
+
+} // namespace rdebug
+
+#endif // RTM_RDEBUG_CXX_DEMANGLE_H
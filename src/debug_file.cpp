@@ -0,0 +1,240 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <rdebug_pch.h>
+#include <rdebug/src/debug_file.h>
+#include <rdebug/src/elf_file.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace rdebug {
+
+struct DebugFiles
+{
+	std::mutex										m_lock;
+	std::string										m_dirs;
+	std::unordered_map<std::string, std::string>	m_found;	// build ID to debug file path, empty if there is none
+
+	DebugFiles()
+	{
+#if !RTM_PLATFORM_WINDOWS
+		m_dirs = "/usr/lib/debug";
+#endif // !RTM_PLATFORM_WINDOWS
+	}
+};
+
+static DebugFiles& debugFiles()
+{
+	static DebugFiles s_debugFiles;
+	return s_debugFiles;
+}
+
+void debugFileSetDirectories(const char* _dirs)
+{
+	DebugFiles& files = debugFiles();
+	std::lock_guard<std::mutex> lock(files.m_lock);
+	files.m_dirs = _dirs ? _dirs : "";
+	files.m_found.clear();	// earlier results may not hold for the new directories
+}
+
+/// CRC32 as used by .gnu_debuglink (same as zlib), slicing by 8 bytes
+struct Crc32Table
+{
+	uint32_t m_table[8][256];
+
+	Crc32Table()
+	{
+		for (uint32_t i=0; i<256; ++i)
+		{
+			uint32_t crc = i;
+			for (uint32_t j=0; j<8; ++j)
+				crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+			m_table[0][i] = crc;
+		}
+
+		for (uint32_t i=0; i<256; ++i)
+			for (uint32_t j=1; j<8; ++j)
+				m_table[j][i] = (m_table[j - 1][i] >> 8) ^ m_table[0][m_table[j - 1][i] & 0xff];
+	}
+};
+
+static uint32_t crc32(const uint8_t* _data, uint64_t _size)
+{
+	static const Crc32Table s_crc;
+	const uint32_t (&t)[8][256] = s_crc.m_table;
+
+	uint32_t crc = 0xffffffff;
+	while (_size >= 8)
+	{
+		const uint32_t lo = crc ^ ((uint32_t)_data[0] | (uint32_t)_data[1] << 8 | (uint32_t)_data[2] << 16 | (uint32_t)_data[3] << 24);
+		crc =	t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+				t[3][_data[4]] ^ t[2][_data[5]] ^ t[1][_data[6]] ^ t[0][_data[7]];
+		_data += 8;
+		_size -= 8;
+	}
+
+	while (_size--)
+		crc = (crc >> 8) ^ t[0][(crc ^ *_data++) & 0xff];
+
+	return ~crc;
+}
+
+static bool sameBuildID(const ElfFile& _elf, const uint8_t* _id, uint32_t _size)
+{
+	const uint8_t* id;
+	uint32_t size;
+	return _elf.getBuildID(id, size) && (size == _size) && (memcmp(id, _id, size) == 0);
+}
+
+/// Debug file candidate found by build ID
+static bool checkBuildIDFile(const char* _path, const uint8_t* _id, uint32_t _size)
+{
+	ElfFile elf;
+	return elf.load(_path) && sameBuildID(elf, _id, _size);
+}
+
+/// Debug file candidate found by debug link, build ID check is cheaper so CRC is the fallback
+static bool checkDebugLinkFile(const char* _path, const char* _imagePath, uint32_t _crc, const uint8_t* _id, uint32_t _size)
+{
+	if (rtm::strCmp(_path, _imagePath) == 0)
+		return false;
+
+	ElfFile elf;
+	if (!elf.load(_path))
+		return false;
+
+	if (_id && sameBuildID(elf, _id, _size))
+		return true;
+
+	return crc32(elf.getData(), elf.getSize()) == _crc;
+}
+
+static bool findDebugFile(const ElfFile& _elf, const char* _imagePath, const std::string& _dirs, char* _path, uint32_t _pathSize)
+{
+	const uint8_t* id = 0;
+	uint32_t idSize = 0;
+	_elf.getBuildID(id, idSize);
+
+	const char* link = 0;
+	uint32_t linkCrc = 0;
+	_elf.getDebugLink(link, linkCrc);
+
+	char hex[3];
+	std::string path;
+
+	size_t start = 0;
+	while (id && (idSize > 1) && (start <= _dirs.size()))
+	{
+		size_t end = _dirs.find(';', start);
+		if (end == std::string::npos)
+			end = _dirs.size();
+
+		if (end > start)
+		{
+			path.assign(_dirs, start, end - start);
+			path += "/.build-id/";
+			for (uint32_t i=0; i<idSize; ++i)
+			{
+				snprintf(hex, sizeof(hex), "%02x", id[i]);
+				path += hex;
+				if (i == 0)
+					path += "/";
+			}
+			path += ".debug";
+
+			if (checkBuildIDFile(path.c_str(), id, idSize))
+			{
+				rtm::strlCpy(_path, _pathSize, path.c_str());
+				return path.size() < _pathSize;
+			}
+		}
+		start = end + 1;
+	}
+
+	if (!link)
+		return false;
+
+	const std::string imageDir(_imagePath, rtm::pathGetFileName(_imagePath) - _imagePath);
+
+	const std::string nextToImage[] = { imageDir + link, imageDir + ".debug/" + link };
+	for (uint32_t i=0; i<RTM_NUM_ELEMENTS(nextToImage); ++i)
+	{
+		if (checkDebugLinkFile(nextToImage[i].c_str(), _imagePath, linkCrc, id, idSize))
+		{
+			rtm::strlCpy(_path, _pathSize, nextToImage[i].c_str());
+			return nextToImage[i].size() < _pathSize;
+		}
+	}
+
+	start = 0;
+	while (start <= _dirs.size())
+	{
+		size_t end = _dirs.find(';', start);
+		if (end == std::string::npos)
+			end = _dirs.size();
+
+		if (end > start)
+		{
+			path.assign(_dirs, start, end - start);
+			if ((imageDir[0] != '/') && (imageDir[0] != '\\'))
+				path += "/";
+			path += imageDir + link;
+
+			if (checkDebugLinkFile(path.c_str(), _imagePath, linkCrc, id, idSize))
+			{
+				rtm::strlCpy(_path, _pathSize, path.c_str());
+				return path.size() < _pathSize;
+			}
+		}
+		start = end + 1;
+	}
+
+	return false;
+}
+
+bool debugFileFind(const char* _imagePath, char* _path, uint32_t _pathSize)
+{
+	ElfFile elf;
+	if (!elf.load(_imagePath) || elf.findDebugSection(".debug_info"))
+		return false;
+
+	const uint8_t* id;
+	uint32_t idSize;
+	std::string key;
+	if (elf.getBuildID(id, idSize))
+		key.assign((const char*)id, idSize);
+
+	DebugFiles& files = debugFiles();
+	std::string dirs;
+	{
+		std::lock_guard<std::mutex> lock(files.m_lock);
+		if (!key.empty())
+		{
+			std::unordered_map<std::string, std::string>::const_iterator it = files.m_found.find(key);
+			if (it != files.m_found.end())
+			{
+				rtm::strlCpy(_path, _pathSize, it->second.c_str());
+				return !it->second.empty() && (it->second.size() < _pathSize);
+			}
+		}
+		dirs = files.m_dirs;
+	}
+
+	// the walk is done unlocked, modules of a resolver are set up in parallel
+	const bool found = findDebugFile(elf, _imagePath, dirs, _path, _pathSize);
+
+	if (!key.empty())
+	{
+		std::lock_guard<std::mutex> lock(files.m_lock);
+		if (files.m_dirs == dirs)
+			files.m_found[key] = found ? _path : "";
+	}
+
+	return found;
+}
+
+} // namespace rdebug
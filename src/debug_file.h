@@ -0,0 +1,25 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_RDEBUG_DEBUG_FILE_H
+#define RTM_RDEBUG_DEBUG_FILE_H
+
+#include <rbase/inc/platform.h>
+
+namespace rdebug {
+
+/// Sets directories searched for separate debug files, separated by ';'
+void debugFileSetDirectories(const char* _dirs);
+
+/// Finds separate debug file of a stripped ELF image the same way GDB does: by build ID under
+/// <dir>/.build-id/xx/yyyy.debug, then by .gnu_debuglink name next to the image, in its .debug
+/// subdirectory and under <dir>/<image directory>. Debug link targets are verified by build ID or
+/// CRC. Results are remembered per build ID. Returns false if the image has its own debug info or
+/// no debug file was found.
+bool debugFileFind(const char* _imagePath, char* _path, uint32_t _pathSize);
+
+} // namespace rdebug
+
+#endif // RTM_RDEBUG_DEBUG_FILE_H
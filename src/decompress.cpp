@@ -0,0 +1,1749 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <rdebug_pch.h>
+#include <rdebug/src/decompress.h>
+
+#include <vector>
+
+namespace rdebug {
+
+static inline uint32_t highestBit(uint32_t _value)
+{
+	uint32_t bit = 0;
+	while (_value >>= 1)
+		++bit;
+	return bit;
+}
+
+/// Copies a match that may overlap its own output
+static inline void copyMatch(uint8_t* _dst, uint64_t _distance, uint64_t _length)
+{
+	const uint8_t* src = _dst - _distance;
+	if (_distance >= _length)
+	{
+		memcpy(_dst, src, (size_t)_length);
+		return;
+	}
+
+	for (uint64_t i=0; i<_length; ++i)
+		_dst[i] = src[i];
+}
+
+//--------------------------------------------------------------------------
+/// zlib / DEFLATE
+//--------------------------------------------------------------------------
+
+enum
+{
+	INFLATE_FAST_BITS	= 10,
+	INFLATE_MAX_BITS	= 15,
+	INFLATE_NUM_LITLEN	= 288,
+	INFLATE_NUM_DIST	= 30
+};
+
+static const uint16_t s_inflateLengthBase[29]	= { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t  s_inflateLengthExtra[29]	= { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t s_inflateDistBase[30]		= { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t  s_inflateDistExtra[30]	= { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+/// LSB first bit buffer, reads past the end of input return zeros and are caught by inflateOverrun
+struct InflateBits
+{
+	const uint8_t*	m_src;
+	uint64_t		m_srcSize;
+	uint64_t		m_pos;
+	uint64_t		m_bits;
+	uint32_t		m_count;
+};
+
+static inline void inflateRefill(InflateBits& _bits)
+{
+	while (_bits.m_count <= 56)
+	{
+		if (_bits.m_pos < _bits.m_srcSize)
+			_bits.m_bits |= (uint64_t)_bits.m_src[_bits.m_pos] << _bits.m_count;
+		++_bits.m_pos;
+		_bits.m_count += 8;
+	}
+}
+
+static inline uint32_t inflateConsume(InflateBits& _bits, uint32_t _count)
+{
+	const uint32_t value = (uint32_t)(_bits.m_bits & ((1ull << _count) - 1));
+	_bits.m_bits >>= _count;
+	_bits.m_count -= _count;
+	return value;
+}
+
+static inline uint32_t inflateGetBits(InflateBits& _bits, uint32_t _count)
+{
+	inflateRefill(_bits);
+	return inflateConsume(_bits, _count);
+}
+
+static inline bool inflateOverrun(const InflateBits& _bits)
+{
+	return _bits.m_pos * 8 - _bits.m_count > _bits.m_srcSize * 8;
+}
+
+/// Canonical Huffman code, short codes are decoded with a single lookup and long ones bit by bit
+struct InflateHuffman
+{
+	uint16_t	m_fast[1 << INFLATE_FAST_BITS];	// symbol << 4 | code length, 0 for codes longer than INFLATE_FAST_BITS
+	uint16_t	m_count[INFLATE_MAX_BITS + 1];
+	uint16_t	m_symbol[INFLATE_NUM_LITLEN];
+};
+
+static bool inflateBuild(InflateHuffman& _huffman, const uint8_t* _lengths, uint32_t _numSymbols)
+{
+	memset(_huffman.m_count, 0, sizeof(_huffman.m_count));
+	for (uint32_t i=0; i<_numSymbols; ++i)
+		_huffman.m_count[_lengths[i]]++;
+	_huffman.m_count[0] = 0;
+
+	// over subscribed sets are invalid, incomplete ones are allowed (single distance code)
+	int32_t left = 1;
+	uint16_t offsets[INFLATE_MAX_BITS + 2];
+	offsets[1] = 0;
+	for (uint32_t len=1; len<=INFLATE_MAX_BITS; ++len)
+	{
+		left = (left << 1) - _huffman.m_count[len];
+		if (left < 0)
+			return false;
+		offsets[len + 1] = offsets[len] + _huffman.m_count[len];
+	}
+
+	for (uint32_t i=0; i<_numSymbols; ++i)
+		if (_lengths[i])
+			_huffman.m_symbol[offsets[_lengths[i]]++] = (uint16_t)i;
+
+	memset(_huffman.m_fast, 0, sizeof(_huffman.m_fast));
+
+	// codes are stored MSB first in an LSB first stream, table is indexed by the reversed code
+	uint32_t code	= 0;
+	uint32_t index	= 0;
+	for (uint32_t len=1; len<=INFLATE_FAST_BITS; ++len)
+	{
+		for (uint32_t i=0; i<_huffman.m_count[len]; ++i, ++code, ++index)
+		{
+			uint32_t reversed = 0;
+			for (uint32_t bit=0; bit<len; ++bit)
+				reversed |= ((code >> bit) & 1) << (len - 1 - bit);
+
+			const uint16_t entry = (uint16_t)(_huffman.m_symbol[index] << 4 | len);
+			for (uint32_t j=reversed; j<(1 << INFLATE_FAST_BITS); j += 1 << len)
+				_huffman.m_fast[j] = entry;
+		}
+		code <<= 1;
+	}
+
+	return true;
+}
+
+/// Expects at least INFLATE_MAX_BITS bits in the buffer, returns -1 for an invalid code
+static inline int32_t inflateDecode(InflateBits& _bits, const InflateHuffman& _huffman)
+{
+	const uint16_t entry = _huffman.m_fast[_bits.m_bits & ((1 << INFLATE_FAST_BITS) - 1)];
+	if (entry)
+	{
+		inflateConsume(_bits, entry & 15);
+		return entry >> 4;
+	}
+
+	int32_t code	= 0;
+	int32_t first	= 0;
+	int32_t index	= 0;
+	for (uint32_t len=1; len<=INFLATE_MAX_BITS; ++len)
+	{
+		code |= (int32_t)((_bits.m_bits >> (len - 1)) & 1);
+		const int32_t count = _huffman.m_count[len];
+		if (code - first < count)
+		{
+			inflateConsume(_bits, len);
+			return _huffman.m_symbol[index + code - first];
+		}
+		index	+= count;
+		first	= (first + count) << 1;
+		code	<<= 1;
+	}
+	return -1;
+}
+
+static bool inflateCodes(InflateBits& _bits, const InflateHuffman& _litLen, const InflateHuffman& _dist, uint8_t* _dst, uint64_t _dstSize, uint64_t& _out)
+{
+	for (;;)
+	{
+		// longest length/distance pair is 15 + 5 + 15 + 13 bits, one refill covers it
+		inflateRefill(_bits);
+
+		const int32_t symbol = inflateDecode(_bits, _litLen);
+		if (symbol < 256)
+		{
+			if ((symbol < 0) || (_out == _dstSize))
+				return false;
+			_dst[_out++] = (uint8_t)symbol;
+			continue;
+		}
+
+		if (symbol == 256)
+			return !inflateOverrun(_bits);
+
+		const uint32_t lengthCode = (uint32_t)symbol - 257;
+		if (lengthCode >= RTM_NUM_ELEMENTS(s_inflateLengthBase))
+			return false;
+		const uint64_t length = s_inflateLengthBase[lengthCode] + inflateConsume(_bits, s_inflateLengthExtra[lengthCode]);
+
+		const int32_t distCode = inflateDecode(_bits, _dist);
+		if ((distCode < 0) || (distCode >= INFLATE_NUM_DIST))
+			return false;
+		const uint64_t distance = s_inflateDistBase[distCode] + inflateConsume(_bits, s_inflateDistExtra[distCode]);
+
+		if ((distance > _out) || (length > _dstSize - _out))
+			return false;
+
+		copyMatch(_dst + _out, distance, length);
+		_out += length;
+	}
+}
+
+static bool inflateStored(InflateBits& _bits, uint8_t* _dst, uint64_t _dstSize, uint64_t& _out)
+{
+	// back to byte boundary, whole bytes still in the bit buffer are given back to the input
+	inflateConsume(_bits, _bits.m_count & 7);
+	_bits.m_pos		-= _bits.m_count / 8;
+	_bits.m_bits	= 0;
+	_bits.m_count	= 0;
+
+	if ((_bits.m_pos > _bits.m_srcSize) || (_bits.m_srcSize - _bits.m_pos < 4))
+		return false;
+
+	const uint8_t* src = _bits.m_src + _bits.m_pos;
+	const uint32_t length	= (uint32_t)src[0] | (uint32_t)src[1] << 8;
+	const uint32_t nlength	= (uint32_t)src[2] | (uint32_t)src[3] << 8;
+	_bits.m_pos += 4;
+
+	if ((length != (~nlength & 0xffff)) || (length > _bits.m_srcSize - _bits.m_pos) || (length > _dstSize - _out))
+		return false;
+
+	memcpy(_dst + _out, _bits.m_src + _bits.m_pos, length);
+	_bits.m_pos	+= length;
+	_out		+= length;
+	return true;
+}
+
+static bool inflateDynamicTables(InflateBits& _bits, InflateHuffman& _litLen, InflateHuffman& _dist)
+{
+	static const uint8_t s_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	const uint32_t numLitLen	= inflateGetBits(_bits, 5) + 257;
+	const uint32_t numDist		= inflateGetBits(_bits, 5) + 1;
+	const uint32_t numCodeLen	= inflateGetBits(_bits, 4) + 4;
+	if ((numLitLen > 286) || (numDist > INFLATE_NUM_DIST))
+		return false;
+
+	uint8_t lengths[INFLATE_NUM_LITLEN + INFLATE_NUM_DIST];
+	memset(lengths, 0, sizeof(lengths));
+	for (uint32_t i=0; i<numCodeLen; ++i)
+		lengths[s_order[i]] = (uint8_t)inflateGetBits(_bits, 3);
+
+	InflateHuffman& codeLen = _dist;	// distance table isn't built yet, reuse its storage
+	if (!inflateBuild(codeLen, lengths, 19))
+		return false;
+
+	uint32_t index = 0;
+	while (index < numLitLen + numDist)
+	{
+		inflateRefill(_bits);
+		const int32_t symbol = inflateDecode(_bits, codeLen);
+		if (symbol < 0)
+			return false;
+
+		if (symbol < 16)
+		{
+			lengths[index++] = (uint8_t)symbol;
+			continue;
+		}
+
+		uint8_t length = 0;
+		uint32_t repeat;
+		if (symbol == 16)
+		{
+			if (index == 0)
+				return false;
+			length = lengths[index - 1];
+			repeat = 3 + inflateConsume(_bits, 2);
+		}
+		else if (symbol == 17)
+			repeat = 3 + inflateConsume(_bits, 3);
+		else
+			repeat = 11 + inflateConsume(_bits, 7);
+
+		if (index + repeat > numLitLen + numDist)
+			return false;
+		while (repeat--)
+			lengths[index++] = length;
+	}
+
+	// a block without end of block code can't be terminated
+	if (lengths[256] == 0)
+		return false;
+
+	return	inflateBuild(_litLen, lengths, numLitLen) &&
+			inflateBuild(_dist, lengths + numLitLen, numDist);
+}
+
+bool decompressZlib(const uint8_t* _src, uint64_t _srcSize, uint8_t* _dst, uint64_t _dstSize)
+{
+	// CMF, FLG: deflate method, window up to 32KB, no preset dictionary
+	if ((_srcSize < 2) || ((_src[0] & 0x0f) != 8) || ((_src[0] >> 4) > 7) || (((uint32_t)_src[0] << 8 | _src[1]) % 31) || (_src[1] & 0x20))
+		return false;
+
+	InflateBits bits;
+	bits.m_src		= _src;
+	bits.m_srcSize	= _srcSize;
+	bits.m_pos		= 2;
+	bits.m_bits		= 0;
+	bits.m_count	= 0;
+
+	std::vector<InflateHuffman> tables(2);
+	InflateHuffman& litLen	= tables[0];
+	InflateHuffman& dist	= tables[1];
+
+	uint64_t out = 0;
+	uint32_t last;
+	do
+	{
+		last = inflateGetBits(bits, 1);
+		const uint32_t type = inflateGetBits(bits, 2);
+
+		bool ok = false;
+		if (type == 0)
+			ok = inflateStored(bits, _dst, _dstSize, out);
+		else
+		if (type == 1)
+		{
+			uint8_t lengths[INFLATE_NUM_LITLEN + INFLATE_NUM_DIST];
+			memset(lengths +   0, 8, 144);
+			memset(lengths + 144, 9, 112);
+			memset(lengths + 256, 7,  24);
+			memset(lengths + 280, 8,   8);
+			memset(lengths + INFLATE_NUM_LITLEN, 5, INFLATE_NUM_DIST);
+			ok =	inflateBuild(litLen, lengths, INFLATE_NUM_LITLEN) &&
+					inflateBuild(dist, lengths + INFLATE_NUM_LITLEN, INFLATE_NUM_DIST) &&
+					inflateCodes(bits, litLen, dist, _dst, _dstSize, out);
+		}
+		else
+		if (type == 2)
+			ok =	inflateDynamicTables(bits, litLen, dist) &&
+					inflateCodes(bits, litLen, dist, _dst, _dstSize, out);
+
+		if (!ok)
+			return false;
+	} while (!last);
+
+	// Adler-32 trailer isn't verified, DWARF parsers bounds check everything they read
+	return out == _dstSize;
+}
+
+//--------------------------------------------------------------------------
+/// zstd
+//--------------------------------------------------------------------------
+
+enum
+{
+	ZSTD_MAGIC				= 0xfd2fb528,
+	ZSTD_SKIPPABLE_MAGIC	= 0x184d2a50,
+	ZSTD_SKIPPABLE_MASK		= 0xfffffff0,
+	ZSTD_BLOCK_MAX			= 128 * 1024,
+	ZSTD_HUF_MAX_BITS		= 11,
+	ZSTD_FSE_MAX_LOG		= 9,
+
+	ZSTD_LL_MAX_SYMBOL		= 35,
+	ZSTD_ML_MAX_SYMBOL		= 52,
+	ZSTD_OF_MAX_SYMBOL		= 31,
+	ZSTD_LL_MAX_LOG			= 9,
+	ZSTD_ML_MAX_LOG			= 9,
+	ZSTD_OF_MAX_LOG			= 8,
+	ZSTD_WEIGHTS_MAX_LOG	= 6
+};
+
+static const int16_t s_zstdLLDefault[36] = { 4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1, -1, -1, -1, -1 };
+static const int16_t s_zstdMLDefault[53] = { 1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1, -1, -1 };
+static const int16_t s_zstdOFDefault[29] = { 1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1 };
+
+static const uint32_t s_zstdLLBase[36]	= { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 18, 20, 22, 24, 28, 32, 40, 48, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536 };
+static const uint8_t  s_zstdLLExtra[36]	= { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 3, 3, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+static const uint32_t s_zstdMLBase[53]	= { 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34,
+											35, 37, 39, 41, 43, 47, 51, 59, 67, 83, 99, 131, 259, 515, 1027, 2051, 4099, 8195, 16387, 32771, 65539 };
+static const uint8_t  s_zstdMLExtra[53]	= { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+											1, 1, 1, 1, 2, 2, 3, 3, 4, 4, 5, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+
+static inline uint32_t zstdRead16(const uint8_t* _ptr) { return (uint32_t)_ptr[0] | (uint32_t)_ptr[1] << 8; }
+static inline uint32_t zstdRead24(const uint8_t* _ptr) { return zstdRead16(_ptr) | (uint32_t)_ptr[2] << 16; }
+static inline uint32_t zstdRead32(const uint8_t* _ptr) { return zstdRead16(_ptr) | zstdRead16(_ptr + 2) << 16; }
+
+/// Bit stream read backwards from the end, bits below the start read as zeros and leave the position negative
+struct ZstdBits
+{
+	const uint8_t*	m_src;
+	uint64_t		m_size;
+	int64_t			m_pos;	// number of bits not read yet
+};
+
+static bool zstdBitsInit(ZstdBits& _bits, const uint8_t* _src, uint64_t _size)
+{
+	// last byte holds the end marker, highest set bit
+	if (!_size || !_src[_size - 1])
+		return false;
+
+	_bits.m_src		= _src;
+	_bits.m_size	= _size;
+	_bits.m_pos		= (int64_t)(_size * 8) - 8 + (int64_t)highestBit(_src[_size - 1]);
+	return true;
+}
+
+static inline uint64_t zstdBitsRead(ZstdBits& _bits, uint32_t _count)
+{
+	if (!_count)
+		return 0;
+
+	_bits.m_pos -= _count;
+	int64_t pos = _bits.m_pos;
+	uint32_t count = _count;
+	uint32_t shift = 0;
+	if (pos < 0)
+	{
+		if ((int64_t)count <= -pos)
+			return 0;
+		shift = (uint32_t)-pos;
+		count -= shift;
+		pos = 0;
+	}
+
+	const uint64_t byte = (uint64_t)pos >> 3;
+	uint64_t word = 0;
+	if (byte + 8 <= _bits.m_size)
+	{
+		const uint8_t* p = _bits.m_src + byte;
+		word =	(uint64_t)p[0]       | (uint64_t)p[1] <<  8 | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24 |
+				(uint64_t)p[4] << 32 | (uint64_t)p[5] << 40 | (uint64_t)p[6] << 48 | (uint64_t)p[7] << 56;
+	}
+	else
+	{
+		for (uint64_t i=byte; i<_bits.m_size; ++i)
+			word |= (uint64_t)_bits.m_src[i] << ((i - byte) * 8);
+	}
+
+	return ((word >> (pos & 7)) & ((1ull << count) - 1)) << shift;
+}
+
+struct ZstdFse
+{
+	uint8_t		m_symbol[1 << ZSTD_FSE_MAX_LOG];
+	uint8_t		m_numBits[1 << ZSTD_FSE_MAX_LOG];
+	uint16_t	m_base[1 << ZSTD_FSE_MAX_LOG];
+	uint32_t	m_log;
+};
+
+static bool zstdFseBuild(ZstdFse& _fse, const int16_t* _counts, uint32_t _numSymbols, uint32_t _log)
+{
+	const uint32_t size	= 1 << _log;
+	uint32_t high		= size;
+	uint16_t next[256];
+
+	// 'less than one' probabilities take a single state each at the top of the table
+	for (uint32_t s=0; s<_numSymbols; ++s)
+	{
+		if (_counts[s] == -1)
+		{
+			if (high == 0)
+				return false;
+			_fse.m_symbol[--high] = (uint8_t)s;
+			next[s] = 1;
+		}
+	}
+
+	const uint32_t step = (size >> 1) + (size >> 3) + 3;
+	const uint32_t mask = size - 1;
+	uint32_t pos = 0;
+	for (uint32_t s=0; s<_numSymbols; ++s)
+	{
+		if (_counts[s] <= 0)
+			continue;
+		next[s] = (uint16_t)_counts[s];
+		for (int32_t i=0; i<_counts[s]; ++i)
+		{
+			_fse.m_symbol[pos] = (uint8_t)s;
+			do { pos = (pos + step) & mask; } while (pos >= high);
+		}
+	}
+
+	if (pos != 0)
+		return false;
+
+	for (uint32_t i=0; i<size; ++i)
+	{
+		const uint32_t state = next[_fse.m_symbol[i]]++;
+		_fse.m_numBits[i]	= (uint8_t)(_log - highestBit(state));
+		_fse.m_base[i]		= (uint16_t)((state << _fse.m_numBits[i]) - size);
+	}
+
+	_fse.m_log = _log;
+	return true;
+}
+
+static void zstdFseRLE(ZstdFse& _fse, uint8_t _symbol)
+{
+	_fse.m_symbol[0]	= _symbol;
+	_fse.m_numBits[0]	= 0;
+	_fse.m_base[0]		= 0;
+	_fse.m_log			= 0;
+}
+
+static inline uint32_t zstdForwardBits(const uint8_t* _src, uint64_t _size, uint64_t& _pos, uint32_t _count)
+{
+	uint32_t value = 0;
+	for (uint32_t i=0; i<_count; ++i, ++_pos)
+		if ((_pos >> 3) < _size)
+			value |= (uint32_t)((_src[_pos >> 3] >> (_pos & 7)) & 1) << i;
+	return value;
+}
+
+/// FSE table description, forward bit stream of normalized counts
+static bool zstdFseRead(ZstdFse& _fse, const uint8_t* _src, uint64_t _size, uint32_t _maxLog, uint32_t _maxSymbol, uint64_t& _consumed)
+{
+	uint64_t pos = 0;
+	const uint32_t log = zstdForwardBits(_src, _size, pos, 4) + 5;
+	if (log > _maxLog)
+		return false;
+
+	int16_t counts[256];
+	int32_t remaining = 1 << log;
+	uint32_t symbol = 0;
+	while ((remaining > 0) && (symbol <= _maxSymbol))
+	{
+		const uint32_t bits			= highestBit((uint32_t)remaining + 1) + 1;
+		uint32_t value				= zstdForwardBits(_src, _size, pos, bits);
+		const uint32_t lowerMask	= (1u << (bits - 1)) - 1;
+		const uint32_t threshold	= (1u << bits) - 1 - ((uint32_t)remaining + 1);
+
+		if ((value & lowerMask) < threshold)
+		{
+			--pos;
+			value &= lowerMask;
+		}
+		else if (value > lowerMask)
+			value -= threshold;
+
+		const int32_t count = (int32_t)value - 1;
+		remaining -= count < 0 ? -count : count;
+		counts[symbol++] = (int16_t)count;
+
+		if (count == 0)
+		{
+			uint32_t repeat;
+			do
+			{
+				repeat = zstdForwardBits(_src, _size, pos, 2);
+				for (uint32_t i=0; (i<repeat) && (symbol <= _maxSymbol); ++i)
+					counts[symbol++] = 0;
+			} while (repeat == 3);
+		}
+	}
+
+	_consumed = (pos + 7) >> 3;
+	if ((remaining != 0) || (_consumed > _size))
+		return false;
+
+	return zstdFseBuild(_fse, counts, symbol, log);
+}
+
+static inline uint32_t zstdFseUpdate(const ZstdFse& _fse, uint32_t _state, ZstdBits& _bits)
+{
+	return _fse.m_base[_state] + (uint32_t)zstdBitsRead(_bits, _fse.m_numBits[_state]);
+}
+
+struct ZstdHuffman
+{
+	uint8_t		m_symbol[1 << ZSTD_HUF_MAX_BITS];
+	uint8_t		m_numBits[1 << ZSTD_HUF_MAX_BITS];
+	uint32_t	m_maxBits;
+};
+
+/// Huffman tree description: weights, either 4 bit direct or FSE compressed, last weight is implied
+static bool zstdHuffmanRead(ZstdHuffman& _huffman, ZstdFse& _scratch, const uint8_t* _src, uint64_t _size, uint64_t& _consumed)
+{
+	if (!_size)
+		return false;
+
+	uint8_t weights[256];
+	uint32_t numWeights = 0;
+	const uint32_t header = _src[0];
+
+	if (header >= 128)
+	{
+		numWeights = header - 127;
+		_consumed = 1 + (numWeights + 1) / 2;
+		if (_consumed > _size)
+			return false;
+		for (uint32_t i=0; i<numWeights; ++i)
+			weights[i] = (i & 1) ? (_src[1 + i / 2] & 15) : (_src[1 + i / 2] >> 4);
+	}
+	else
+	{
+		_consumed = 1 + header;
+		if (_consumed > _size)
+			return false;
+
+		uint64_t tableSize;
+		if (!zstdFseRead(_scratch, _src + 1, header, ZSTD_WEIGHTS_MAX_LOG, 15, tableSize))
+			return false;
+
+		ZstdBits bits;
+		if (!zstdBitsInit(bits, _src + 1 + tableSize, header - tableSize))
+			return false;
+
+		// two interleaved states, decoding stops once the stream is overrun
+		uint32_t state1 = (uint32_t)zstdBitsRead(bits, _scratch.m_log);
+		uint32_t state2 = (uint32_t)zstdBitsRead(bits, _scratch.m_log);
+		for (;;)
+		{
+			if (numWeights > 253)
+				return false;
+
+			weights[numWeights++] = _scratch.m_symbol[state1];
+			state1 = zstdFseUpdate(_scratch, state1, bits);
+			if (bits.m_pos < 0)
+			{
+				weights[numWeights++] = _scratch.m_symbol[state2];
+				break;
+			}
+
+			weights[numWeights++] = _scratch.m_symbol[state2];
+			state2 = zstdFseUpdate(_scratch, state2, bits);
+			if (bits.m_pos < 0)
+			{
+				weights[numWeights++] = _scratch.m_symbol[state1];
+				break;
+			}
+		}
+	}
+
+	uint32_t weightSum = 0;
+	for (uint32_t i=0; i<numWeights; ++i)
+	{
+		if (weights[i] > ZSTD_HUF_MAX_BITS)
+			return false;
+		weightSum += weights[i] ? 1 << (weights[i] - 1) : 0;
+	}
+
+	if (!weightSum || (numWeights > 255))
+		return false;
+
+	const uint32_t maxBits	= highestBit(weightSum) + 1;
+	const uint32_t leftOver	= (1 << maxBits) - weightSum;
+	if ((maxBits > ZSTD_HUF_MAX_BITS) || (leftOver & (leftOver - 1)))
+		return false;
+	weights[numWeights++] = (uint8_t)(highestBit(leftOver) + 1);
+
+	// longest codes come first in the table, each symbol covers 2^(maxBits - bits) entries
+	uint32_t rankCount[ZSTD_HUF_MAX_BITS + 2];
+	memset(rankCount, 0, sizeof(rankCount));
+	for (uint32_t i=0; i<numWeights; ++i)
+		rankCount[weights[i] ? maxBits + 1 - weights[i] : 0]++;
+
+	uint32_t rankStart[ZSTD_HUF_MAX_BITS + 2];
+	rankStart[maxBits] = 0;
+	for (uint32_t bits=maxBits; bits>=1; --bits)
+		rankStart[bits - 1] = rankStart[bits] + rankCount[bits] * (1 << (maxBits - bits));
+
+	for (uint32_t i=0; i<numWeights; ++i)
+	{
+		if (!weights[i])
+			continue;
+		const uint32_t bits		= maxBits + 1 - weights[i];
+		const uint32_t count	= 1 << (maxBits - bits);
+		memset(&_huffman.m_symbol[rankStart[bits]], (int)i, count);
+		memset(&_huffman.m_numBits[rankStart[bits]], (int)bits, count);
+		rankStart[bits] += count;
+	}
+
+	_huffman.m_maxBits = maxBits;
+	return true;
+}
+
+static bool zstdHuffmanStream(const ZstdHuffman& _huffman, const uint8_t* _src, uint64_t _size, uint8_t* _dst, uint64_t _count)
+{
+	ZstdBits bits;
+	if (!zstdBitsInit(bits, _src, _size))
+		return false;
+
+	const uint32_t mask = (1 << _huffman.m_maxBits) - 1;
+	uint32_t state = (uint32_t)zstdBitsRead(bits, _huffman.m_maxBits);
+	for (uint64_t i=0; i<_count; ++i)
+	{
+		const uint32_t numBits = _huffman.m_numBits[state];
+		_dst[i] = _huffman.m_symbol[state];
+		state = ((state << numBits) + (uint32_t)zstdBitsRead(bits, numBits)) & mask;
+	}
+
+	// the state holds the last maxBits bits that were never consumed
+	return bits.m_pos == -(int64_t)_huffman.m_maxBits;
+}
+
+/// Decoding state carried between blocks of a frame
+struct ZstdFrame
+{
+	ZstdHuffman				m_huffman;
+	ZstdFse					m_litLen;
+	ZstdFse					m_offset;
+	ZstdFse					m_matchLen;
+	ZstdFse					m_scratch;
+	bool					m_hasHuffman;
+	bool					m_hasLitLen;
+	bool					m_hasOffset;
+	bool					m_hasMatchLen;
+	uint64_t				m_repeat[3];
+	std::vector<uint8_t>	m_literals;
+};
+
+static bool zstdLiterals(ZstdFrame& _frame, const uint8_t* _src, uint64_t _size, const uint8_t*& _literals, uint64_t& _numLiterals, uint64_t& _consumed)
+{
+	if (!_size)
+		return false;
+
+	const uint32_t type		= _src[0] & 3;
+	const uint32_t format	= (_src[0] >> 2) & 3;
+
+	if (type < 2)
+	{
+		uint32_t headerSize;
+		if ((format & 1) == 0)	{ headerSize = 1; _numLiterals = _src[0] >> 3; }
+		else if (format == 1)	{ headerSize = 2; if (_size < 2) return false; _numLiterals = zstdRead16(_src) >> 4; }
+		else					{ headerSize = 3; if (_size < 3) return false; _numLiterals = zstdRead24(_src) >> 4; }
+
+		if (_numLiterals > ZSTD_BLOCK_MAX)
+			return false;
+
+		if (type == 0)
+		{
+			if (_numLiterals > _size - headerSize)
+				return false;
+			_literals = _src + headerSize;
+			_consumed = headerSize + _numLiterals;
+			return true;
+		}
+
+		if (_size < headerSize + 1)
+			return false;
+		memset(&_frame.m_literals[0], _src[headerSize], (size_t)_numLiterals);
+		_literals = &_frame.m_literals[0];
+		_consumed = headerSize + 1;
+		return true;
+	}
+
+	uint32_t headerSize;
+	uint64_t compressedSize;
+	const bool fourStreams = format != 0;
+	if (format < 2)
+	{
+		if (_size < 3) return false;
+		const uint32_t header = zstdRead24(_src);
+		headerSize		= 3;
+		_numLiterals	= (header >> 4) & 0x3ff;
+		compressedSize	= header >> 14;
+	}
+	else if (format == 2)
+	{
+		if (_size < 4) return false;
+		const uint32_t header = zstdRead32(_src);
+		headerSize		= 4;
+		_numLiterals	= (header >> 4) & 0x3fff;
+		compressedSize	= header >> 18;
+	}
+	else
+	{
+		if (_size < 5) return false;
+		const uint64_t header = zstdRead32(_src) | (uint64_t)_src[4] << 32;
+		headerSize		= 5;
+		_numLiterals	= (header >> 4) & 0x3ffff;
+		compressedSize	= header >> 22;
+	}
+
+	if ((_numLiterals > ZSTD_BLOCK_MAX) || (compressedSize > _size - headerSize))
+		return false;
+
+	const uint8_t* src = _src + headerSize;
+	uint64_t size = compressedSize;
+
+	// treeless literals reuse the Huffman table of a previous block
+	if (type == 2)
+	{
+		uint64_t treeSize;
+		if (!zstdHuffmanRead(_frame.m_huffman, _frame.m_scratch, src, size, treeSize))
+			return false;
+		_frame.m_hasHuffman = true;
+		src		+= treeSize;
+		size	-= treeSize;
+	}
+	else if (!_frame.m_hasHuffman)
+		return false;
+
+	uint8_t* literals = &_frame.m_literals[0];
+	if (!fourStreams)
+	{
+		if (!zstdHuffmanStream(_frame.m_huffman, src, size, literals, _numLiterals))
+			return false;
+	}
+	else
+	{
+		if (size < 6)
+			return false;
+
+		uint64_t sizes[4] = { zstdRead16(src), zstdRead16(src + 2), zstdRead16(src + 4), 0 };
+		src		+= 6;
+		size	-= 6;
+		if (sizes[0] + sizes[1] + sizes[2] > size)
+			return false;
+		sizes[3] = size - sizes[0] - sizes[1] - sizes[2];
+
+		const uint64_t segment = (_numLiterals + 3) / 4;
+		if (segment * 3 > _numLiterals)
+			return false;
+
+		for (uint32_t i=0; i<4; ++i)
+		{
+			const uint64_t count = i < 3 ? segment : _numLiterals - segment * 3;
+			if (!zstdHuffmanStream(_frame.m_huffman, src, sizes[i], literals + segment * i, count))
+				return false;
+			src += sizes[i];
+		}
+	}
+
+	_literals = literals;
+	_consumed = headerSize + compressedSize;
+	return true;
+}
+
+static bool zstdSequenceTable(ZstdFse& _fse, bool& _hasTable, uint32_t _mode, const int16_t* _default, uint32_t _numDefault, uint32_t _defaultLog,
+							  uint32_t _maxLog, uint32_t _maxSymbol, const uint8_t* _src, uint64_t _size, uint64_t& _pos)
+{
+	switch (_mode)
+	{
+		case 0:
+			_hasTable = zstdFseBuild(_fse, _default, _numDefault, _defaultLog);
+			return _hasTable;
+
+		case 1:
+			if ((_pos >= _size) || (_src[_pos] > _maxSymbol))
+				return false;
+			zstdFseRLE(_fse, _src[_pos++]);
+			_hasTable = true;
+			return true;
+
+		case 2:
+		{
+			uint64_t consumed;
+			_hasTable = zstdFseRead(_fse, _src + _pos, _size - _pos, _maxLog, _maxSymbol, consumed);
+			_pos += consumed;
+			return _hasTable;
+		}
+
+		default:
+			return _hasTable;
+	};
+}
+
+static bool zstdCompressedBlock(ZstdFrame& _frame, const uint8_t* _src, uint64_t _size, uint8_t* _dst, uint64_t _dstSize, uint64_t& _out)
+{
+	const uint8_t* literals;
+	uint64_t numLiterals, pos;
+	if (!zstdLiterals(_frame, _src, _size, literals, numLiterals, pos))
+		return false;
+
+	if (pos >= _size)
+		return false;
+
+	uint64_t numSequences = _src[pos++];
+	if (numSequences >= 128)
+	{
+		if (pos >= _size)
+			return false;
+		if (numSequences < 255)
+			numSequences = ((numSequences - 128) << 8) + _src[pos++];
+		else
+		{
+			if (pos + 2 > _size)
+				return false;
+			numSequences = zstdRead16(_src + pos) + 0x7f00;
+			pos += 2;
+		}
+	}
+
+	if (numSequences)
+	{
+		if (pos >= _size)
+			return false;
+
+		const uint32_t modes = _src[pos++];
+		if ((modes & 3) ||
+			!zstdSequenceTable(_frame.m_litLen,		_frame.m_hasLitLen,		modes >> 6,			s_zstdLLDefault, RTM_NUM_ELEMENTS(s_zstdLLDefault), 6, ZSTD_LL_MAX_LOG, ZSTD_LL_MAX_SYMBOL, _src, _size, pos) ||
+			!zstdSequenceTable(_frame.m_offset,		_frame.m_hasOffset,		(modes >> 4) & 3,	s_zstdOFDefault, RTM_NUM_ELEMENTS(s_zstdOFDefault), 5, ZSTD_OF_MAX_LOG, ZSTD_OF_MAX_SYMBOL, _src, _size, pos) ||
+			!zstdSequenceTable(_frame.m_matchLen,	_frame.m_hasMatchLen,	(modes >> 2) & 3,	s_zstdMLDefault, RTM_NUM_ELEMENTS(s_zstdMLDefault), 6, ZSTD_ML_MAX_LOG, ZSTD_ML_MAX_SYMBOL, _src, _size, pos))
+			return false;
+
+		ZstdBits bits;
+		if (!zstdBitsInit(bits, _src + pos, _size - pos))
+			return false;
+
+		uint32_t litLenState	= (uint32_t)zstdBitsRead(bits, _frame.m_litLen.m_log);
+		uint32_t offsetState	= (uint32_t)zstdBitsRead(bits, _frame.m_offset.m_log);
+		uint32_t matchLenState	= (uint32_t)zstdBitsRead(bits, _frame.m_matchLen.m_log);
+
+		uint64_t* repeat = _frame.m_repeat;
+		for (uint64_t i=0; i<numSequences; ++i)
+		{
+			const uint32_t litLenCode	= _frame.m_litLen.m_symbol[litLenState];
+			const uint32_t offsetCode	= _frame.m_offset.m_symbol[offsetState];
+			const uint32_t matchLenCode	= _frame.m_matchLen.m_symbol[matchLenState];
+			if ((litLenCode > ZSTD_LL_MAX_SYMBOL) || (matchLenCode > ZSTD_ML_MAX_SYMBOL) || (offsetCode > ZSTD_OF_MAX_SYMBOL))
+				return false;
+
+			// offset bits come first, then match and literal length
+			const uint64_t offsetValue	= (1ull << offsetCode) + zstdBitsRead(bits, offsetCode);
+			const uint64_t matchLen		= s_zstdMLBase[matchLenCode] + zstdBitsRead(bits, s_zstdMLExtra[matchLenCode]);
+			const uint64_t litLen		= s_zstdLLBase[litLenCode] + zstdBitsRead(bits, s_zstdLLExtra[litLenCode]);
+
+			if (i + 1 < numSequences)
+			{
+				litLenState		= zstdFseUpdate(_frame.m_litLen, litLenState, bits);
+				matchLenState	= zstdFseUpdate(_frame.m_matchLen, matchLenState, bits);
+				offsetState		= zstdFseUpdate(_frame.m_offset, offsetState, bits);
+			}
+
+			uint64_t offset;
+			if (offsetValue > 3)
+			{
+				offset = offsetValue - 3;
+				repeat[2] = repeat[1];
+				repeat[1] = repeat[0];
+				repeat[0] = offset;
+			}
+			else
+			{
+				// repeat offsets, shifted by one when there are no literals
+				const uint64_t index = offsetValue - 1 + (litLen == 0 ? 1 : 0);
+				if (index == 0)
+					offset = repeat[0];
+				else
+				{
+					offset = index < 3 ? repeat[index] : repeat[0] - 1;
+					if (index > 1)
+						repeat[2] = repeat[1];
+					repeat[1] = repeat[0];
+					repeat[0] = offset;
+				}
+			}
+
+			if ((litLen > numLiterals) || (litLen > _dstSize - _out))
+				return false;
+			memcpy(_dst + _out, literals, (size_t)litLen);
+			literals	+= litLen;
+			numLiterals	-= litLen;
+			_out		+= litLen;
+
+			if ((offset == 0) || (offset > _out) || (matchLen > _dstSize - _out))
+				return false;
+			copyMatch(_dst + _out, offset, matchLen);
+			_out += matchLen;
+		}
+
+		if (bits.m_pos != 0)
+			return false;
+	}
+	else if (pos != _size)
+		return false;
+
+	if (numLiterals > _dstSize - _out)
+		return false;
+	memcpy(_dst + _out, literals, (size_t)numLiterals);
+	_out += numLiterals;
+	return true;
+}
+
+struct ZstdFrameHeader
+{
+	uint64_t	m_contentSize;
+	bool		m_hasContentSize;
+	bool		m_checksum;
+};
+
+/// Frame header following the magic number
+static bool zstdFrameHeader(const uint8_t* _src, uint64_t _size, uint64_t& _pos, ZstdFrameHeader& _header)
+{
+	if (_pos >= _size)
+		return false;
+
+	const uint32_t descriptor	= _src[_pos++];
+	const uint32_t sizeFlag		= descriptor >> 6;
+	const bool singleSegment	= (descriptor & 0x20) != 0;
+	static const uint32_t s_dictIDSize[4] = { 0, 1, 2, 4 };
+	static const uint32_t s_contentSizeSize[4] = { 0, 2, 4, 8 };
+	const uint32_t dictIDSize	= s_dictIDSize[descriptor & 3];
+	const uint32_t sizeSize		= sizeFlag ? s_contentSizeSize[sizeFlag] : (singleSegment ? 1 : 0);
+
+	if (descriptor & 0x08)
+		return false;
+
+	// whole output is in memory, so the window size is only ever a bound we don't need
+	if (!singleSegment)
+		++_pos;
+
+	if (_pos + dictIDSize + sizeSize > _size)
+		return false;
+
+	for (uint32_t i=0; i<dictIDSize; ++i)
+		if (_src[_pos++])
+			return false;
+
+	_header.m_contentSize = 0;
+	for (uint32_t i=0; i<sizeSize; ++i)
+		_header.m_contentSize |= (uint64_t)_src[_pos++] << (i * 8);
+	if (sizeSize == 2)
+		_header.m_contentSize += 256;
+
+	_header.m_hasContentSize	= sizeSize != 0;
+	_header.m_checksum			= (descriptor & 0x04) != 0;
+	return true;
+}
+
+static bool zstdFrame(ZstdFrame& _frame, const uint8_t* _src, uint64_t _size, uint64_t& _pos, uint8_t* _dst, uint64_t _dstSize, uint64_t& _out)
+{
+	ZstdFrameHeader header;
+	if (!zstdFrameHeader(_src, _size, _pos, header))
+		return false;
+
+	_frame.m_hasHuffman		= false;
+	_frame.m_hasLitLen		= false;
+	_frame.m_hasOffset		= false;
+	_frame.m_hasMatchLen	= false;
+	_frame.m_repeat[0]		= 1;
+	_frame.m_repeat[1]		= 4;
+	_frame.m_repeat[2]		= 8;
+
+	const uint64_t frameStart = _out;
+	bool last;
+	do
+	{
+		if (_pos + 3 > _size)
+			return false;
+
+		const uint32_t block	= zstdRead24(_src + _pos);
+		const uint32_t type		= (block >> 1) & 3;
+		const uint64_t size		= block >> 3;
+		last = (block & 1) != 0;
+		_pos += 3;
+
+		if (type == 1)
+		{
+			if ((_pos >= _size) || (size > _dstSize - _out))
+				return false;
+			memset(_dst + _out, _src[_pos++], (size_t)size);
+			_out += size;
+			continue;
+		}
+
+		if ((type == 3) || (size > _size - _pos) || (size > ZSTD_BLOCK_MAX))
+			return false;
+
+		if (type == 0)
+		{
+			if (size > _dstSize - _out)
+				return false;
+			memcpy(_dst + _out, _src + _pos, (size_t)size);
+			_out += size;
+		}
+		else
+		if (!zstdCompressedBlock(_frame, _src + _pos, size, _dst, _dstSize, _out))
+			return false;
+
+		_pos += size;
+	} while (!last);
+
+	// XXH64 checksum isn't verified, DWARF parsers bounds check everything they read
+	if (header.m_checksum)
+		_pos += 4;
+
+	return (_pos <= _size) && (!header.m_hasContentSize || (_out - frameStart == header.m_contentSize));
+}
+
+/// Walks block headers of a frame without decoding them
+static bool zstdSkipFrame(const uint8_t* _src, uint64_t _size, uint64_t& _pos, ZstdFrameHeader& _header)
+{
+	if (!zstdFrameHeader(_src, _size, _pos, _header))
+		return false;
+
+	bool last;
+	do
+	{
+		if (_pos + 3 > _size)
+			return false;
+
+		const uint32_t block = zstdRead24(_src + _pos);
+		const uint64_t size = ((block >> 1) & 3) == 1 ? 1 : block >> 3;
+		last = (block & 1) != 0;
+		_pos += 3;
+		if (size > _size - _pos)
+			return false;
+		_pos += size;
+	} while (!last);
+
+	if (_header.m_checksum)
+		_pos += 4;
+	return _pos <= _size;
+}
+
+bool decompressZstd(const uint8_t* _src, uint64_t _srcSize, uint8_t* _dst, uint64_t _dstSize)
+{
+	std::vector<ZstdFrame> frame(1);
+	frame[0].m_literals.resize(ZSTD_BLOCK_MAX);
+
+	uint64_t pos = 0;
+	uint64_t out = 0;
+	while (pos < _srcSize)
+	{
+		if (_srcSize - pos < 4)
+			return false;
+
+		const uint32_t magic = zstdRead32(_src + pos);
+		pos += 4;
+
+		if ((magic & ZSTD_SKIPPABLE_MASK) == ZSTD_SKIPPABLE_MAGIC)
+		{
+			if (_srcSize - pos < 4)
+				return false;
+			const uint64_t size = zstdRead32(_src + pos);
+			pos += 4;
+			if (size > _srcSize - pos)
+				return false;
+			pos += size;
+			continue;
+		}
+
+		if ((magic != ZSTD_MAGIC) || !zstdFrame(frame[0], _src, _srcSize, pos, _dst, _dstSize, out))
+			return false;
+	}
+
+	return out == _dstSize;
+}
+
+void decompressSplitZstd(const uint8_t* _src, uint64_t _srcSize, uint8_t* _dst, uint64_t _dstSize, std::vector<DecompressChunk>& _chunks)
+{
+	const size_t first = _chunks.size();
+
+	// frames don't reference each other, with known sizes each one gets its own slice of the output
+	uint64_t pos = 0;
+	uint64_t out = 0;
+	bool split = true;
+	while (split && (pos < _srcSize))
+	{
+		if (_srcSize - pos < 8)
+		{
+			split = false;
+			break;
+		}
+
+		const uint64_t start = pos;
+		const uint32_t magic = zstdRead32(_src + pos);
+		pos += 4;
+
+		if ((magic & ZSTD_SKIPPABLE_MASK) == ZSTD_SKIPPABLE_MAGIC)
+		{
+			const uint64_t size = zstdRead32(_src + pos);
+			pos += 4;
+			split = size <= _srcSize - pos;
+			pos += size;
+			continue;
+		}
+
+		ZstdFrameHeader header;
+		split = (magic == ZSTD_MAGIC) && zstdSkipFrame(_src, _srcSize, pos, header) && header.m_hasContentSize && (header.m_contentSize <= _dstSize - out);
+		if (split)
+		{
+			DecompressChunk chunk = { _src + start, pos - start, _dst + out, header.m_contentSize, true };
+			_chunks.push_back(chunk);
+			out += header.m_contentSize;
+		}
+	}
+
+	if (split && (out == _dstSize) && (_chunks.size() > first))
+		return;
+
+	// let the decoder report whatever is wrong with the stream
+	_chunks.resize(first);
+	DecompressChunk chunk = { _src, _srcSize, _dst, _dstSize, true };
+	_chunks.push_back(chunk);
+}
+
+bool decompressChunk(const DecompressChunk& _chunk)
+{
+	if (_chunk.m_zstd)
+		return decompressZstd(_chunk.m_src, _chunk.m_srcSize, _chunk.m_dst, _chunk.m_dstSize);
+	return decompressZlib(_chunk.m_src, _chunk.m_srcSize, _chunk.m_dst, _chunk.m_dstSize);
+}
+
+//--------------------------------------------------------------------------
+/// xz / LZMA2
+//--------------------------------------------------------------------------
+
+enum
+{
+	XZ_HEADER_SIZE			= 12,
+	XZ_FOOTER_SIZE			= 12,
+	XZ_FILTER_LZMA2			= 0x21,
+
+	LZMA_NUM_STATES			= 12,
+	LZMA_POS_STATES_MAX		= 1 << 4,
+	LZMA_LITERAL_SIZE		= 0x300,
+	LZMA_LITERAL_MAX		= LZMA_LITERAL_SIZE << 4,	// lc + lp is at most 4 in LZMA2
+	LZMA_LEN_LOW_BITS		= 3,
+	LZMA_LEN_MID_BITS		= 3,
+	LZMA_LEN_HIGH_BITS		= 8,
+	LZMA_LEN_TO_POS_STATES	= 4,
+	LZMA_POS_SLOT_BITS		= 6,
+	LZMA_END_POS_MODEL		= 14,
+	LZMA_FULL_DISTANCES		= 1 << (LZMA_END_POS_MODEL >> 1),
+	LZMA_ALIGN_BITS			= 4,
+	LZMA_MATCH_MIN_LEN		= 2,
+	LZMA_LIT_STATES			= 7,	// states below are after a literal, so there is no match byte
+	LZMA_PROB_BITS			= 11,
+	LZMA_PROB_INIT			= 1 << (LZMA_PROB_BITS - 1),
+	LZMA_MOVE_BITS			= 5,
+	LZMA_RANGE_TOP			= 1 << 24
+};
+
+static const uint8_t s_xzMagic[6] = { 0xfd, '7', 'z', 'X', 'Z', 0x00 };
+
+static inline uint32_t xzRead16BE(const uint8_t* _ptr) { return (uint32_t)_ptr[0] << 8 | _ptr[1]; }
+static inline uint32_t xzRead32(const uint8_t* _ptr) { return zstdRead32(_ptr); }
+
+/// Multibyte integer, 7 bits per byte with the highest bit set on all but the last byte
+static bool xzReadVli(const uint8_t* _src, uint64_t _size, uint64_t& _pos, uint64_t& _value)
+{
+	_value = 0;
+	for (uint32_t i=0; i<9; ++i)
+	{
+		if (_pos >= _size)
+			return false;
+
+		const uint8_t byte = _src[_pos++];
+		_value |= (uint64_t)(byte & 0x7f) << (i * 7);
+		if (!(byte & 0x80))
+			return (byte != 0) || (i == 0);	// no redundant trailing zero bytes
+	}
+	return false;
+}
+
+/// Parses stream index starting with its indicator byte, sums uncompressed sizes and sizes of blocks with their padding
+static bool xzReadIndex(const uint8_t* _src, uint64_t _size, uint64_t& _pos, uint64_t& _uncompressed, uint64_t& _blocks)
+{
+	const uint64_t start = _pos;
+	uint64_t numRecords;
+	if ((_pos >= _size) || (_src[_pos++] != 0) || !xzReadVli(_src, _size, _pos, numRecords))
+		return false;
+
+	_uncompressed	= 0;
+	_blocks			= 0;
+	for (uint64_t i=0; i<numRecords; ++i)
+	{
+		uint64_t unpadded, uncompressed;
+		if (!xzReadVli(_src, _size, _pos, unpadded) || !xzReadVli(_src, _size, _pos, uncompressed))
+			return false;
+		_blocks			+= (unpadded + 3) & ~3ull;
+		_uncompressed	+= uncompressed;
+	}
+
+	_pos += (4 - ((_pos - start) & 3)) & 3;
+	_pos += 4;	// CRC32
+	return _pos <= _size;
+}
+
+/// Stream header: magic, flags and their CRC32. Returns size of the check stored after each block.
+static bool xzStreamHeader(const uint8_t* _src, uint64_t _size, uint64_t _pos, uint32_t& _checkSize)
+{
+	if ((_size - _pos < XZ_HEADER_SIZE) || memcmp(_src + _pos, s_xzMagic, sizeof(s_xzMagic)) || _src[_pos + 6] || (_src[_pos + 7] > 0x0f))
+		return false;
+
+	// none, CRC32, CRC64 and SHA-256 are types 0, 1, 4 and 10, sizes are defined for reserved types too
+	const uint32_t type = _src[_pos + 7];
+	_checkSize = type ? 4 << ((type - 1) / 3) : 0;
+	return true;
+}
+
+bool decompressXzSize(const uint8_t* _src, uint64_t _srcSize, uint64_t& _dstSize)
+{
+	_dstSize = 0;
+
+	// streams are walked back to front, the index of each one is found from its footer
+	uint64_t end = _srcSize;
+	uint32_t numStreams = 0;
+	for (;;)
+	{
+		while ((end >= 4) && (xzRead32(_src + end - 4) == 0))
+			end -= 4;	// stream padding
+
+		if (!end && numStreams)
+			return true;
+
+		if ((end < XZ_HEADER_SIZE + XZ_FOOTER_SIZE) || (_src[end - 2] != 'Y') || (_src[end - 1] != 'Z'))
+			return false;
+
+		const uint64_t footer	= end - XZ_FOOTER_SIZE;
+		const uint64_t backward	= ((uint64_t)xzRead32(_src + footer + 4) + 1) * 4;
+		if (backward > footer - XZ_HEADER_SIZE)
+			return false;
+
+		uint64_t pos = footer - backward;
+		uint64_t uncompressed, blocks;
+		if (!xzReadIndex(_src, footer, pos, uncompressed, blocks) || (pos != footer) || (blocks > footer - backward - XZ_HEADER_SIZE))
+			return false;
+
+		uint32_t checkSize;
+		end = footer - backward - blocks - XZ_HEADER_SIZE;
+		if (!xzStreamHeader(_src, _srcSize, end, checkSize))
+			return false;
+
+		_dstSize += uncompressed;
+		++numStreams;
+	}
+}
+
+/// Range decoder, reads past the end return zeros and are caught by checking the position
+struct LzmaRange
+{
+	const uint8_t*	m_src;
+	uint64_t		m_size;
+	uint64_t		m_pos;
+	uint32_t		m_range;
+	uint32_t		m_code;
+};
+
+static inline void lzmaNormalize(LzmaRange& _rc)
+{
+	if (_rc.m_range < LZMA_RANGE_TOP)
+	{
+		_rc.m_range <<= 8;
+		_rc.m_code = (_rc.m_code << 8) | (_rc.m_pos < _rc.m_size ? _rc.m_src[_rc.m_pos] : 0);
+		++_rc.m_pos;
+	}
+}
+
+static inline uint32_t lzmaBit(LzmaRange& _rc, uint16_t& _prob)
+{
+	lzmaNormalize(_rc);
+	const uint32_t bound = (_rc.m_range >> LZMA_PROB_BITS) * _prob;
+	if (_rc.m_code < bound)
+	{
+		_rc.m_range = bound;
+		_prob += ((1 << LZMA_PROB_BITS) - _prob) >> LZMA_MOVE_BITS;
+		return 0;
+	}
+
+	_rc.m_range -= bound;
+	_rc.m_code	-= bound;
+	_prob -= _prob >> LZMA_MOVE_BITS;
+	return 1;
+}
+
+static inline uint32_t lzmaDirectBits(LzmaRange& _rc, uint32_t _count)
+{
+	uint32_t value = 0;
+	for (uint32_t i=0; i<_count; ++i)
+	{
+		lzmaNormalize(_rc);
+		_rc.m_range >>= 1;
+		const uint32_t bit = _rc.m_code >= _rc.m_range ? 1 : 0;
+		if (bit)
+			_rc.m_code -= _rc.m_range;
+		value = (value << 1) | bit;
+	}
+	return value;
+}
+
+static inline uint32_t lzmaTree(LzmaRange& _rc, uint16_t* _probs, uint32_t _numBits)
+{
+	uint32_t m = 1;
+	for (uint32_t i=0; i<_numBits; ++i)
+		m = (m << 1) | lzmaBit(_rc, _probs[m]);
+	return m - (1 << _numBits);
+}
+
+static inline uint32_t lzmaTreeReverse(LzmaRange& _rc, uint16_t* _probs, uint32_t _numBits)
+{
+	uint32_t m = 1;
+	uint32_t symbol = 0;
+	for (uint32_t i=0; i<_numBits; ++i)
+	{
+		const uint32_t bit = lzmaBit(_rc, _probs[m]);
+		m = (m << 1) | bit;
+		symbol |= bit << i;
+	}
+	return symbol;
+}
+
+struct LzmaLen
+{
+	uint16_t	m_choice;
+	uint16_t	m_choice2;
+	uint16_t	m_low[LZMA_POS_STATES_MAX][1 << LZMA_LEN_LOW_BITS];
+	uint16_t	m_mid[LZMA_POS_STATES_MAX][1 << LZMA_LEN_MID_BITS];
+	uint16_t	m_high[1 << LZMA_LEN_HIGH_BITS];
+};
+
+/// Probabilities only, so that they can be reset as a single array
+struct LzmaProbs
+{
+	uint16_t	m_isMatch[LZMA_NUM_STATES][LZMA_POS_STATES_MAX];
+	uint16_t	m_isRep[LZMA_NUM_STATES];
+	uint16_t	m_isRepG0[LZMA_NUM_STATES];
+	uint16_t	m_isRepG1[LZMA_NUM_STATES];
+	uint16_t	m_isRepG2[LZMA_NUM_STATES];
+	uint16_t	m_isRep0Long[LZMA_NUM_STATES][LZMA_POS_STATES_MAX];
+	uint16_t	m_posSlot[LZMA_LEN_TO_POS_STATES][1 << LZMA_POS_SLOT_BITS];
+	uint16_t	m_posSpecial[1 + LZMA_FULL_DISTANCES - LZMA_END_POS_MODEL];
+	uint16_t	m_align[1 << LZMA_ALIGN_BITS];
+	LzmaLen		m_len;
+	LzmaLen		m_repLen;
+	uint16_t	m_literal[LZMA_LITERAL_MAX];
+};
+
+struct LzmaDecoder
+{
+	LzmaProbs	m_probs;
+	uint32_t	m_lc;
+	uint32_t	m_lp;
+	uint32_t	m_pb;
+	uint32_t	m_state;
+	uint32_t	m_rep[4];
+	uint64_t	m_dictStart;	// output position of the last dictionary reset, matches can't reach before it
+};
+
+static void lzmaReset(LzmaDecoder& _lzma)
+{
+	uint16_t* probs = (uint16_t*)&_lzma.m_probs;
+	for (size_t i=0; i<sizeof(LzmaProbs) / sizeof(uint16_t); ++i)
+		probs[i] = LZMA_PROB_INIT;
+
+	_lzma.m_state = 0;
+	_lzma.m_rep[0] = _lzma.m_rep[1] = _lzma.m_rep[2] = _lzma.m_rep[3] = 0;
+}
+
+static inline uint32_t lzmaLength(LzmaRange& _rc, LzmaLen& _len, uint32_t _posState)
+{
+	if (!lzmaBit(_rc, _len.m_choice))
+		return lzmaTree(_rc, _len.m_low[_posState], LZMA_LEN_LOW_BITS);
+	if (!lzmaBit(_rc, _len.m_choice2))
+		return (1 << LZMA_LEN_LOW_BITS) + lzmaTree(_rc, _len.m_mid[_posState], LZMA_LEN_MID_BITS);
+	return (1 << LZMA_LEN_LOW_BITS) + (1 << LZMA_LEN_MID_BITS) + lzmaTree(_rc, _len.m_high, LZMA_LEN_HIGH_BITS);
+}
+
+static inline uint32_t lzmaDistance(LzmaRange& _rc, LzmaProbs& _probs, uint32_t _len)
+{
+	const uint32_t lenState	= _len < LZMA_LEN_TO_POS_STATES ? _len : LZMA_LEN_TO_POS_STATES - 1;
+	const uint32_t posSlot	= lzmaTree(_rc, _probs.m_posSlot[lenState], LZMA_POS_SLOT_BITS);
+	if (posSlot < 4)
+		return posSlot;
+
+	const uint32_t numDirectBits = (posSlot >> 1) - 1;
+	uint32_t distance = (2 | (posSlot & 1)) << numDirectBits;
+	if (posSlot < LZMA_END_POS_MODEL)
+		return distance + lzmaTreeReverse(_rc, _probs.m_posSpecial + distance - posSlot, numDirectBits);
+
+	distance += lzmaDirectBits(_rc, numDirectBits - LZMA_ALIGN_BITS) << LZMA_ALIGN_BITS;
+	return distance + lzmaTreeReverse(_rc, _probs.m_align, LZMA_ALIGN_BITS);
+}
+
+/// Decodes one LZMA2 chunk, matches never cross chunk boundaries and there is no end marker
+static bool lzmaChunk(LzmaDecoder& _lzma, LzmaRange& _rc, uint8_t* _dst, uint64_t& _out, uint64_t _end)
+{
+	LzmaProbs& probs		= _lzma.m_probs;
+	uint32_t* rep			= _lzma.m_rep;
+	uint32_t state			= _lzma.m_state;
+	const uint32_t pbMask	= (1 << _lzma.m_pb) - 1;
+	const uint32_t lpMask	= (1 << _lzma.m_lp) - 1;
+	uint64_t out			= _out;
+
+	while (out < _end)
+	{
+		const uint32_t posState = (uint32_t)out & pbMask;
+
+		if (!lzmaBit(_rc, probs.m_isMatch[state][posState]))
+		{
+			const uint32_t prevByte	= out > _lzma.m_dictStart ? _dst[out - 1] : 0;
+			const uint32_t litState	= (((uint32_t)out & lpMask) << _lzma.m_lc) + (prevByte >> (8 - _lzma.m_lc));
+			uint16_t* literal		= probs.m_literal + LZMA_LITERAL_SIZE * litState;
+
+			uint32_t symbol = 1;
+			if (state >= LZMA_LIT_STATES)
+			{
+				// after a match the byte at rep0 predicts the literal until the first mismatching bit
+				if (rep[0] >= out - _lzma.m_dictStart)
+					return false;
+
+				uint32_t matchByte = _dst[out - rep[0] - 1];
+				do
+				{
+					const uint32_t matchBit = (matchByte >> 7) & 1;
+					matchByte <<= 1;
+					const uint32_t bit = lzmaBit(_rc, literal[((1 + matchBit) << 8) + symbol]);
+					symbol = (symbol << 1) | bit;
+					if (matchBit != bit)
+						break;
+				} while (symbol < 0x100);
+			}
+
+			while (symbol < 0x100)
+				symbol = (symbol << 1) | lzmaBit(_rc, literal[symbol]);
+
+			_dst[out++] = (uint8_t)symbol;
+			state = state < 4 ? 0 : (state < 10 ? state - 3 : state - 6);
+			continue;
+		}
+
+		uint32_t len;
+		if (lzmaBit(_rc, probs.m_isRep[state]))
+		{
+			if (out == _lzma.m_dictStart)
+				return false;
+
+			if (!lzmaBit(_rc, probs.m_isRepG0[state]))
+			{
+				if (!lzmaBit(_rc, probs.m_isRep0Long[state][posState]))
+				{
+					// short rep, single byte at rep0
+					if (rep[0] >= out - _lzma.m_dictStart)
+						return false;
+					state = state < LZMA_LIT_STATES ? 9 : 11;
+					_dst[out] = _dst[out - rep[0] - 1];
+					++out;
+					continue;
+				}
+			}
+			else
+			{
+				uint32_t distance;
+				if (!lzmaBit(_rc, probs.m_isRepG1[state]))
+					distance = rep[1];
+				else
+				{
+					if (!lzmaBit(_rc, probs.m_isRepG2[state]))
+						distance = rep[2];
+					else
+					{
+						distance = rep[3];
+						rep[3] = rep[2];
+					}
+					rep[2] = rep[1];
+				}
+				rep[1] = rep[0];
+				rep[0] = distance;
+			}
+
+			len = lzmaLength(_rc, probs.m_repLen, posState);
+			state = state < LZMA_LIT_STATES ? 8 : 11;
+		}
+		else
+		{
+			rep[3] = rep[2];
+			rep[2] = rep[1];
+			rep[1] = rep[0];
+			len = lzmaLength(_rc, probs.m_len, posState);
+			state = state < LZMA_LIT_STATES ? 7 : 10;
+			rep[0] = lzmaDistance(_rc, probs, len);
+		}
+
+		len += LZMA_MATCH_MIN_LEN;
+		if ((rep[0] >= out - _lzma.m_dictStart) || (len > _end - out))
+			return false;
+
+		copyMatch(_dst + out, (uint64_t)rep[0] + 1, len);
+		out += len;
+	}
+
+	_lzma.m_state	= state;
+	_out			= out;
+	return _rc.m_pos <= _rc.m_size;
+}
+
+/// Decodes LZMA2 chunks of a block up to and including the end marker
+static bool lzma2Decode(LzmaDecoder& _lzma, const uint8_t* _src, uint64_t _size, uint64_t& _pos, uint8_t* _dst, uint64_t _dstSize, uint64_t& _out)
+{
+	bool needDictReset	= true;
+	bool needProps		= true;
+
+	for (;;)
+	{
+		if (_pos >= _size)
+			return false;
+
+		const uint32_t control = _src[_pos++];
+		if (control == 0)
+			return true;
+
+		// 1 and 0xe0 and above reset the dictionary, the first chunk of a block must do it
+		if ((control >= 0xe0) || (control == 1))
+		{
+			needDictReset		= false;
+			needProps			= true;
+			_lzma.m_dictStart	= _out;
+		}
+		else
+		if (needDictReset)
+			return false;
+
+		if (control < 0x80)
+		{
+			// uncompressed chunk
+			if ((control > 2) || (_size - _pos < 2))
+				return false;
+
+			const uint64_t size = xzRead16BE(_src + _pos) + 1;
+			_pos += 2;
+			if ((size > _size - _pos) || (size > _dstSize - _out))
+				return false;
+
+			memcpy(_dst + _out, _src + _pos, (size_t)size);
+			_pos += size;
+			_out += size;
+			continue;
+		}
+
+		if (_size - _pos < 4)
+			return false;
+
+		const uint64_t unpacked	= ((uint64_t)(control & 0x1f) << 16) + xzRead16BE(_src + _pos) + 1;
+		const uint64_t packed	= xzRead16BE(_src + _pos + 2) + 1;
+		const uint32_t reset	= (control >> 5) & 3;
+		_pos += 4;
+
+		if (reset >= 2)
+		{
+			if (_pos >= _size)
+				return false;
+
+			const uint32_t props = _src[_pos++];
+			if (props >= 9 * 5 * 5)
+				return false;
+
+			_lzma.m_lc = props % 9;
+			_lzma.m_lp = (props / 9) % 5;
+			_lzma.m_pb = props / 45;
+			if (_lzma.m_lc + _lzma.m_lp > 4)
+				return false;
+			needProps = false;
+		}
+		else
+		if (needProps)
+			return false;
+
+		if (reset >= 1)
+			lzmaReset(_lzma);
+
+		if ((packed > _size - _pos) || (packed < 5) || (unpacked > _dstSize - _out))
+			return false;
+
+		// range coder starts over in every chunk, first byte is always zero
+		LzmaRange rc;
+		rc.m_src	= _src + _pos;
+		rc.m_size	= packed;
+		rc.m_pos	= 5;
+		rc.m_range	= 0xffffffff;
+		rc.m_code	= (uint32_t)rc.m_src[1] << 24 | (uint32_t)rc.m_src[2] << 16 | (uint32_t)rc.m_src[3] << 8 | rc.m_src[4];
+		if (rc.m_src[0] || (rc.m_code == rc.m_range))
+			return false;
+
+		if (!lzmaChunk(_lzma, rc, _dst, _out, _out + unpacked))
+			return false;
+		_pos += packed;
+	}
+}
+
+/// Decodes one block starting at its header, leaves position after the block check
+static bool xzBlock(LzmaDecoder& _lzma, const uint8_t* _src, uint64_t _size, uint64_t& _pos, uint32_t _checkSize, uint8_t* _dst, uint64_t _dstSize, uint64_t& _out)
+{
+	const uint64_t start		= _pos;
+	const uint64_t headerSize	= ((uint64_t)_src[_pos] + 1) * 4;
+	if ((headerSize > _size - _pos) || (headerSize < 8))
+		return false;
+
+	// header CRC32 isn't verified, same as the checks below
+	const uint64_t headerEnd	= _pos + headerSize - 4;
+	const uint32_t flags		= _src[_pos + 1];
+	_pos += 2;
+
+	// a single LZMA2 filter, BCJ and delta filters aren't used for debug data
+	if (flags & 0x3f)
+		return false;
+
+	uint64_t compressedSize = 0, uncompressedSize = 0, filter = 0, propsSize = 0;
+	if ((flags & 0x40) && !xzReadVli(_src, headerEnd, _pos, compressedSize))
+		return false;
+	if ((flags & 0x80) && !xzReadVli(_src, headerEnd, _pos, uncompressedSize))
+		return false;
+	if (!xzReadVli(_src, headerEnd, _pos, filter) || !xzReadVli(_src, headerEnd, _pos, propsSize))
+		return false;
+	if ((filter != XZ_FILTER_LZMA2) || (propsSize != 1) || (_pos >= headerEnd) || (_src[_pos] > 40))
+		return false;
+
+	_pos = headerEnd + 4;
+
+	const uint64_t dataStart	= _pos;
+	const uint64_t outStart		= _out;
+	if (!lzma2Decode(_lzma, _src, _size, _pos, _dst, _dstSize, _out))
+		return false;
+
+	if (((flags & 0x40) && (compressedSize != _pos - dataStart)) || ((flags & 0x80) && (uncompressedSize != _out - outStart)))
+		return false;
+
+	_pos += (4 - ((_pos - start) & 3)) & 3;
+	_pos += _checkSize;
+	return _pos <= _size;
+}
+
+bool decompressXz(const uint8_t* _src, uint64_t _srcSize, uint8_t* _dst, uint64_t _dstSize)
+{
+	std::vector<LzmaDecoder> lzma(1);
+
+	uint64_t pos = 0;
+	uint64_t out = 0;
+	while (pos < _srcSize)
+	{
+		uint32_t checkSize;
+		if (!xzStreamHeader(_src, _srcSize, pos, checkSize))
+			return false;
+		pos += XZ_HEADER_SIZE;
+
+		const uint64_t streamOut = out;
+		while ((pos < _srcSize) && _src[pos])
+			if (!xzBlock(lzma[0], _src, _srcSize, pos, checkSize, _dst, _dstSize, out))
+				return false;
+
+		uint64_t uncompressed, blocks;
+		if (!xzReadIndex(_src, _srcSize, pos, uncompressed, blocks) || (uncompressed != out - streamOut))
+			return false;
+
+		if ((_srcSize - pos < XZ_FOOTER_SIZE) || (_src[pos + 10] != 'Y') || (_src[pos + 11] != 'Z'))
+			return false;
+		pos += XZ_FOOTER_SIZE;
+
+		while ((_srcSize - pos >= 4) && (xzRead32(_src + pos) == 0))
+			pos += 4;	// stream padding
+	}
+
+	return out == _dstSize;
+}
+
+} // namespace rdebug
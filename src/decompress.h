@@ -0,0 +1,47 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_RDEBUG_DECOMPRESS_H
+#define RTM_RDEBUG_DECOMPRESS_H
+
+#include <rbase/inc/platform.h>
+#include <vector>
+
+namespace rdebug {
+
+/// Independently decodable part of a compressed section
+struct DecompressChunk
+{
+	const uint8_t*	m_src;
+	uint64_t		m_srcSize;
+	uint8_t*		m_dst;
+	uint64_t		m_dstSize;
+	bool			m_zstd;
+};
+
+/// Inflates a zlib stream (RFC 1950/1951) into a buffer of known size, as stored in compressed ELF sections.
+/// Returns false on malformed data or if the stream doesn't decompress to exactly _dstSize bytes.
+bool decompressZlib(const uint8_t* _src, uint64_t _srcSize, uint8_t* _dst, uint64_t _dstSize);
+
+/// Same as above for one or more zstd frames (RFC 8878), dictionaries are not supported
+bool decompressZstd(const uint8_t* _src, uint64_t _srcSize, uint8_t* _dst, uint64_t _dstSize);
+
+/// Splits a zstd stream into frames that can be decoded in parallel if each of them records its content
+/// size, otherwise adds the whole stream as a single chunk. zlib streams can't be split.
+void decompressSplitZstd(const uint8_t* _src, uint64_t _srcSize, uint8_t* _dst, uint64_t _dstSize, std::vector<DecompressChunk>& _chunks);
+
+/// Decompresses a chunk with the matching decoder
+bool decompressChunk(const DecompressChunk& _chunk);
+
+/// Uncompressed size of an xz stream (or concatenated streams), summed from the stream indices
+bool decompressXzSize(const uint8_t* _src, uint64_t _srcSize, uint64_t& _dstSize);
+
+/// Decodes xz streams with a single LZMA2 filter, as used by MiniDebugInfo. Integrity checks are
+/// skipped. Returns false on malformed data or if the output isn't exactly _dstSize bytes.
+bool decompressXz(const uint8_t* _src, uint64_t _srcSize, uint8_t* _dst, uint64_t _dstSize);
+
+} // namespace rdebug
+
+#endif // RTM_RDEBUG_DECOMPRESS_H
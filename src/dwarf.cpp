@@ -0,0 +1,610 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <rdebug_pch.h>
+#include <rdebug/src/dwarf.h>
+#include <rdebug/src/elf_file.h>
+
+namespace rdebug {
+
+/// Sets contents of named sections, compressed ones are inflated here on first use, all of them at once
+/// so they decompress in parallel
+template <uint32_t N>
+static void loadSections(const ElfFile& _elf, const char* const (&_names)[N], DwarfSection* const (&_sections)[N])
+{
+	const ElfFile::Section* found[N];
+	for (uint32_t i=0; i<N; ++i)
+		found[i] = _elf.findDebugSection(_names[i]);
+
+	_elf.decompressSections(found, N);
+
+	for (uint32_t i=0; i<N; ++i)
+		_sections[i]->m_data = _elf.getSectionContents(found[i], _sections[i]->m_size);
+}
+
+void DwarfSections::init(const ElfFile& _elf)
+{
+	static const char* s_names[] =
+	{
+		".debug_info",
+		".debug_abbrev",
+		".debug_line",
+		".debug_str",
+		".debug_line_str",
+		".debug_str_offsets",
+		".debug_addr",
+		".debug_ranges",
+		".debug_rnglists",
+		".debug_aranges"
+	};
+
+	DwarfSection* sections[] = { &m_info, &m_abbrev, &m_line, &m_str, &m_lineStr, &m_strOffsets, &m_addr, &m_ranges, &m_rngLists, &m_aranges };
+	loadSections(_elf, s_names, sections);
+
+	m_bigEndian = _elf.isBigEndian();
+}
+
+void DwarfSections::initSplit(const ElfFile& _dwo, const DwarfSections& _skeleton)
+{
+	static const char* s_names[] =
+	{
+		".debug_info.dwo",
+		".debug_abbrev.dwo",
+		".debug_str.dwo",
+		".debug_str_offsets.dwo",
+		".debug_rnglists.dwo"
+	};
+
+	DwarfSection* sections[] = { &m_info, &m_abbrev, &m_str, &m_strOffsets, &m_rngLists };
+	loadSections(_dwo, s_names, sections);
+
+	// split units resolve addresses through the skeleton's .debug_addr, pre DWARF 5 ones use its .debug_ranges too
+	m_line		= _skeleton.m_line;
+	m_lineStr	= _skeleton.m_lineStr;
+	m_addr		= _skeleton.m_addr;
+	m_ranges	= _skeleton.m_ranges;
+	m_aranges	= DwarfSection();
+	m_bigEndian	= _dwo.isBigEndian();
+}
+
+DwarfUnit::DwarfUnit()
+	: m_offset(0)
+	, m_dieOffset(0)
+	, m_end(0)
+	, m_abbrevOffset(0)
+	, m_strOffsetsBase(0)
+	, m_addrBase(0)
+	, m_rngListsBase(0)
+	, m_baseAddress(0)
+	, m_dwoId(0)
+	, m_version(0)
+	, m_unitType(0)
+	, m_addressSize(0)
+	, m_is64(false)
+{
+}
+
+bool DwarfUnit::parseHeader(const DwarfSections& _sections, uint64_t _offset)
+{
+	DwarfReader reader(_sections.m_info.m_data, _sections.m_info.m_size, _sections.m_bigEndian);
+	if (!reader.skip(_offset))
+		return false;
+
+	uint64_t length;
+	if (!reader.readLength(length, m_is64))
+		return false;
+
+	m_offset	= _offset;
+	m_end		= reader.m_pos + length;
+	m_version	= reader.readU16();
+
+	if ((m_version < 2) || (m_version > 5))
+		return false;
+
+	if (m_version >= 5)
+	{
+		m_unitType		= reader.readU8();
+		m_addressSize	= reader.readU8();
+		m_abbrevOffset	= reader.readOffset(m_is64);
+
+		if ((m_unitType == DW_UT_skeleton) || (m_unitType == DW_UT_split_compile))
+			m_dwoId = reader.readU64();
+		else
+		if ((m_unitType == DW_UT_type) || (m_unitType == DW_UT_split_type))
+		{
+			reader.readU64();				// type signature
+			reader.readOffset(m_is64);		// type offset
+		}
+	}
+	else
+	{
+		m_unitType		= DW_UT_compile;
+		m_abbrevOffset	= reader.readOffset(m_is64);
+		m_addressSize	= reader.readU8();
+	}
+
+	m_dieOffset = reader.m_pos;
+	return !reader.m_error && (m_dieOffset <= m_end) && ((m_addressSize == 4) || (m_addressSize == 8) || (m_addressSize == 2));
+}
+
+bool DwarfAbbrevTable::parse(const DwarfSections& _sections, uint64_t _offset)
+{
+	m_abbrevs.clear();
+	m_specs.clear();
+	m_dense = true;
+
+	DwarfReader reader(_sections.m_abbrev.m_data, _sections.m_abbrev.m_size, _sections.m_bigEndian);
+	if (!reader.skip(_offset))
+		return false;
+
+	while (!reader.eof())
+	{
+		uint64_t code = reader.readULEB();
+		if (code == 0)
+			break;
+
+		DwarfAbbrev abbrev;
+		abbrev.m_code			= (uint32_t)code;
+		abbrev.m_tag			= (uint32_t)reader.readULEB();
+		abbrev.m_hasChildren	= reader.readU8() != 0;
+		abbrev.m_firstSpec		= (uint32_t)m_specs.size();
+		abbrev.m_numSpecs		= 0;
+
+		for (;;)
+		{
+			DwarfAttribSpec spec;
+			spec.m_attrib			= (uint32_t)reader.readULEB();
+			spec.m_form				= (uint32_t)reader.readULEB();
+			spec.m_implicitConst	= 0;
+
+			if (spec.m_form == DW_FORM_implicit_const)
+				spec.m_implicitConst = reader.readSLEB();
+
+			if (((spec.m_attrib == 0) && (spec.m_form == 0)) || reader.m_error)
+				break;
+
+			m_specs.push_back(spec);
+			++abbrev.m_numSpecs;
+		}
+
+		if (code != m_abbrevs.size() + 1)
+			m_dense = false;
+
+		m_abbrevs.push_back(abbrev);
+	}
+
+	return !reader.m_error;
+}
+
+const DwarfAbbrev* DwarfAbbrevTable::find(uint64_t _code) const
+{
+	if (m_dense)
+		return ((_code > 0) && (_code <= m_abbrevs.size())) ? &m_abbrevs[(size_t)_code - 1] : 0;
+
+	for (size_t i=0; i<m_abbrevs.size(); ++i)
+		if (m_abbrevs[i].m_code == _code)
+			return &m_abbrevs[i];
+	return 0;
+}
+
+bool DwarfValue::isString() const
+{
+	switch (m_form)
+	{
+	case DW_FORM_string:
+	case DW_FORM_strp:
+	case DW_FORM_line_strp:
+	case DW_FORM_strx:
+	case DW_FORM_strx1:
+	case DW_FORM_strx2:
+	case DW_FORM_strx3:
+	case DW_FORM_strx4:
+	case DW_FORM_GNU_str_index:
+		return true;
+	};
+	return false;
+}
+
+bool DwarfValue::isAddress() const
+{
+	switch (m_form)
+	{
+	case DW_FORM_addr:
+	case DW_FORM_addrx:
+	case DW_FORM_addrx1:
+	case DW_FORM_addrx2:
+	case DW_FORM_addrx3:
+	case DW_FORM_addrx4:
+	case DW_FORM_GNU_addr_index:
+		return true;
+	};
+	return false;
+}
+
+bool dwarfReadValue(DwarfReader& _reader, uint32_t _form, const DwarfUnit& _unit, DwarfValue& _value, int64_t _implicitConst)
+{
+	_value.m_form		= _form;
+	_value.m_value		= 0;
+	_value.m_block		= 0;
+	_value.m_blockSize	= 0;
+
+	uint64_t blockSize = 0;
+
+	switch (_form)
+	{
+	case DW_FORM_addr:				_value.m_value = _reader.readN(_unit.m_addressSize);	break;
+
+	case DW_FORM_flag:
+	case DW_FORM_ref1:
+	case DW_FORM_data1:
+	case DW_FORM_strx1:
+	case DW_FORM_addrx1:			_value.m_value = _reader.readU8();		break;
+
+	case DW_FORM_ref2:
+	case DW_FORM_data2:
+	case DW_FORM_strx2:
+	case DW_FORM_addrx2:			_value.m_value = _reader.readU16();		break;
+
+	case DW_FORM_strx3:
+	case DW_FORM_addrx3:			_value.m_value = _reader.readN(3);		break;
+
+	case DW_FORM_ref4:
+	case DW_FORM_data4:
+	case DW_FORM_ref_sup4:
+	case DW_FORM_strx4:
+	case DW_FORM_addrx4:			_value.m_value = _reader.readU32();		break;
+
+	case DW_FORM_ref8:
+	case DW_FORM_data8:
+	case DW_FORM_ref_sig8:
+	case DW_FORM_ref_sup8:			_value.m_value = _reader.readU64();		break;
+
+	case DW_FORM_data16:			_value.m_block = &_reader.m_data[_reader.m_pos];
+									_value.m_blockSize = 16;
+									_reader.skip(16);
+									break;
+
+	case DW_FORM_sdata:				_value.m_value = (uint64_t)_reader.readSLEB();	break;
+
+	case DW_FORM_udata:
+	case DW_FORM_ref_udata:
+	case DW_FORM_strx:
+	case DW_FORM_addrx:
+	case DW_FORM_loclistx:
+	case DW_FORM_rnglistx:
+	case DW_FORM_GNU_addr_index:
+	case DW_FORM_GNU_str_index:		_value.m_value = _reader.readULEB();	break;
+
+	case DW_FORM_strp:
+	case DW_FORM_line_strp:
+	case DW_FORM_sec_offset:
+	case DW_FORM_strp_sup:
+	case DW_FORM_GNU_ref_alt:
+	case DW_FORM_GNU_strp_alt:		_value.m_value = _reader.readOffset(_unit.m_is64);	break;
+
+	case DW_FORM_ref_addr:			if (_unit.m_version <= 2)
+										_value.m_value = _reader.readN(_unit.m_addressSize);
+									else
+										_value.m_value = _reader.readOffset(_unit.m_is64);
+									break;
+
+	case DW_FORM_string:			_value.m_block = &_reader.m_data[_reader.m_pos];
+									_reader.readString();
+									break;
+
+	case DW_FORM_flag_present:		_value.m_value = 1;	break;
+	case DW_FORM_implicit_const:	_value.m_value = (uint64_t)_implicitConst;	break;
+
+	case DW_FORM_block1:			blockSize = _reader.readU8();	goto readBlock;
+	case DW_FORM_block2:			blockSize = _reader.readU16();	goto readBlock;
+	case DW_FORM_block4:			blockSize = _reader.readU32();	goto readBlock;
+	case DW_FORM_block:
+	case DW_FORM_exprloc:			blockSize = _reader.readULEB();
+	readBlock:
+									_value.m_block = &_reader.m_data[_reader.m_pos < _reader.m_size ? _reader.m_pos : 0];
+									_value.m_blockSize = blockSize;
+									_reader.skip(blockSize);
+									break;
+
+	case DW_FORM_indirect:			return dwarfReadValue(_reader, (uint32_t)_reader.readULEB(), _unit, _value, _implicitConst);
+
+	default:
+		// unknown form, size unknown so the rest of the unit can't be parsed
+		_reader.m_error = true;
+		return false;
+	};
+
+	return !_reader.m_error;
+}
+
+const char* dwarfGetString(const DwarfSections& _sections, const DwarfUnit& _unit, const DwarfValue& _value)
+{
+	const DwarfSection* section = 0;
+	uint64_t offset = _value.m_value;
+
+	switch (_value.m_form)
+	{
+	case DW_FORM_string:
+		return (const char*)_value.m_block;
+
+	case DW_FORM_strp:
+		section = &_sections.m_str;
+		break;
+
+	case DW_FORM_line_strp:
+		section = &_sections.m_lineStr;
+		break;
+
+	case DW_FORM_strx:
+	case DW_FORM_strx1:
+	case DW_FORM_strx2:
+	case DW_FORM_strx3:
+	case DW_FORM_strx4:
+	case DW_FORM_GNU_str_index:
+		{
+			const uint64_t entrySize = _unit.m_is64 ? 8 : 4;
+			DwarfReader reader(_sections.m_strOffsets.m_data, _sections.m_strOffsets.m_size, _sections.m_bigEndian);
+			if (!reader.skip(_unit.m_strOffsetsBase + _value.m_value * entrySize))
+				return 0;
+			offset	= reader.readOffset(_unit.m_is64);
+			section	= &_sections.m_str;
+			if (reader.m_error)
+				return 0;
+		}
+		break;
+
+	default:
+		return 0;
+	};
+
+	if (!section->m_data || (offset >= section->m_size))
+		return 0;
+
+	return (const char*)&section->m_data[offset];
+}
+
+bool dwarfGetAddress(const DwarfSections& _sections, const DwarfUnit& _unit, const DwarfValue& _value, uint64_t& _address)
+{
+	if (_value.m_form == DW_FORM_addr)
+	{
+		_address = _value.m_value;
+		return true;
+	}
+
+	if (!_value.isAddress())
+		return false;
+
+	DwarfReader reader(_sections.m_addr.m_data, _sections.m_addr.m_size, _sections.m_bigEndian);
+	if (!reader.skip(_unit.m_addrBase + _value.m_value * _unit.m_addressSize))
+		return false;
+
+	_address = reader.readN(_unit.m_addressSize);
+	return !reader.m_error;
+}
+
+bool dwarfReadAttributes(DwarfReader& _reader, const DwarfUnit& _unit, const DwarfAbbrevTable& _abbrevs, const DwarfAbbrev& _abbrev, std::vector<DwarfValue>& _values)
+{
+	_values.resize(_abbrev.m_numSpecs);
+	for (uint32_t i=0; i<_abbrev.m_numSpecs; ++i)
+	{
+		const DwarfAttribSpec& spec = _abbrevs.m_specs[_abbrev.m_firstSpec + i];
+		if (!dwarfReadValue(_reader, spec.m_form, _unit, _values[i], spec.m_implicitConst))
+			return false;
+	}
+	return true;
+}
+
+const DwarfValue* dwarfFindAttribute(const DwarfAbbrevTable& _abbrevs, const DwarfAbbrev& _abbrev, const std::vector<DwarfValue>& _values, uint32_t _attrib)
+{
+	for (uint32_t i=0; i<_abbrev.m_numSpecs; ++i)
+		if (_abbrevs.m_specs[_abbrev.m_firstSpec + i].m_attrib == _attrib)
+			return &_values[i];
+	return 0;
+}
+
+const DwarfAbbrev* dwarfReadUnitDie(const DwarfSections& _sections, DwarfUnit& _unit, const DwarfAbbrevTable& _abbrevs, std::vector<DwarfValue>& _values)
+{
+	DwarfReader reader(_sections.m_info.m_data, _unit.m_end, _sections.m_bigEndian);
+	if (!reader.skip(_unit.m_dieOffset))
+		return 0;
+
+	const DwarfAbbrev* abbrev = _abbrevs.find(reader.readULEB());
+	if (!abbrev)
+		return 0;
+
+	if (!dwarfReadAttributes(reader, _unit, _abbrevs, *abbrev, _values))
+		return 0;
+
+	for (uint32_t i=0; i<abbrev->m_numSpecs; ++i)
+	{
+		switch (_abbrevs.m_specs[abbrev->m_firstSpec + i].m_attrib)
+		{
+		case DW_AT_str_offsets_base:	_unit.m_strOffsetsBase	= _values[i].m_value;	break;
+		case DW_AT_addr_base:
+		case DW_AT_GNU_addr_base:		_unit.m_addrBase		= _values[i].m_value;	break;
+		case DW_AT_rnglists_base:
+		case DW_AT_GNU_ranges_base:		_unit.m_rngListsBase	= _values[i].m_value;	break;
+		case DW_AT_GNU_dwo_id:			_unit.m_dwoId			= _values[i].m_value;	break;
+		};
+	}
+
+	// low pc can be an index into .debug_addr, resolve only once address base is known
+	const DwarfValue* lowPC = dwarfFindAttribute(_abbrevs, *abbrev, _values, DW_AT_low_pc);
+	if (lowPC)
+		dwarfGetAddress(_sections, _unit, *lowPC, _unit.m_baseAddress);
+
+	return abbrev;
+}
+
+enum
+{
+	DW_RLE_end_of_list		= 0x00,
+	DW_RLE_base_addressx	= 0x01,
+	DW_RLE_startx_endx		= 0x02,
+	DW_RLE_startx_length	= 0x03,
+	DW_RLE_offset_pair		= 0x04,
+	DW_RLE_base_address		= 0x05,
+	DW_RLE_start_end		= 0x06,
+	DW_RLE_start_length		= 0x07
+};
+
+static inline void addRange(std::vector<DwarfRange>& _ranges, uint64_t _low, uint64_t _high)
+{
+	if (_low < _high)
+	{
+		DwarfRange range;
+		range.m_low		= _low;
+		range.m_high	= _high;
+		_ranges.push_back(range);
+	}
+}
+
+/// Reads pre DWARF 5 range list from .debug_ranges
+static bool readRangesV4(const DwarfSections& _sections, const DwarfUnit& _unit, uint64_t _offset, std::vector<DwarfRange>& _ranges)
+{
+	DwarfReader reader(_sections.m_ranges.m_data, _sections.m_ranges.m_size, _sections.m_bigEndian);
+	if (!reader.skip(_offset))
+		return false;
+
+	const uint64_t maxAddress = (_unit.m_addressSize == 8) ? ~0ull : (1ull << (_unit.m_addressSize * 8)) - 1;
+	uint64_t base = _unit.m_baseAddress;
+
+	while (!reader.eof())
+	{
+		uint64_t begin	= reader.readN(_unit.m_addressSize);
+		uint64_t end	= reader.readN(_unit.m_addressSize);
+
+		if ((begin == 0) && (end == 0))
+			break;
+
+		if (begin == maxAddress)
+			base = end;
+		else
+			addRange(_ranges, base + begin, base + end);
+	}
+	return !reader.m_error;
+}
+
+/// Reads DWARF 5 range list from .debug_rnglists
+static bool readRangesV5(const DwarfSections& _sections, const DwarfUnit& _unit, uint64_t _offset, std::vector<DwarfRange>& _ranges)
+{
+	DwarfReader reader(_sections.m_rngLists.m_data, _sections.m_rngLists.m_size, _sections.m_bigEndian);
+	if (!reader.skip(_offset))
+		return false;
+
+	uint64_t base = _unit.m_baseAddress;
+
+	DwarfValue index;
+	index.m_form		= DW_FORM_addrx;
+	index.m_block		= 0;
+	index.m_blockSize	= 0;
+
+	while (!reader.eof())
+	{
+		uint8_t kind = reader.readU8();
+		uint64_t begin	= 0;
+		uint64_t end	= 0;
+
+		switch (kind)
+		{
+		case DW_RLE_end_of_list:
+			return true;
+
+		case DW_RLE_base_addressx:
+			index.m_value = reader.readULEB();
+			dwarfGetAddress(_sections, _unit, index, base);
+			break;
+
+		case DW_RLE_startx_endx:
+			index.m_value = reader.readULEB();
+			dwarfGetAddress(_sections, _unit, index, begin);
+			index.m_value = reader.readULEB();
+			dwarfGetAddress(_sections, _unit, index, end);
+			addRange(_ranges, begin, end);
+			break;
+
+		case DW_RLE_startx_length:
+			index.m_value = reader.readULEB();
+			dwarfGetAddress(_sections, _unit, index, begin);
+			addRange(_ranges, begin, begin + reader.readULEB());
+			break;
+
+		case DW_RLE_offset_pair:
+			begin	= reader.readULEB();
+			end		= reader.readULEB();
+			addRange(_ranges, base + begin, base + end);
+			break;
+
+		case DW_RLE_base_address:
+			base = reader.readN(_unit.m_addressSize);
+			break;
+
+		case DW_RLE_start_end:
+			begin	= reader.readN(_unit.m_addressSize);
+			end		= reader.readN(_unit.m_addressSize);
+			addRange(_ranges, begin, end);
+			break;
+
+		case DW_RLE_start_length:
+			begin	= reader.readN(_unit.m_addressSize);
+			addRange(_ranges, begin, begin + reader.readULEB());
+			break;
+
+		default:
+			return false;
+		};
+	}
+	return false;
+}
+
+bool dwarfGetRanges(const DwarfSections& _sections, const DwarfUnit& _unit, const DwarfAbbrevTable& _abbrevs, const DwarfAbbrev& _abbrev,
+					const std::vector<DwarfValue>& _values, std::vector<DwarfRange>& _ranges)
+{
+	const DwarfValue* ranges = dwarfFindAttribute(_abbrevs, _abbrev, _values, DW_AT_ranges);
+	if (ranges)
+	{
+		uint64_t offset = ranges->m_value;
+		if (_unit.m_version < 5)
+		{
+			// GNU split units store offsets relative to DW_AT_GNU_ranges_base of the skeleton
+			if (_unit.m_unitType == DW_UT_split_compile)
+				offset += _unit.m_rngListsBase;
+			return readRangesV4(_sections, _unit, offset, _ranges);
+		}
+
+		if (ranges->m_form == DW_FORM_rnglistx)
+		{
+			// index into offset table which follows the range lists header
+			DwarfReader reader(_sections.m_rngLists.m_data, _sections.m_rngLists.m_size, _sections.m_bigEndian);
+			if (!reader.skip(_unit.m_rngListsBase + offset * (_unit.m_is64 ? 8 : 4)))
+				return false;
+			offset = _unit.m_rngListsBase + reader.readOffset(_unit.m_is64);
+		}
+		return readRangesV5(_sections, _unit, offset, _ranges);
+	}
+
+	const DwarfValue* lowPC		= dwarfFindAttribute(_abbrevs, _abbrev, _values, DW_AT_low_pc);
+	const DwarfValue* highPC	= dwarfFindAttribute(_abbrevs, _abbrev, _values, DW_AT_high_pc);
+	if (!lowPC || !highPC)
+		return false;
+
+	uint64_t low;
+	if (!dwarfGetAddress(_sections, _unit, *lowPC, low))
+		return false;
+
+	uint64_t high;
+	if (highPC->isAddress())
+	{
+		if (!dwarfGetAddress(_sections, _unit, *highPC, high))
+			return false;
+	}
+	else
+		high = low + highPC->m_value;	// DWARF 4+, high pc is offset from low pc
+
+	addRange(_ranges, low, high);
+	return true;
+}
+
+} // namespace rdebug
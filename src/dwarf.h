@@ -0,0 +1,572 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_RDEBUG_DWARF_H
+#define RTM_RDEBUG_DWARF_H
+
+#include <rbase/inc/platform.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <string>
+
+namespace rdebug {
+
+class ElfFile;
+
+// DWARF constants, only the ones we need
+enum
+{
+	DW_TAG_lexical_block		= 0x0b,
+	DW_TAG_compile_unit			= 0x11,
+	DW_TAG_inlined_subroutine	= 0x1d,
+	DW_TAG_subprogram			= 0x2e,
+	DW_TAG_partial_unit			= 0x3c,
+	DW_TAG_skeleton_unit		= 0x4a,
+
+	DW_AT_name					= 0x03,
+	DW_AT_stmt_list				= 0x10,
+	DW_AT_low_pc				= 0x11,
+	DW_AT_high_pc				= 0x12,
+	DW_AT_comp_dir				= 0x1b,
+	DW_AT_abstract_origin		= 0x31,
+	DW_AT_declaration			= 0x3c,
+	DW_AT_specification			= 0x47,
+	DW_AT_entry_pc				= 0x52,
+	DW_AT_ranges				= 0x55,
+	DW_AT_call_file				= 0x58,
+	DW_AT_call_line				= 0x59,
+	DW_AT_linkage_name			= 0x6e,
+	DW_AT_str_offsets_base		= 0x72,
+	DW_AT_addr_base				= 0x73,
+	DW_AT_rnglists_base			= 0x74,
+	DW_AT_dwo_name				= 0x76,
+	DW_AT_MIPS_linkage_name		= 0x2007,
+	DW_AT_GNU_dwo_name			= 0x2130,
+	DW_AT_GNU_dwo_id			= 0x2131,
+	DW_AT_GNU_ranges_base		= 0x2132,
+	DW_AT_GNU_addr_base			= 0x2133,
+
+	DW_FORM_addr				= 0x01,
+	DW_FORM_block2				= 0x03,
+	DW_FORM_block4				= 0x04,
+	DW_FORM_data2				= 0x05,
+	DW_FORM_data4				= 0x06,
+	DW_FORM_data8				= 0x07,
+	DW_FORM_string				= 0x08,
+	DW_FORM_block				= 0x09,
+	DW_FORM_block1				= 0x0a,
+	DW_FORM_data1				= 0x0b,
+	DW_FORM_flag				= 0x0c,
+	DW_FORM_sdata				= 0x0d,
+	DW_FORM_strp				= 0x0e,
+	DW_FORM_udata				= 0x0f,
+	DW_FORM_ref_addr			= 0x10,
+	DW_FORM_ref1				= 0x11,
+	DW_FORM_ref2				= 0x12,
+	DW_FORM_ref4				= 0x13,
+	DW_FORM_ref8				= 0x14,
+	DW_FORM_ref_udata			= 0x15,
+	DW_FORM_indirect			= 0x16,
+	DW_FORM_sec_offset			= 0x17,
+	DW_FORM_exprloc				= 0x18,
+	DW_FORM_flag_present		= 0x19,
+	DW_FORM_strx				= 0x1a,
+	DW_FORM_addrx				= 0x1b,
+	DW_FORM_ref_sup4			= 0x1c,
+	DW_FORM_strp_sup			= 0x1d,
+	DW_FORM_data16				= 0x1e,
+	DW_FORM_line_strp			= 0x1f,
+	DW_FORM_ref_sig8			= 0x20,
+	DW_FORM_implicit_const		= 0x21,
+	DW_FORM_loclistx			= 0x22,
+	DW_FORM_rnglistx			= 0x23,
+	DW_FORM_ref_sup8			= 0x24,
+	DW_FORM_strx1				= 0x25,
+	DW_FORM_strx2				= 0x26,
+	DW_FORM_strx3				= 0x27,
+	DW_FORM_strx4				= 0x28,
+	DW_FORM_addrx1				= 0x29,
+	DW_FORM_addrx2				= 0x2a,
+	DW_FORM_addrx3				= 0x2b,
+	DW_FORM_addrx4				= 0x2c,
+	DW_FORM_GNU_addr_index		= 0x1f01,
+	DW_FORM_GNU_str_index		= 0x1f02,
+	DW_FORM_GNU_ref_alt			= 0x1f20,
+	DW_FORM_GNU_strp_alt		= 0x1f21,
+
+	DW_UT_compile				= 0x01,
+	DW_UT_type					= 0x02,
+	DW_UT_partial				= 0x03,
+	DW_UT_skeleton				= 0x04,
+	DW_UT_split_compile			= 0x05,
+	DW_UT_split_type			= 0x06,
+
+	// .debug_cu_index section identifiers, version 2 (GNU) ids differ from DWARF 5 above DW_SECT_STR_OFFSETS
+	DW_SECT_INFO				= 1,
+	DW_SECT_ABBREV				= 3,
+	DW_SECT_STR_OFFSETS			= 6,
+	DW_SECT_RNGLISTS			= 8
+};
+
+/// Raw bytes of a DWARF section
+struct DwarfSection
+{
+	const uint8_t*	m_data;
+	uint64_t		m_size;
+
+	DwarfSection() : m_data(0), m_size(0) {}
+};
+
+/// DWARF sections of a single image
+struct DwarfSections
+{
+	DwarfSection	m_info;
+	DwarfSection	m_abbrev;
+	DwarfSection	m_line;
+	DwarfSection	m_str;
+	DwarfSection	m_lineStr;
+	DwarfSection	m_strOffsets;
+	DwarfSection	m_addr;
+	DwarfSection	m_ranges;
+	DwarfSection	m_rngLists;
+	DwarfSection	m_aranges;
+	bool			m_bigEndian;
+
+	DwarfSections() : m_bigEndian(false) {}
+
+	void init(const ElfFile& _elf);
+	/// Sections of a split DWARF object (.dwo or .dwp), addresses and line programs stay in the skeleton image
+	void initSplit(const ElfFile& _dwo, const DwarfSections& _skeleton);
+};
+
+/// Bounds checked cursor over DWARF data, any read past the end yields zero and sets the error flag
+struct DwarfReader
+{
+	const uint8_t*	m_data;
+	uint64_t		m_size;
+	uint64_t		m_pos;
+	bool			m_bigEndian;
+	bool			m_error;
+
+	DwarfReader(const uint8_t* _data, uint64_t _size, bool _bigEndian)
+		: m_data(_data)
+		, m_size(_size)
+		, m_pos(0)
+		, m_bigEndian(_bigEndian)
+		, m_error(false)
+	{}
+
+	inline bool eof() const { return m_error || (m_pos >= m_size); }
+	inline uint64_t left() const { return m_pos < m_size ? m_size - m_pos : 0; }
+
+	inline bool skip(uint64_t _bytes)
+	{
+		if (_bytes > left())
+		{
+			m_error = true;
+			m_pos = m_size;
+			return false;
+		}
+		m_pos += _bytes;
+		return true;
+	}
+
+	inline uint64_t readN(uint32_t _bytes)
+	{
+		if (_bytes > left())
+		{
+			m_error = true;
+			m_pos = m_size;
+			return 0;
+		}
+		const uint8_t* p = &m_data[m_pos];
+		m_pos += _bytes;
+
+		uint64_t value = 0;
+		if (m_bigEndian)
+			for (uint32_t i=0; i<_bytes; ++i)
+				value = (value << 8) | p[i];
+		else
+			for (uint32_t i=_bytes; i>0; --i)
+				value = (value << 8) | p[i-1];
+		return value;
+	}
+
+	inline uint8_t  readU8()	{ return (uint8_t)readN(1); }
+	inline uint16_t readU16()	{ return (uint16_t)readN(2); }
+	inline uint32_t readU32()	{ return (uint32_t)readN(4); }
+	inline uint64_t readU64()	{ return readN(8); }
+
+	inline uint64_t readULEB()
+	{
+		uint64_t value = 0;
+		uint32_t shift = 0;
+		while (m_pos < m_size)
+		{
+			uint8_t b = m_data[m_pos++];
+			if (shift < 64)
+				value |= (uint64_t)(b & 0x7f) << shift;
+			shift += 7;
+			if (!(b & 0x80))
+				return value;
+		}
+		m_error = true;
+		return value;
+	}
+
+	inline int64_t readSLEB()
+	{
+		int64_t value = 0;
+		uint32_t shift = 0;
+		while (m_pos < m_size)
+		{
+			uint8_t b = m_data[m_pos++];
+			if (shift < 64)
+				value |= (int64_t)((uint64_t)(b & 0x7f) << shift);
+			shift += 7;
+			if (!(b & 0x80))
+			{
+				if ((shift < 64) && (b & 0x40))
+					value |= (int64_t)(~0ull << shift);
+				return value;
+			}
+		}
+		m_error = true;
+		return value;
+	}
+
+	inline const char* readString()
+	{
+		const char* str = (const char*)&m_data[m_pos];
+		while (m_pos < m_size)
+			if (m_data[m_pos++] == 0)
+				return str;
+		m_error = true;
+		return "";
+	}
+
+	/// Reads unit length, returns false on malformed data, _is64 is set for 64bit DWARF
+	inline bool readLength(uint64_t& _length, bool& _is64)
+	{
+		_length = readU32();
+		_is64 = false;
+		if (_length == 0xffffffff)
+		{
+			_length = readU64();
+			_is64 = true;
+		}
+		else
+			if (_length >= 0xfffffff0)
+				m_error = true;
+
+		return !m_error && (_length <= left());
+	}
+
+	inline uint64_t readOffset(bool _is64) { return _is64 ? readU64() : readU32(); }
+};
+
+/// Unit header of a compilation unit and the bases needed to decode its attributes
+struct DwarfUnit
+{
+	uint64_t	m_offset;			// offset of unit header
+	uint64_t	m_dieOffset;		// offset of the first DIE
+	uint64_t	m_end;				// offset of the next unit
+	uint64_t	m_abbrevOffset;
+	uint64_t	m_strOffsetsBase;
+	uint64_t	m_addrBase;
+	uint64_t	m_rngListsBase;
+	uint64_t	m_baseAddress;		// DW_AT_low_pc of the unit DIE, base for range lists
+	uint64_t	m_dwoId;
+	uint16_t	m_version;
+	uint8_t		m_unitType;
+	uint8_t		m_addressSize;
+	bool		m_is64;
+
+	DwarfUnit();
+
+	/// Parses unit header at given offset in .debug_info
+	bool parseHeader(const DwarfSections& _sections, uint64_t _offset);
+};
+
+/// Single abbreviation declaration
+struct DwarfAbbrev
+{
+	uint32_t	m_code;
+	uint32_t	m_tag;
+	uint32_t	m_firstSpec;
+	uint32_t	m_numSpecs;
+	bool		m_hasChildren;
+};
+
+/// Attribute specification of an abbreviation
+struct DwarfAttribSpec
+{
+	uint32_t	m_attrib;
+	uint32_t	m_form;
+	int64_t		m_implicitConst;
+};
+
+/// Abbreviation table, indexed directly by code when codes are dense (the usual case)
+struct DwarfAbbrevTable
+{
+	std::vector<DwarfAbbrev>		m_abbrevs;
+	std::vector<DwarfAttribSpec>	m_specs;
+	bool							m_dense;
+
+	DwarfAbbrevTable() : m_dense(true) {}
+
+	bool				parse(const DwarfSections& _sections, uint64_t _offset);
+	const DwarfAbbrev*	find(uint64_t _code) const;
+};
+
+/// Decoded attribute value
+struct DwarfValue
+{
+	uint32_t		m_form;
+	uint64_t		m_value;		// constant, offset, reference (unit relative) or index
+	const uint8_t*	m_block;		// block/exprloc data or inline string
+	uint64_t		m_blockSize;
+
+	bool isString() const;
+	bool isAddress() const;
+};
+
+/// Reads attribute of a given form, DW_FORM_indirect is resolved
+bool dwarfReadValue(DwarfReader& _reader, uint32_t _form, const DwarfUnit& _unit, DwarfValue& _value, int64_t _implicitConst = 0);
+
+/// Resolves string forms (inline, strp, line_strp, strx*), returns 0 for non string forms
+const char* dwarfGetString(const DwarfSections& _sections, const DwarfUnit& _unit, const DwarfValue& _value);
+
+/// Resolves address forms (addr, addrx*), returns false for non address forms
+bool dwarfGetAddress(const DwarfSections& _sections, const DwarfUnit& _unit, const DwarfValue& _value, uint64_t& _address);
+
+/// Reads all attributes of a DIE, _values is resized to the number of attributes in abbreviation
+bool dwarfReadAttributes(DwarfReader& _reader, const DwarfUnit& _unit, const DwarfAbbrevTable& _abbrevs, const DwarfAbbrev& _abbrev, std::vector<DwarfValue>& _values);
+
+/// Returns value of the given attribute of a DIE read with dwarfReadAttributes or 0 if not present
+const DwarfValue* dwarfFindAttribute(const DwarfAbbrevTable& _abbrevs, const DwarfAbbrev& _abbrev, const std::vector<DwarfValue>& _values, uint32_t _attrib);
+
+/// Reads the unit DIE and sets string offsets, address and range list bases of the unit
+const DwarfAbbrev* dwarfReadUnitDie(const DwarfSections& _sections, DwarfUnit& _unit, const DwarfAbbrevTable& _abbrevs, std::vector<DwarfValue>& _values);
+
+/// Half open address range
+struct DwarfRange
+{
+	uint64_t	m_low;
+	uint64_t	m_high;
+};
+
+/// Appends address ranges of a DIE, from either DW_AT_low_pc/DW_AT_high_pc pair or DW_AT_ranges
+bool dwarfGetRanges(const DwarfSections& _sections, const DwarfUnit& _unit, const DwarfAbbrevTable& _abbrevs, const DwarfAbbrev& _abbrev,
+					const std::vector<DwarfValue>& _values, std::vector<DwarfRange>& _ranges);
+
+/// Reads file table of the line program at given offset, DW_AT_call_file and DW_AT_decl_file values index into it
+bool dwarfReadLineFiles(const DwarfSections& _sections, uint64_t _offset, const DwarfUnit& _cu, const char* _compDir, std::vector<std::string>& _paths);
+
+/// Address to source file and line lookup table, built from all line programs in .debug_line
+class DwarfLineTable
+{
+	public:
+		struct Row
+		{
+			uint64_t	m_address;
+			uint32_t	m_file;			// index into file table, InvalidFile for end of sequence
+			uint32_t	m_line;
+		};
+
+		static const uint32_t InvalidFile = 0xffffffff;
+
+		/// Sorted lookup tables, either owned by the vectors below or mapped from a symbol cache file
+		struct Tables
+		{
+			const Row*		m_rows;
+			const uint32_t*	m_fileOffsets;
+			const char*		m_filePaths;
+			uint32_t		m_numRows;
+			uint32_t		m_numFiles;
+			uint32_t		m_filePathsSize;
+		};
+
+	private:
+		Tables					m_tables;
+		std::vector<Row>		m_rows;
+		std::vector<uint32_t>	m_fileOffsets;
+		std::vector<char>		m_filePaths;
+
+	public:
+		DwarfLineTable();
+
+		bool		build(const ElfFile& _elf);
+		/// Builds the table from the line program of a single compilation unit
+		bool		build(const DwarfSections& _sections, const DwarfUnit& _unit, uint64_t _stmtList, const char* _compDir);
+		/// Serves lookups from tables owned by someone else, they have to outlive the line table
+		void		attach(const Tables& _tables);
+		const Tables& getTables() const { return m_tables; }
+		bool		findLine(uint64_t _address, const char*& _file, uint32_t& _line) const;
+		/// Same as above for a sweep over ascending addresses, _cursor starts at 0 and carries the previous hit
+		bool		findLine(uint64_t _address, const char*& _file, uint32_t& _line, uint32_t& _cursor) const;
+		bool		empty() const { return m_tables.m_numRows == 0; }
+		uint64_t	getMemorySize() const;
+
+	private:
+		bool		finish();
+		bool		getLine(const Row& _row, const char*& _file, uint32_t& _line) const;
+};
+
+class DwarfUnitIndex;
+
+/// Skeleton unit of a split unit, DW_AT_call_file of split unit DIEs indexes into its line program
+struct DwarfSkeleton
+{
+	const DwarfSections*	m_sections;
+	DwarfUnit				m_unit;
+	uint64_t				m_stmtList;
+	const char*				m_compDir;
+};
+
+/// Index of a DWARF package file (.dwp), maps DWO IDs of split units to their section contributions
+class DwarfPackage
+{
+		DwarfSections	m_sections;		// whole sections of the package
+		DwarfSection	m_index;		// .debug_cu_index
+		uint32_t		m_version;
+		uint32_t		m_numColumns;
+		uint32_t		m_numUnits;
+		uint32_t		m_numSlots;
+
+	public:
+		DwarfPackage();
+
+		bool		load(const ElfFile& _dwp, const DwarfSections& _skeleton);
+		/// Sets sections to contributions of the unit with the given DWO ID, the unit is at offset 0 of .debug_info.dwo
+		bool		findUnit(uint64_t _dwoId, DwarfSections& _sections) const;
+};
+
+/// Address to inlined call chain lookup table of a compilation unit, built from DW_TAG_subprogram and
+/// DW_TAG_inlined_subroutine DIEs. DIE ranges are flattened to disjoint segments, each mapping to the
+/// innermost scope covering it.
+class DwarfInlineIndex
+{
+	public:
+		struct Node
+		{
+			uint32_t	m_name;			// offset into string pool, InvalidString if unknown
+			uint32_t	m_callFile;		// offset into string pool, InvalidString if unknown
+			uint32_t	m_callLine;
+			uint32_t	m_parent;		// enclosing scope, InvalidNode for a subprogram
+		};
+
+		struct Segment
+		{
+			uint64_t	m_address;
+			uint32_t	m_node;			// InvalidNode for a gap
+		};
+
+		static const uint32_t InvalidNode	= 0xffffffff;
+		static const uint32_t InvalidString	= 0xffffffff;
+
+	private:
+		std::vector<Node>		m_nodes;
+		std::vector<Segment>	m_segments;
+		std::vector<char>		m_strings;
+
+	public:
+		/// Names referenced from other units are followed, only scopes of the given unit are indexed.
+		/// Split units pass their skeleton, file names of call sites come from its line program.
+		bool		build(const DwarfSections& _sections, const std::vector<DwarfUnit>& _units, uint32_t _unit, const DwarfSkeleton* _skeleton = 0);
+		uint32_t	findNode(uint64_t _address) const;
+		/// Same as above for a sweep over ascending addresses, _cursor starts at 0 and carries the previous hit
+		uint32_t	findNode(uint64_t _address, uint32_t& _cursor) const;
+		const Node&	getNode(uint32_t _index) const { return m_nodes[_index]; }
+		const char*	getString(uint32_t _offset) const { return _offset == InvalidString ? 0 : &m_strings[_offset]; }
+		bool		empty() const { return m_segments.empty(); }
+		uint64_t	getMemorySize() const;
+};
+
+/// Address to compilation unit index of an image, from .debug_aranges or, for units it doesn't cover, from
+/// DW_AT_ranges/DW_AT_low_pc of the unit DIE. Only units hit by lookups get their line program and scope
+/// DIEs decoded, once they exceed the memory budget a clock sweep drops units that weren't used since its last pass.
+/// Scopes of skeleton units (-gsplit-dwarf) are read from the image's .dwp package or from the unit's .dwo file.
+class DwarfUnitIndex
+{
+	public:
+		/// Line and inline tables of a single unit, held by lookups so eviction never pulls them away
+		struct Decoded
+		{
+			DwarfLineTable		m_lines;
+			DwarfInlineIndex	m_inlines;
+			uint64_t			m_memorySize;
+		};
+
+		typedef std::shared_ptr<const Decoded> DecodedPtr;
+
+		static const uint32_t InvalidUnit = 0xffffffff;
+
+	private:
+		struct Range
+		{
+			uint64_t	m_low;
+			uint64_t	m_high;
+			uint32_t	m_unit;
+		};
+
+		struct Entry
+		{
+			DecodedPtr				m_decoded;		// published with std::atomic_store, hits don't take the lock
+			std::atomic<uint64_t>	m_lastUsed;		// clock tick of the last hit
+			uint64_t				m_visited;		// clock tick of the last pass of the hand, under the lock
+
+			Entry() : m_lastUsed(0), m_visited(0) {}
+		};
+
+		DwarfSections			m_sections;
+		std::vector<DwarfUnit>	m_units;		// headers of all units, in .debug_info order
+		std::vector<Range>		m_ranges;		// sorted and disjoint
+		uint64_t				m_memoryBudget;
+		std::string				m_imagePath;
+
+		// .dwp next to the image, opened when the first skeleton unit is decoded
+		mutable std::mutex		m_packageLock;
+		mutable bool			m_packageLoaded;
+		mutable ElfFile*		m_packageFile;
+		mutable DwarfPackage	m_package;
+
+		std::mutex				m_lock;			// taken to insert and evict units only
+		std::vector<Entry>		m_entries;		// per unit
+		std::vector<uint32_t>	m_resident;		// decoded units, in no particular order
+		uint32_t				m_hand;			// next resident unit the clock sweep looks at
+		std::atomic<uint64_t>	m_clock;		// advanced after every insert
+		uint64_t				m_memoryUsed;
+
+	public:
+		DwarfUnitIndex();
+		~DwarfUnitIndex();
+
+		/// Image has to outlive the index, its path is where split DWARF files are looked for
+		bool		build(const ElfFile& _elf, const char* _imagePath, uint64_t _memoryBudget);
+		uint32_t	findUnit(uint64_t _address) const;
+		/// Decodes the unit on first use, concurrent callers may decode it twice but only one copy is kept.
+		/// Units already decoded are returned without locking.
+		DecodedPtr	getUnit(uint32_t _unit);
+		bool		empty() const { return m_ranges.empty(); }
+
+		const DwarfSections&			getSections() const { return m_sections; }
+		const std::vector<DwarfUnit>&	getUnits() const { return m_units; }
+
+	private:
+		static bool	sortRanges(const Range& _r1, const Range& _r2) { return _r1.m_low < _r2.m_low; }
+		static bool	compareRange(uint64_t _address, const Range& _range) { return _address < _range.m_low; }
+
+		void		readAranges(std::vector<uint8_t>& _covered);
+		void		decode(uint32_t _unit, Decoded& _decoded) const;
+		const DwarfPackage* getPackage() const;
+		bool		decodeSplit(const DwarfSkeleton& _skeleton, const char* _dwoName, DwarfInlineIndex& _inlines) const;
+};
+
+} // namespace rdebug
+
+#endif // RTM_RDEBUG_DWARF_H
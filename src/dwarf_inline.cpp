@@ -0,0 +1,461 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <rdebug_pch.h>
+#include <rdebug/src/dwarf.h>
+#include <rdebug/src/elf_file.h>
+
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+
+namespace rdebug {
+
+/// Maximum number of abstract_origin/specification links followed to find a name
+static const uint32_t s_maxNameDepth = 8;
+
+/// Compilation unit along with its abbreviations and lazily read file table
+struct InlineUnit
+{
+	DwarfUnit				m_unit;
+	const DwarfAbbrevTable*	m_abbrevs;		// 0 if the unit couldn't be read
+	uint64_t				m_stmtList;
+	const char*				m_compDir;
+	const DwarfSkeleton*	m_skeleton;		// set for split units, their file table is the skeleton's one
+	bool					m_filesRead;
+	std::vector<uint32_t>	m_files;		// string pool offsets of line program file entries
+};
+
+/// Address range of a scope DIE
+struct InlineRange
+{
+	uint64_t	m_low;
+	uint64_t	m_high;
+	uint32_t	m_node;
+	uint32_t	m_depth;
+};
+
+static inline bool sortInlineRanges(const InlineRange& _r1, const InlineRange& _r2)
+{
+	if (_r1.m_low != _r2.m_low)		return _r1.m_low < _r2.m_low;
+	if (_r1.m_high != _r2.m_high)	return _r1.m_high > _r2.m_high;	// enclosing scope first
+	return _r1.m_depth < _r2.m_depth;
+}
+
+static inline bool compareUnitOffset(uint64_t _offset, const DwarfUnit& _unit)
+{
+	return _offset < _unit.m_offset;
+}
+
+static inline bool compareSegment(uint64_t _address, const DwarfInlineIndex::Segment& _segment)
+{
+	return _address < _segment.m_address;
+}
+
+/// Collects scope DIEs of a compilation unit and resolves their names and call sites, units referenced
+/// by name lookups are read as they are reached
+struct InlineIndexBuilder
+{
+	const DwarfSections&						m_sections;
+	const std::vector<DwarfUnit>&				m_headers;
+	std::vector<DwarfInlineIndex::Node>&		m_nodes;
+	std::vector<char>&							m_strings;
+	std::unordered_map<uint32_t, InlineUnit>	m_units;		// index into headers to unit read so far
+	std::deque<DwarfAbbrevTable>				m_abbrevTables;	// deque, references stay valid as tables are added
+	std::unordered_map<uint64_t, uint32_t>		m_abbrevIndex;	// abbreviation table offset to index
+	std::vector<InlineRange>					m_ranges;
+	std::unordered_map<uint64_t, uint32_t>		m_dieNames;		// DIE offset to string pool offset
+	std::unordered_map<std::string, uint32_t>	m_interned;
+	std::string									m_scratch;
+
+	InlineIndexBuilder(const DwarfSections& _sections, const std::vector<DwarfUnit>& _headers, std::vector<DwarfInlineIndex::Node>& _nodes, std::vector<char>& _strings)
+		: m_sections(_sections)
+		, m_headers(_headers)
+		, m_nodes(_nodes)
+		, m_strings(_strings)
+	{}
+
+	uint32_t intern(const char* _string)
+	{
+		if (!_string || (_string[0] == '\0'))
+			return DwarfInlineIndex::InvalidString;
+
+		m_scratch = _string;
+		std::unordered_map<std::string, uint32_t>::iterator it = m_interned.find(m_scratch);
+		if (it != m_interned.end())
+			return it->second;
+
+		uint32_t offset = (uint32_t)m_strings.size();
+		m_strings.insert(m_strings.end(), m_scratch.c_str(), m_scratch.c_str() + m_scratch.size() + 1);
+		m_interned[m_scratch] = offset;
+		return offset;
+	}
+
+	/// Reads abbreviations and unit DIE of a unit on first use, returns 0 if it's malformed
+	InlineUnit* getUnit(uint32_t _index)
+	{
+		std::unordered_map<uint32_t, InlineUnit>::iterator it = m_units.find(_index);
+		if (it != m_units.end())
+			return it->second.m_abbrevs ? &it->second : 0;
+
+		InlineUnit& unit = m_units[_index];
+		unit.m_unit			= m_headers[_index];
+		unit.m_abbrevs		= 0;
+		unit.m_stmtList		= ~0ull;
+		unit.m_compDir		= "";
+		unit.m_skeleton		= 0;
+		unit.m_filesRead	= false;
+
+		const DwarfAbbrevTable* abbrevs;
+		std::unordered_map<uint64_t, uint32_t>::iterator abbrevIt = m_abbrevIndex.find(unit.m_unit.m_abbrevOffset);
+		if (abbrevIt != m_abbrevIndex.end())
+			abbrevs = &m_abbrevTables[abbrevIt->second];
+		else
+		{
+			m_abbrevTables.push_back(DwarfAbbrevTable());
+			if (!m_abbrevTables.back().parse(m_sections, unit.m_unit.m_abbrevOffset))
+			{
+				m_abbrevTables.pop_back();
+				return 0;
+			}
+			m_abbrevIndex[unit.m_unit.m_abbrevOffset] = (uint32_t)m_abbrevTables.size() - 1;
+			abbrevs = &m_abbrevTables.back();
+		}
+
+		std::vector<DwarfValue> values;
+		const DwarfAbbrev* abbrev = dwarfReadUnitDie(m_sections, unit.m_unit, *abbrevs, values);
+		if (!abbrev)
+			return 0;
+
+		const DwarfValue* stmtList	= dwarfFindAttribute(*abbrevs, *abbrev, values, DW_AT_stmt_list);
+		const DwarfValue* compDir	= dwarfFindAttribute(*abbrevs, *abbrev, values, DW_AT_comp_dir);
+		if (stmtList)
+			unit.m_stmtList = stmtList->m_value;
+		if (compDir)
+		{
+			const char* dir = dwarfGetString(m_sections, unit.m_unit, *compDir);
+			unit.m_compDir = dir ? dir : "";
+		}
+
+		unit.m_abbrevs = abbrevs;
+		return &unit;
+	}
+
+	uint32_t getFile(InlineUnit& _unit, uint64_t _file)
+	{
+		if (!_unit.m_filesRead)
+		{
+			_unit.m_filesRead = true;
+
+			const DwarfSkeleton* skeleton = _unit.m_skeleton;
+
+			std::vector<std::string> paths;
+			bool read;
+			if (skeleton)
+				read = (skeleton->m_stmtList != ~0ull) && dwarfReadLineFiles(*skeleton->m_sections, skeleton->m_stmtList, skeleton->m_unit, skeleton->m_compDir, paths);
+			else
+				read = (_unit.m_stmtList != ~0ull) && dwarfReadLineFiles(m_sections, _unit.m_stmtList, _unit.m_unit, _unit.m_compDir, paths);
+
+			if (read)
+			{
+				_unit.m_files.resize(paths.size());
+				for (size_t i=0; i<paths.size(); ++i)
+					_unit.m_files[i] = intern(paths[i].c_str());
+			}
+		}
+
+		return _file < _unit.m_files.size() ? _unit.m_files[(size_t)_file] : DwarfInlineIndex::InvalidString;
+	}
+
+	/// Returns absolute .debug_info offset of a DIE reference
+	static bool getReference(const InlineUnit& _unit, const DwarfValue& _value, uint64_t& _offset)
+	{
+		switch (_value.m_form)
+		{
+		case DW_FORM_ref1:
+		case DW_FORM_ref2:
+		case DW_FORM_ref4:
+		case DW_FORM_ref8:
+		case DW_FORM_ref_udata:	_offset = _unit.m_unit.m_offset + _value.m_value;	return true;
+		case DW_FORM_ref_addr:	_offset = _value.m_value;							return true;
+		};
+		return false;	// type units and supplementary files are not followed
+	}
+
+	/// Name of a DIE, linkage name is preferred so that names are demangled the same way as symbols
+	uint32_t getName(const InlineUnit& _unit, const DwarfAbbrev& _abbrev, const std::vector<DwarfValue>& _values, uint32_t _depth)
+	{
+		const DwarfAbbrevTable& abbrevs = *_unit.m_abbrevs;
+
+		const DwarfValue* linkageName = dwarfFindAttribute(abbrevs, _abbrev, _values, DW_AT_linkage_name);
+		if (!linkageName)
+			linkageName = dwarfFindAttribute(abbrevs, _abbrev, _values, DW_AT_MIPS_linkage_name);
+		if (linkageName)
+			return intern(dwarfGetString(m_sections, _unit.m_unit, *linkageName));
+
+		const DwarfValue* origin = dwarfFindAttribute(abbrevs, _abbrev, _values, DW_AT_abstract_origin);
+		if (!origin)
+			origin = dwarfFindAttribute(abbrevs, _abbrev, _values, DW_AT_specification);
+
+		uint64_t offset;
+		if (origin && (_depth < s_maxNameDepth) && getReference(_unit, *origin, offset))
+		{
+			uint32_t name = getNameAt(offset, _depth + 1);
+			if (name != DwarfInlineIndex::InvalidString)
+				return name;
+		}
+
+		const DwarfValue* name = dwarfFindAttribute(abbrevs, _abbrev, _values, DW_AT_name);
+		return name ? intern(dwarfGetString(m_sections, _unit.m_unit, *name)) : DwarfInlineIndex::InvalidString;
+	}
+
+	uint32_t getNameAt(uint64_t _offset, uint32_t _depth)
+	{
+		std::unordered_map<uint64_t, uint32_t>::iterator it = m_dieNames.find(_offset);
+		if (it != m_dieNames.end())
+			return it->second;
+
+		uint32_t name = DwarfInlineIndex::InvalidString;
+
+		std::vector<DwarfUnit>::const_iterator header = std::upper_bound(m_headers.begin(), m_headers.end(), _offset, compareUnitOffset);
+		if (header != m_headers.begin())
+		{
+			--header;
+			const InlineUnit* unit = _offset < header->m_end ? getUnit((uint32_t)(header - m_headers.begin())) : 0;
+			if (unit)
+			{
+				DwarfReader reader(m_sections.m_info.m_data, unit->m_unit.m_end, m_sections.m_bigEndian);
+				reader.skip(_offset);
+
+				std::vector<DwarfValue> values;
+				const DwarfAbbrevTable& abbrevs = *unit->m_abbrevs;
+				const DwarfAbbrev* abbrev = abbrevs.find(reader.readULEB());
+				if (abbrev && dwarfReadAttributes(reader, unit->m_unit, abbrevs, *abbrev, values))
+					name = getName(*unit, *abbrev, values, _depth);
+			}
+		}
+
+		m_dieNames[_offset] = name;
+		return name;
+	}
+
+	void readScopes(InlineUnit& _unit)
+	{
+		if ((_unit.m_unit.m_unitType != DW_UT_compile) && (_unit.m_unit.m_unitType != DW_UT_partial) && (_unit.m_unit.m_unitType != DW_UT_split_compile))
+			return;
+
+		const DwarfAbbrevTable& abbrevs = *_unit.m_abbrevs;
+
+		DwarfReader reader(m_sections.m_info.m_data, _unit.m_unit.m_end, m_sections.m_bigEndian);
+		if (!reader.skip(_unit.m_unit.m_dieOffset))
+			return;
+
+		struct Scope
+		{
+			uint32_t	m_node;
+			uint32_t	m_depth;		// depth of children of the scope
+		};
+
+		std::vector<Scope>		scopes;
+		std::vector<DwarfValue>	values;
+		std::vector<DwarfRange>	ranges;
+		uint32_t				depth = 0;
+
+		while (!reader.eof())
+		{
+			uint64_t dieOffset = reader.m_pos;
+			uint64_t code = reader.readULEB();
+			if (code == 0)
+			{
+				if (depth == 0)
+					break;
+				--depth;
+				while (!scopes.empty() && (scopes.back().m_depth > depth))
+					scopes.pop_back();
+				continue;
+			}
+
+			const DwarfAbbrev* abbrev = abbrevs.find(code);
+			if (!abbrev || !dwarfReadAttributes(reader, _unit.m_unit, abbrevs, *abbrev, values))
+				break;
+
+			if ((abbrev->m_tag == DW_TAG_subprogram) || (abbrev->m_tag == DW_TAG_inlined_subroutine))
+			{
+				ranges.clear();
+				dwarfGetRanges(m_sections, _unit.m_unit, abbrevs, *abbrev, values, ranges);
+
+				if (!ranges.empty())
+				{
+					const bool inlined = abbrev->m_tag == DW_TAG_inlined_subroutine;
+
+					DwarfInlineIndex::Node node;
+					node.m_name		= getName(_unit, *abbrev, values, 0);
+					node.m_callFile	= DwarfInlineIndex::InvalidString;
+					node.m_callLine	= 0;
+					node.m_parent	= (inlined && !scopes.empty()) ? scopes.back().m_node : DwarfInlineIndex::InvalidNode;
+
+					if (inlined)
+					{
+						const DwarfValue* callFile = dwarfFindAttribute(abbrevs, *abbrev, values, DW_AT_call_file);
+						const DwarfValue* callLine = dwarfFindAttribute(abbrevs, *abbrev, values, DW_AT_call_line);
+						if (callFile)
+							node.m_callFile = getFile(_unit, callFile->m_value);
+						if (callLine)
+							node.m_callLine = (uint32_t)callLine->m_value;
+					}
+
+					uint32_t nodeIndex = (uint32_t)m_nodes.size();
+					m_nodes.push_back(node);
+					m_dieNames[dieOffset] = node.m_name;
+
+					for (size_t i=0; i<ranges.size(); ++i)
+					{
+						// discarded code (garbage collected sections) is relocated to zero
+						if (ranges[i].m_low == 0)
+							continue;
+
+						InlineRange range;
+						range.m_low		= ranges[i].m_low;
+						range.m_high	= ranges[i].m_high;
+						range.m_node	= nodeIndex;
+						range.m_depth	= depth;
+						m_ranges.push_back(range);
+					}
+
+					if (abbrev->m_hasChildren)
+					{
+						Scope scope;
+						scope.m_node	= nodeIndex;
+						scope.m_depth	= depth + 1;
+						scopes.push_back(scope);
+					}
+				}
+			}
+
+			if (abbrev->m_hasChildren)
+				++depth;
+		}
+	}
+};
+
+static inline void addSegment(std::vector<DwarfInlineIndex::Segment>& _segments, uint64_t _address, uint32_t _node)
+{
+	if (!_segments.empty())
+	{
+		DwarfInlineIndex::Segment& last = _segments.back();
+		if (_address < last.m_address)
+			return;
+
+		if (_address == last.m_address)
+		{
+			last.m_node = _node;
+			if ((_segments.size() > 1) && (_segments[_segments.size() - 2].m_node == _node))
+				_segments.pop_back();
+			return;
+		}
+
+		if (last.m_node == _node)
+			return;
+	}
+
+	DwarfInlineIndex::Segment segment;
+	segment.m_address	= _address;
+	segment.m_node		= _node;
+	_segments.push_back(segment);
+}
+
+bool DwarfInlineIndex::build(const DwarfSections& _sections, const std::vector<DwarfUnit>& _units, uint32_t _unit, const DwarfSkeleton* _skeleton)
+{
+	m_nodes.clear();
+	m_segments.clear();
+	m_strings.clear();
+
+	if (!_sections.m_info.m_data || !_sections.m_abbrev.m_data || (_unit >= _units.size()))
+		return false;
+
+	InlineIndexBuilder builder(_sections, _units, m_nodes, m_strings);
+	InlineUnit* unit = builder.getUnit(_unit);
+	if (!unit)
+		return false;
+
+	unit->m_skeleton = _skeleton;
+	builder.readScopes(*unit);
+
+	std::vector<InlineRange>& ranges = builder.m_ranges;
+	std::sort(ranges.begin(), ranges.end(), sortInlineRanges);
+
+	// sweep over sorted ranges, segment boundaries are where the innermost active scope changes
+	std::vector<InlineRange> active;
+	for (size_t i=0; i<ranges.size(); ++i)
+	{
+		InlineRange range = ranges[i];
+
+		while (!active.empty() && (active.back().m_high <= range.m_low))
+		{
+			uint64_t end = active.back().m_high;
+			active.pop_back();
+			addSegment(m_segments, end, active.empty() ? InvalidNode : active.back().m_node);
+		}
+
+		// malformed overlaps are clipped to the enclosing scope to keep the stack properly nested
+		if (!active.empty() && (range.m_high > active.back().m_high))
+			range.m_high = active.back().m_high;
+
+		active.push_back(range);
+		addSegment(m_segments, range.m_low, range.m_node);
+	}
+
+	while (!active.empty())
+	{
+		uint64_t end = active.back().m_high;
+		active.pop_back();
+		addSegment(m_segments, end, active.empty() ? InvalidNode : active.back().m_node);
+	}
+
+	std::vector<Node>(m_nodes).swap(m_nodes);
+	std::vector<Segment>(m_segments).swap(m_segments);
+	std::vector<char>(m_strings).swap(m_strings);
+
+	return !m_segments.empty();
+}
+
+uint64_t DwarfInlineIndex::getMemorySize() const
+{
+	return	m_nodes.capacity() * sizeof(Node) +
+			m_segments.capacity() * sizeof(Segment) +
+			m_strings.capacity();
+}
+
+uint32_t DwarfInlineIndex::findNode(uint64_t _address) const
+{
+	std::vector<Segment>::const_iterator it = std::upper_bound(m_segments.begin(), m_segments.end(), _address, compareSegment);
+	if (it == m_segments.begin())
+		return InvalidNode;
+	--it;
+	return it->m_node;
+}
+
+uint32_t DwarfInlineIndex::findNode(uint64_t _address, uint32_t& _cursor) const
+{
+	if (m_segments.empty())
+		return InvalidNode;
+
+	// segments before the previous hit can't match, and the next address often falls in the same segment
+	std::vector<Segment>::const_iterator first = m_segments.begin() + (_cursor < m_segments.size() ? _cursor : 0);
+	std::vector<Segment>::const_iterator it;
+	if ((first + 1 < m_segments.end()) && (first->m_address <= _address) && (_address < (first + 1)->m_address))
+		it = first + 1;
+	else
+		it = std::upper_bound(first, m_segments.end(), _address, compareSegment);
+
+	if (it == m_segments.begin())
+		return InvalidNode;
+	--it;
+
+	_cursor = (uint32_t)(it - m_segments.begin());
+	return it->m_node;
+}
+
+} // namespace rdebug
@@ -0,0 +1,594 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <rdebug_pch.h>
+#include <rdebug/src/dwarf.h>
+#include <rdebug/src/elf_file.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace rdebug {
+
+enum
+{
+	DW_LNS_copy					= 0x01,
+	DW_LNS_advance_pc			= 0x02,
+	DW_LNS_advance_line			= 0x03,
+	DW_LNS_set_file				= 0x04,
+	DW_LNS_set_column			= 0x05,
+	DW_LNS_negate_stmt			= 0x06,
+	DW_LNS_set_basic_block		= 0x07,
+	DW_LNS_const_add_pc			= 0x08,
+	DW_LNS_fixed_advance_pc		= 0x09,
+	DW_LNS_set_prologue_end		= 0x0a,
+	DW_LNS_set_epilogue_begin	= 0x0b,
+	DW_LNS_set_isa				= 0x0c,
+
+	DW_LNE_end_sequence			= 0x01,
+	DW_LNE_set_address			= 0x02,
+	DW_LNE_define_file			= 0x03,
+	DW_LNE_set_discriminator	= 0x04,
+
+	DW_LNCT_path				= 0x1,
+	DW_LNCT_directory_index		= 0x2
+};
+
+static inline bool pathIsAbsolute(const char* _path)
+{
+	return (_path[0] == '/') || (_path[0] == '\\') || ((_path[0] != '\0') && (_path[1] == ':'));
+}
+
+static inline void pathAppend(std::string& _path, const char* _part)
+{
+	if (!_part || (_part[0] == '\0'))
+		return;
+
+	if (!_path.empty() && (_path[_path.size()-1] != '/') && (_path[_path.size()-1] != '\\'))
+		_path += '/';
+	_path += _part;
+}
+
+/// Builds full path of a line program file entry
+static void pathBuild(std::string& _path, const char* _compDir, const char* _dir, const char* _name)
+{
+	_path.clear();
+	if (!pathIsAbsolute(_name))
+	{
+		if (_dir && !pathIsAbsolute(_dir))
+			pathAppend(_path, _compDir);
+		pathAppend(_path, _dir);
+	}
+	pathAppend(_path, _name);
+}
+
+/// Interns full file paths of all line programs of a module
+struct LineFileTable
+{
+	std::vector<uint32_t>&						m_offsets;
+	std::vector<char>&							m_paths;
+	std::unordered_map<std::string, uint32_t>	m_map;
+	std::string									m_scratch;
+
+	LineFileTable(std::vector<uint32_t>& _offsets, std::vector<char>& _paths)
+		: m_offsets(_offsets)
+		, m_paths(_paths)
+	{}
+
+	uint32_t add(const char* _compDir, const char* _dir, const char* _name)
+	{
+		pathBuild(m_scratch, _compDir, _dir, _name);
+
+		std::unordered_map<std::string, uint32_t>::iterator it = m_map.find(m_scratch);
+		if (it != m_map.end())
+			return it->second;
+
+		uint32_t index = (uint32_t)m_offsets.size();
+		m_offsets.push_back((uint32_t)m_paths.size());
+		m_paths.insert(m_paths.end(), m_scratch.c_str(), m_scratch.c_str() + m_scratch.size() + 1);
+		m_map[m_scratch] = index;
+		return index;
+	}
+};
+
+/// File entry of a line program header, resolved to a global file index on first use
+struct LineFileEntry
+{
+	const char*	m_name;
+	uint64_t	m_dir;
+	uint32_t	m_index;
+};
+
+/// Reads DWARF 5 directory or file name entry list
+static bool readEntryFormat(DwarfReader& _reader, const DwarfSections& _sections, const DwarfUnit& _unit, std::vector<LineFileEntry>& _entries)
+{
+	uint8_t formatCount = _reader.readU8();
+	uint64_t formats[32][2];
+	if (formatCount > 32)
+		return false;
+
+	for (uint8_t i=0; i<formatCount; ++i)
+	{
+		formats[i][0] = _reader.readULEB();
+		formats[i][1] = _reader.readULEB();
+	}
+
+	uint64_t count = _reader.readULEB();
+	if (count > _reader.left())
+		return false;
+
+	for (uint64_t e=0; e<count; ++e)
+	{
+		LineFileEntry entry;
+		entry.m_name	= "";
+		entry.m_dir		= 0;
+		entry.m_index	= DwarfLineTable::InvalidFile;
+
+		for (uint8_t i=0; i<formatCount; ++i)
+		{
+			DwarfValue value;
+			if (!dwarfReadValue(_reader, (uint32_t)formats[i][1], _unit, value))
+				return false;
+
+			if (formats[i][0] == DW_LNCT_path)
+			{
+				const char* name = dwarfGetString(_sections, _unit, value);
+				entry.m_name = name ? name : "";
+			}
+			else
+			if (formats[i][0] == DW_LNCT_directory_index)
+				entry.m_dir = value.m_value;
+		}
+		_entries.push_back(entry);
+	}
+	return !_reader.m_error;
+}
+
+/// Line program header with directory and file tables
+struct LineProgramHeader
+{
+	DwarfUnit					m_unit;
+	uint64_t					m_programStart;
+	uint64_t					m_end;
+	uint8_t						m_minInstLength;
+	int8_t						m_lineBase;
+	uint8_t						m_lineRange;
+	uint8_t						m_opcodeBase;
+	uint8_t						m_standardLengths[256];
+	const char*					m_compDir;
+	std::vector<LineFileEntry>	m_dirs;
+	std::vector<LineFileEntry>	m_files;
+};
+
+static bool parseLineProgramHeader(const DwarfSections& _sections, uint64_t _offset, const DwarfUnit* _cu, const char* _compDir,
+								   LineProgramHeader& _header, uint64_t* _nextOffset = 0)
+{
+	DwarfReader reader(_sections.m_line.m_data, _sections.m_line.m_size, _sections.m_bigEndian);
+	if (!reader.skip(_offset))
+		return false;
+
+	DwarfUnit& unit = _header.m_unit;
+	if (_cu)
+		unit = *_cu;
+
+	uint64_t length;
+	if (!reader.readLength(length, unit.m_is64))
+		return false;
+
+	_header.m_end = reader.m_pos + length;
+	if (_nextOffset)
+		*_nextOffset = _header.m_end;
+
+	unit.m_version = reader.readU16();
+	if ((unit.m_version < 2) || (unit.m_version > 5))
+		return false;
+
+	if (unit.m_version >= 5)
+	{
+		unit.m_addressSize = reader.readU8();
+		reader.readU8();	// segment selector size
+	}
+
+	uint64_t headerLength = reader.readOffset(unit.m_is64);
+	_header.m_programStart = reader.m_pos + headerLength;
+
+	_header.m_minInstLength	= reader.readU8();
+	if (unit.m_version >= 4)
+		reader.readU8();	// maximum operations per instruction, VLIW only
+	reader.readU8();		// default is_stmt
+	_header.m_lineBase		= (int8_t)reader.readU8();
+	_header.m_lineRange		= reader.readU8();
+	_header.m_opcodeBase	= reader.readU8();
+
+	if ((_header.m_lineRange == 0) || (_header.m_opcodeBase == 0) || reader.m_error)
+		return false;
+
+	for (uint32_t i=1; i<_header.m_opcodeBase; ++i)
+		_header.m_standardLengths[i] = reader.readU8();
+
+	_header.m_dirs.clear();
+	_header.m_files.clear();
+
+	if (unit.m_version >= 5)
+	{
+		if (!readEntryFormat(reader, _sections, unit, _header.m_dirs) ||
+			!readEntryFormat(reader, _sections, unit, _header.m_files))
+			return false;
+	}
+	else
+	{
+		LineFileEntry entry;
+		entry.m_name	= _compDir;
+		entry.m_dir		= 0;
+		entry.m_index	= DwarfLineTable::InvalidFile;
+		_header.m_dirs.push_back(entry);	// directory 0 is compilation directory
+		_header.m_files.push_back(entry);	// file indices are 1 based before DWARF 5
+
+		while (!reader.eof())
+		{
+			entry.m_name = reader.readString();
+			if (entry.m_name[0] == '\0')
+				break;
+			_header.m_dirs.push_back(entry);
+		}
+
+		while (!reader.eof())
+		{
+			entry.m_name = reader.readString();
+			if (entry.m_name[0] == '\0')
+				break;
+			entry.m_dir = reader.readULEB();
+			reader.readULEB();	// modification time
+			reader.readULEB();	// file size
+			_header.m_files.push_back(entry);
+		}
+	}
+
+	_header.m_compDir = _header.m_dirs.size() ? _header.m_dirs[0].m_name : _compDir;
+
+	return !reader.m_error && (_header.m_programStart <= _header.m_end);
+}
+
+/// Resolves file entry of a line program to a global file index
+static uint32_t lineFileIndex(LineProgramHeader& _header, LineFileTable& _files, uint64_t _file)
+{
+	if (_file >= _header.m_files.size())
+		return DwarfLineTable::InvalidFile;
+
+	LineFileEntry& entry = _header.m_files[(size_t)_file];
+	if (entry.m_index == DwarfLineTable::InvalidFile)
+	{
+		const char* dir = entry.m_dir < _header.m_dirs.size() ? _header.m_dirs[(size_t)entry.m_dir].m_name : 0;
+		entry.m_index = _files.add(_header.m_compDir, dir, entry.m_name);
+	}
+	return entry.m_index;
+}
+
+/// Decodes a single line program, appends its rows to _rows
+static bool decodeLineProgram(const DwarfSections& _sections, uint64_t _offset, const DwarfUnit* _cu, const char* _compDir,
+							  LineFileTable& _files, std::vector<DwarfLineTable::Row>& _rows, uint64_t* _nextOffset = 0)
+{
+	LineProgramHeader header;
+	if (!parseLineProgramHeader(_sections, _offset, _cu, _compDir, header, _nextOffset))
+		return false;
+
+	const DwarfUnit&	unit			= header.m_unit;
+	const uint8_t		minInstLength	= header.m_minInstLength;
+	const int8_t		lineBase		= header.m_lineBase;
+	const uint8_t		lineRange		= header.m_lineRange;
+	const uint8_t		opcodeBase		= header.m_opcodeBase;
+
+	DwarfReader reader(_sections.m_line.m_data, header.m_end, _sections.m_bigEndian);
+	reader.m_pos = header.m_programStart;
+
+	// addresses of discarded (garbage collected or folded) functions are set to 0 or to a tombstone value
+	const uint64_t tombstone = (unit.m_addressSize == 8) ? ~0ull - 1 : 0xfffffffe;
+
+	uint64_t	address		= 0;
+	uint64_t	file		= 1;
+	int64_t		line		= 1;
+	size_t		seqStart	= _rows.size();
+	uint64_t	seqAddress	= 0;
+	bool		seqEmpty	= true;
+
+	while (!reader.eof())
+	{
+		bool emitRow = false;
+		uint8_t opcode = reader.readU8();
+
+		if (opcode >= opcodeBase)
+		{
+			uint8_t adjusted = opcode - opcodeBase;
+			address	+= (adjusted / lineRange) * minInstLength;
+			line	+= lineBase + (adjusted % lineRange);
+			emitRow = true;
+		}
+		else
+		switch (opcode)
+		{
+		case 0:
+			{
+				uint64_t len = reader.readULEB();
+				uint64_t next = reader.m_pos + len;
+				if ((len == 0) || (len > reader.left()))
+				{
+					reader.m_error = true;
+					break;
+				}
+
+				uint8_t subOpcode = reader.readU8();
+				switch (subOpcode)
+				{
+				case DW_LNE_end_sequence:
+					{
+						// rows at the end address cover no code
+						while ((_rows.size() > seqStart) && (_rows[_rows.size()-1].m_address >= address))
+							_rows.pop_back();
+
+						DwarfLineTable::Row row;
+						row.m_address	= address;
+						row.m_file		= DwarfLineTable::InvalidFile;
+						row.m_line		= 0;
+						_rows.push_back(row);
+
+						if (seqEmpty || (seqAddress == 0) || (seqAddress >= tombstone))
+							_rows.resize(seqStart);
+
+						seqStart	= _rows.size();
+						seqEmpty	= true;
+						address		= 0;
+						file		= 1;
+						line		= 1;
+					}
+					break;
+
+				case DW_LNE_set_address:
+					address = reader.readN((uint32_t)(len - 1));
+					break;
+
+				default:
+					break;
+				};
+
+				reader.m_pos = next;
+			}
+			break;
+
+		case DW_LNS_copy:				emitRow = true;	break;
+		case DW_LNS_advance_pc:			address += reader.readULEB() * minInstLength;	break;
+		case DW_LNS_advance_line:		line += reader.readSLEB();	break;
+		case DW_LNS_set_file:			file = reader.readULEB();	break;
+		case DW_LNS_const_add_pc:		address += ((255 - opcodeBase) / lineRange) * minInstLength;	break;
+		case DW_LNS_fixed_advance_pc:	address += reader.readU16();	break;
+
+		default:
+			// skip operands of standard opcodes we don't care about, including unknown ones
+			for (uint32_t i=0; i<header.m_standardLengths[opcode]; ++i)
+				reader.readULEB();
+			break;
+		};
+
+		if (emitRow)
+		{
+			if (seqEmpty)
+			{
+				seqAddress	= address;
+				seqEmpty	= false;
+			}
+
+			uint32_t fileIndex = lineFileIndex(header, _files, file);
+			if (fileIndex != DwarfLineTable::InvalidFile)
+			{
+				DwarfLineTable::Row row;
+				row.m_address	= address;
+				row.m_file		= fileIndex;
+				row.m_line		= (uint32_t)line;
+				_rows.push_back(row);
+			}
+		}
+	}
+
+	// drop unterminated sequence
+	_rows.resize(seqStart);
+	return true;
+}
+
+bool dwarfReadLineFiles(const DwarfSections& _sections, uint64_t _offset, const DwarfUnit& _cu, const char* _compDir, std::vector<std::string>& _paths)
+{
+	LineProgramHeader header;
+	if (!parseLineProgramHeader(_sections, _offset, &_cu, _compDir, header))
+		return false;
+
+	_paths.resize(header.m_files.size());
+	for (size_t i=0; i<header.m_files.size(); ++i)
+	{
+		const LineFileEntry& entry = header.m_files[i];
+		const char* dir = entry.m_dir < header.m_dirs.size() ? header.m_dirs[(size_t)entry.m_dir].m_name : 0;
+		pathBuild(_paths[i], header.m_compDir, dir, entry.m_name);
+	}
+	return true;
+}
+
+static inline bool sortRows(const DwarfLineTable::Row& _r1, const DwarfLineTable::Row& _r2)
+{
+	if (_r1.m_address != _r2.m_address)
+		return _r1.m_address < _r2.m_address;
+
+	// end of sequence goes first so that a sequence starting at the same address wins
+	return (_r1.m_file == DwarfLineTable::InvalidFile) && (_r2.m_file != DwarfLineTable::InvalidFile);
+}
+
+DwarfLineTable::DwarfLineTable()
+{
+	memset(&m_tables, 0, sizeof(m_tables));
+}
+
+void DwarfLineTable::attach(const Tables& _tables)
+{
+	m_tables = _tables;
+}
+
+bool DwarfLineTable::build(const ElfFile& _elf)
+{
+	m_rows.clear();
+	m_fileOffsets.clear();
+	m_filePaths.clear();
+	memset(&m_tables, 0, sizeof(m_tables));
+
+	DwarfSections sections;
+	sections.init(_elf);
+
+	if (!sections.m_line.m_data)
+		return false;
+
+	LineFileTable files(m_fileOffsets, m_filePaths);
+
+	if (sections.m_info.m_data && sections.m_abbrev.m_data)
+	{
+		// walk compilation units to get line program offsets along with compilation directories
+		std::vector<uint64_t>	decoded;
+		std::vector<DwarfValue>	values;
+		DwarfAbbrevTable		abbrevs;
+		uint64_t				abbrevOffset = ~0ull;
+
+		uint64_t offset = 0;
+		while (offset < sections.m_info.m_size)
+		{
+			DwarfUnit unit;
+			if (!unit.parseHeader(sections, offset))
+				break;
+			offset = unit.m_end;
+
+			if ((unit.m_unitType != DW_UT_compile) && (unit.m_unitType != DW_UT_partial) && (unit.m_unitType != DW_UT_skeleton))
+				continue;
+
+			if (abbrevOffset != unit.m_abbrevOffset)
+			{
+				abbrevOffset = unit.m_abbrevOffset;
+				if (!abbrevs.parse(sections, abbrevOffset))
+					continue;
+			}
+
+			const DwarfAbbrev* abbrev = dwarfReadUnitDie(sections, unit, abbrevs, values);
+			if (!abbrev)
+				continue;
+
+			const DwarfValue* stmtList	= dwarfFindAttribute(abbrevs, *abbrev, values, DW_AT_stmt_list);
+			const DwarfValue* compDir	= dwarfFindAttribute(abbrevs, *abbrev, values, DW_AT_comp_dir);
+			if (!stmtList)
+				continue;
+
+			if (std::find(decoded.begin(), decoded.end(), stmtList->m_value) != decoded.end())
+				continue;
+			decoded.push_back(stmtList->m_value);
+
+			const char* dir = compDir ? dwarfGetString(sections, unit, *compDir) : 0;
+			decodeLineProgram(sections, stmtList->m_value, &unit, dir ? dir : "", files, m_rows);
+		}
+	}
+	else
+	{
+		// no debug info, line programs are still usable, but without compilation directory
+		uint64_t offset = 0;
+		while (offset < sections.m_line.m_size)
+		{
+			uint64_t next = sections.m_line.m_size;
+			DwarfUnit unit;
+			unit.m_addressSize = _elf.is64bit() ? 8 : 4;
+			if (!decodeLineProgram(sections, offset, &unit, "", files, m_rows, &next) && (next <= offset))
+				break;
+			offset = next;
+		}
+	}
+
+	return finish();
+}
+
+bool DwarfLineTable::build(const DwarfSections& _sections, const DwarfUnit& _unit, uint64_t _stmtList, const char* _compDir)
+{
+	m_rows.clear();
+	m_fileOffsets.clear();
+	m_filePaths.clear();
+	memset(&m_tables, 0, sizeof(m_tables));
+
+	LineFileTable files(m_fileOffsets, m_filePaths);
+	decodeLineProgram(_sections, _stmtList, &_unit, _compDir, files, m_rows);
+	return finish();
+}
+
+bool DwarfLineTable::finish()
+{
+	std::stable_sort(m_rows.begin(), m_rows.end(), sortRows);
+	std::vector<Row>(m_rows).swap(m_rows);
+
+	m_tables.m_rows				= m_rows.empty() ? 0 : &m_rows[0];
+	m_tables.m_fileOffsets		= m_fileOffsets.empty() ? 0 : &m_fileOffsets[0];
+	m_tables.m_filePaths		= m_filePaths.empty() ? 0 : &m_filePaths[0];
+	m_tables.m_numRows			= (uint32_t)m_rows.size();
+	m_tables.m_numFiles			= (uint32_t)m_fileOffsets.size();
+	m_tables.m_filePathsSize	= (uint32_t)m_filePaths.size();
+
+	return !m_rows.empty();
+}
+
+uint64_t DwarfLineTable::getMemorySize() const
+{
+	return	m_rows.capacity() * sizeof(Row) +
+			m_fileOffsets.capacity() * sizeof(uint32_t) +
+			m_filePaths.capacity();
+}
+
+static inline bool compareRowAddress(uint64_t _address, const DwarfLineTable::Row& _row)
+{
+	return _address < _row.m_address;
+}
+
+bool DwarfLineTable::getLine(const Row& _row, const char*& _file, uint32_t& _line) const
+{
+	// tables may come from a cache file, so indices are checked before they are followed
+	if ((_row.m_file >= m_tables.m_numFiles) || (m_tables.m_fileOffsets[_row.m_file] >= m_tables.m_filePathsSize))
+		return false;
+
+	_file	= &m_tables.m_filePaths[m_tables.m_fileOffsets[_row.m_file]];
+	_line	= _row.m_line;
+	return true;
+}
+
+bool DwarfLineTable::findLine(uint64_t _address, const char*& _file, uint32_t& _line) const
+{
+	const Row* begin	= m_tables.m_rows;
+	const Row* end		= m_tables.m_rows + m_tables.m_numRows;
+
+	const Row* it = std::upper_bound(begin, end, _address, compareRowAddress);
+	if (it == begin)
+		return false;
+
+	return getLine(*(it - 1), _file, _line);
+}
+
+bool DwarfLineTable::findLine(uint64_t _address, const char*& _file, uint32_t& _line, uint32_t& _cursor) const
+{
+	const Row* begin	= m_tables.m_rows;
+	const Row* end		= m_tables.m_rows + m_tables.m_numRows;
+	if (begin == end)
+		return false;
+
+	// rows before the previous hit can't match, and the next address often falls in the same row
+	const Row* first = begin + (_cursor < m_tables.m_numRows ? _cursor : 0);
+	const Row* it;
+	if ((first + 1 < end) && (first->m_address <= _address) && (_address < (first + 1)->m_address))
+		it = first + 1;
+	else
+		it = std::upper_bound(first, end, _address, compareRowAddress);
+
+	if (it == begin)
+		return false;
+
+	_cursor = (uint32_t)(it - begin - 1);
+
+	return getLine(*(it - 1), _file, _line);
+}
+
+} // namespace rdebug
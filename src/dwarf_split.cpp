@@ -0,0 +1,257 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <rdebug_pch.h>
+#include <rdebug/src/dwarf.h>
+#include <rdebug/src/elf_file.h>
+
+namespace rdebug {
+
+/// Size of the .debug_cu_index header, same in version 2 and 5
+static const uint64_t s_indexHeaderSize = 16;
+
+static inline uint64_t readIndex(const DwarfSection& _index, bool _bigEndian, uint64_t _offset, uint32_t _bytes)
+{
+	DwarfReader reader(_index.m_data, _index.m_size, _bigEndian);
+	reader.skip(_offset);
+	return reader.readN(_bytes);
+}
+
+DwarfPackage::DwarfPackage()
+	: m_version(0)
+	, m_numColumns(0)
+	, m_numUnits(0)
+	, m_numSlots(0)
+{
+}
+
+bool DwarfPackage::load(const ElfFile& _dwp, const DwarfSections& _skeleton)
+{
+	m_sections.initSplit(_dwp, _skeleton);
+
+	m_index.m_data = _dwp.getSectionContents(_dwp.findDebugSection(".debug_cu_index"), m_index.m_size);
+	if (!m_index.m_data || !m_sections.m_info.m_data || !m_sections.m_abbrev.m_data)
+		return false;
+
+	DwarfReader reader(m_index.m_data, m_index.m_size, m_sections.m_bigEndian);
+
+	// version 5 is a 2 byte version followed by padding, GNU version 2 is 4 bytes
+	const uint16_t version0	= reader.readU16();
+	const uint16_t version1	= reader.readU16();
+	const uint32_t version	= version0 ? version0 : version1;
+	const uint32_t columns	= reader.readU32();
+	const uint32_t units	= reader.readU32();
+	const uint32_t slots	= reader.readU32();
+
+	if (reader.m_error || ((version != 2) && (version != 5)) || (slots & (slots - 1)))
+		return false;
+
+	// hash table (signatures and rows), column headers, then offsets and sizes tables
+	const uint64_t size = s_indexHeaderSize + (uint64_t)slots * 12 + (uint64_t)columns * 4 + (uint64_t)units * columns * 8;
+	if (size > m_index.m_size)
+		return false;
+
+	m_version		= version;
+	m_numColumns	= columns;
+	m_numUnits		= units;
+	m_numSlots		= slots;
+	return true;
+}
+
+bool DwarfPackage::findUnit(uint64_t _dwoId, DwarfSections& _sections) const
+{
+	if (!m_numSlots || !m_numUnits)
+		return false;
+
+	const bool bigEndian = m_sections.m_bigEndian;
+
+	// open addressing, secondary hash is taken from the upper half of the signature
+	const uint64_t mask	= m_numSlots - 1;
+	const uint64_t step	= ((_dwoId >> 32) & mask) | 1;
+	uint64_t slot		= _dwoId & mask;
+	uint32_t row		= 0;
+
+	for (uint32_t i=0; i<m_numSlots; ++i)
+	{
+		const uint64_t signature	= readIndex(m_index, bigEndian, s_indexHeaderSize + slot * 8, 8);
+		const uint32_t index		= (uint32_t)readIndex(m_index, bigEndian, s_indexHeaderSize + m_numSlots * 8 + slot * 4, 4);
+		if (index == 0)
+			return false;
+
+		if (signature == _dwoId)
+		{
+			row = index;
+			break;
+		}
+		slot = (slot + step) & mask;
+	}
+
+	if ((row == 0) || (row > m_numUnits))
+		return false;
+
+	const uint64_t columnsOffset	= s_indexHeaderSize + (uint64_t)m_numSlots * 12;
+	const uint64_t offsetsOffset	= columnsOffset + (uint64_t)m_numColumns * 4;
+	const uint64_t sizesOffset		= offsetsOffset + (uint64_t)m_numUnits * m_numColumns * 4;
+	const uint64_t rowOffset		= (uint64_t)(row - 1) * m_numColumns * 4;
+
+	// sections without a contribution for this unit stay empty
+	_sections = m_sections;
+	_sections.m_info		= DwarfSection();
+	_sections.m_abbrev		= DwarfSection();
+	_sections.m_strOffsets	= DwarfSection();
+	_sections.m_rngLists	= DwarfSection();
+
+	for (uint32_t i=0; i<m_numColumns; ++i)
+	{
+		const uint32_t id		= (uint32_t)readIndex(m_index, bigEndian, columnsOffset + i * 4, 4);
+		const uint64_t offset	= readIndex(m_index, bigEndian, offsetsOffset + rowOffset + i * 4, 4);
+		const uint64_t size		= readIndex(m_index, bigEndian, sizesOffset + rowOffset + i * 4, 4);
+
+		const DwarfSection* whole	= 0;
+		DwarfSection* section		= 0;
+		switch (id)
+		{
+		case DW_SECT_INFO:			whole = &m_sections.m_info;			section = &_sections.m_info;		break;
+		case DW_SECT_ABBREV:		whole = &m_sections.m_abbrev;		section = &_sections.m_abbrev;		break;
+		case DW_SECT_STR_OFFSETS:	whole = &m_sections.m_strOffsets;	section = &_sections.m_strOffsets;	break;
+		case DW_SECT_RNGLISTS:		if (m_version == 5)	// DW_SECT_MACRO in version 2
+									{
+										whole = &m_sections.m_rngLists;
+										section = &_sections.m_rngLists;
+									}
+									break;
+		};
+
+		if (!section || !whole->m_data || (offset > whole->m_size) || (size > whole->m_size - offset))
+			continue;
+
+		section->m_data	= whole->m_data + offset;
+		section->m_size	= size;
+	}
+
+	return _sections.m_info.m_data && _sections.m_abbrev.m_data;
+}
+
+const DwarfPackage* DwarfUnitIndex::getPackage() const
+{
+	std::lock_guard<std::mutex> lock(m_packageLock);
+	if (!m_packageLoaded)
+	{
+		m_packageLoaded = true;
+
+		if (!m_imagePath.empty())
+		{
+			const std::string path = m_imagePath + ".dwp";
+
+			ElfFile* dwp = rtm_new<ElfFile>();
+			if (dwp->load(path.c_str()) && m_package.load(*dwp, m_sections))
+				m_packageFile = dwp;
+			else
+				rtm_delete<ElfFile>(dwp);
+		}
+	}
+	return m_packageFile ? &m_package : 0;
+}
+
+/// Finds the split unit matching the skeleton and sets up its bases, which split units inherit from the skeleton
+static bool findSplitUnit(const DwarfSections& _sections, const DwarfUnit& _skeleton, DwarfUnit& _unit)
+{
+	uint64_t offset = 0;
+	while (offset < _sections.m_info.m_size)
+	{
+		if (!_unit.parseHeader(_sections, offset))
+			return false;
+		offset = _unit.m_end;
+
+		// pre DWARF 5 split units are ordinary compile units with DW_AT_GNU_dwo_id in the unit DIE
+		if (_unit.m_version < 5)
+		{
+			DwarfAbbrevTable		abbrevs;
+			std::vector<DwarfValue>	values;
+			DwarfUnit				unit = _unit;
+			if (!abbrevs.parse(_sections, unit.m_abbrevOffset) || !dwarfReadUnitDie(_sections, unit, abbrevs, values))
+				continue;
+			_unit.m_dwoId = unit.m_dwoId;
+		}
+		else
+		if (_unit.m_unitType != DW_UT_split_compile)
+			continue;
+
+		if (_unit.m_dwoId != _skeleton.m_dwoId)
+			continue;
+
+		_unit.m_unitType	= DW_UT_split_compile;
+		_unit.m_addrBase	= _skeleton.m_addrBase;
+		_unit.m_baseAddress	= _skeleton.m_baseAddress;
+
+		if (_unit.m_version >= 5)
+		{
+			// offsets are relative to the end of the contribution header
+			_unit.m_strOffsetsBase	= _unit.m_is64 ? 16 : 8;
+			_unit.m_rngListsBase	= _unit.m_is64 ? 20 : 12;
+		}
+		else
+		{
+			_unit.m_strOffsetsBase	= 0;
+			_unit.m_rngListsBase	= _skeleton.m_rngListsBase;		// DW_AT_GNU_ranges_base
+		}
+		return true;
+	}
+	return false;
+}
+
+static inline bool isAbsolutePath(const char* _path)
+{
+	return (_path[0] == '/') || (_path[0] == '\\') || ((_path[0] != '\0') && (_path[1] == ':'));
+}
+
+bool DwarfUnitIndex::decodeSplit(const DwarfSkeleton& _skeleton, const char* _dwoName, DwarfInlineIndex& _inlines) const
+{
+	std::vector<DwarfUnit> units(1);
+
+	const DwarfPackage* package = getPackage();
+	if (package)
+	{
+		DwarfSections sections;
+		if (package->findUnit(_skeleton.m_unit.m_dwoId, sections) && findSplitUnit(sections, _skeleton.m_unit, units[0]))
+			return _inlines.build(sections, units, 0, &_skeleton);
+	}
+
+	if (_dwoName[0] == '\0')
+		return false;
+
+	// same places GDB looks in, the object may have been moved along with the image
+	const std::string imageDir(m_imagePath, 0, rtm::pathGetFileName(m_imagePath.c_str()) - m_imagePath.c_str());
+	const char* fileName = rtm::pathGetFileName(_dwoName);
+
+	std::vector<std::string> paths;
+	if (isAbsolutePath(_dwoName))
+		paths.push_back(_dwoName);
+	else
+	{
+		if (_skeleton.m_compDir[0] != '\0')
+			paths.push_back(std::string(_skeleton.m_compDir) + "/" + _dwoName);
+		paths.push_back(imageDir + _dwoName);
+	}
+	if (fileName != _dwoName)
+		paths.push_back(imageDir + fileName);
+
+	for (size_t i=0; i<paths.size(); ++i)
+	{
+		// mapped only while the unit is decoded, scopes keep copies of their strings
+		ElfFile dwo;
+		if (!dwo.load(paths[i].c_str()))
+			continue;
+
+		DwarfSections sections;
+		sections.initSplit(dwo, m_sections);
+		if (findSplitUnit(sections, _skeleton.m_unit, units[0]))
+			return _inlines.build(sections, units, 0, &_skeleton);
+	}
+
+	return false;
+}
+
+} // namespace rdebug
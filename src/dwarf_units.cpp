@@ -0,0 +1,321 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <rdebug_pch.h>
+#include <rdebug/src/dwarf.h>
+#include <rdebug/src/elf_file.h>
+
+#include <algorithm>
+
+namespace rdebug {
+
+static inline bool compareUnitOffset(uint64_t _offset, const DwarfUnit& _unit)
+{
+	return _offset < _unit.m_offset;
+}
+
+DwarfUnitIndex::DwarfUnitIndex()
+	: m_memoryBudget(0)
+	, m_packageLoaded(false)
+	, m_packageFile(0)
+	, m_hand(0)
+	, m_clock(1)
+	, m_memoryUsed(0)
+{
+}
+
+DwarfUnitIndex::~DwarfUnitIndex()
+{
+	// decoded units don't point into the package, it can go first
+	if (m_packageFile)
+		rtm_delete<ElfFile>(m_packageFile);
+}
+
+bool DwarfUnitIndex::build(const ElfFile& _elf, const char* _imagePath, uint64_t _memoryBudget)
+{
+	m_sections.init(_elf);
+	m_memoryBudget	= _memoryBudget;
+	m_imagePath		= _imagePath ? _imagePath : "";
+
+	if (!m_sections.m_info.m_data || !m_sections.m_abbrev.m_data)
+		return false;
+
+	uint64_t offset = 0;
+	while (offset < m_sections.m_info.m_size)
+	{
+		DwarfUnit unit;
+		if (!unit.parseHeader(m_sections, offset))
+			break;
+		offset = unit.m_end;
+		m_units.push_back(unit);
+	}
+
+	std::vector<uint8_t> covered(m_units.size(), 0);
+	readAranges(covered);
+
+	// units missing from .debug_aranges (or all of them if it's absent) are mapped by ranges of the unit DIE
+	std::vector<DwarfValue>	values;
+	std::vector<DwarfRange>	ranges;
+	DwarfAbbrevTable		abbrevs;
+	uint64_t				abbrevOffset = ~0ull;
+
+	for (uint32_t i=0; i<(uint32_t)m_units.size(); ++i)
+	{
+		DwarfUnit unit = m_units[i];
+		if (covered[i])
+			continue;
+
+		if ((unit.m_unitType != DW_UT_compile) && (unit.m_unitType != DW_UT_partial) && (unit.m_unitType != DW_UT_skeleton))
+			continue;
+
+		if (abbrevOffset != unit.m_abbrevOffset)
+		{
+			abbrevOffset = unit.m_abbrevOffset;
+			if (!abbrevs.parse(m_sections, abbrevOffset))
+			{
+				abbrevOffset = ~0ull;
+				continue;
+			}
+		}
+
+		const DwarfAbbrev* abbrev = dwarfReadUnitDie(m_sections, unit, abbrevs, values);
+		if (!abbrev)
+			continue;
+
+		ranges.clear();
+		dwarfGetRanges(m_sections, unit, abbrevs, *abbrev, values, ranges);
+		for (size_t j=0; j<ranges.size(); ++j)
+		{
+			// discarded code (garbage collected sections) is relocated to zero
+			if ((ranges[j].m_low == 0) || (ranges[j].m_low >= ranges[j].m_high))
+				continue;
+
+			Range range;
+			range.m_low		= ranges[j].m_low;
+			range.m_high	= ranges[j].m_high;
+			range.m_unit	= i;
+			m_ranges.push_back(range);
+		}
+	}
+
+	std::stable_sort(m_ranges.begin(), m_ranges.end(), sortRanges);
+
+	// make ranges disjoint, overlaps go to the unit that starts first
+	size_t numRanges = 0;
+	for (size_t i=0; i<m_ranges.size(); ++i)
+	{
+		Range range = m_ranges[i];
+		if (numRanges)
+		{
+			Range& last = m_ranges[numRanges - 1];
+			if (range.m_low < last.m_high)
+				range.m_low = last.m_high;
+			if (range.m_low >= range.m_high)
+				continue;
+
+			if ((range.m_low == last.m_high) && (range.m_unit == last.m_unit))
+			{
+				last.m_high = range.m_high;
+				continue;
+			}
+		}
+		m_ranges[numRanges++] = range;
+	}
+	m_ranges.resize(numRanges);
+	std::vector<Range>(m_ranges).swap(m_ranges);
+
+	std::vector<Entry>(m_units.size()).swap(m_entries);
+	return !m_ranges.empty();
+}
+
+void DwarfUnitIndex::readAranges(std::vector<uint8_t>& _covered)
+{
+	const DwarfSection& aranges = m_sections.m_aranges;
+	if (!aranges.m_data)
+		return;
+
+	uint64_t offset = 0;
+	while (offset < aranges.m_size)
+	{
+		DwarfReader reader(aranges.m_data, aranges.m_size, m_sections.m_bigEndian);
+		reader.skip(offset);
+
+		uint64_t	length;
+		bool		is64;
+		if (!reader.readLength(length, is64))
+			break;
+
+		const uint64_t end = reader.m_pos + length;
+		offset = end;
+
+		const uint16_t version		= reader.readU16();
+		const uint64_t infoOffset	= reader.readOffset(is64);
+		const uint8_t addressSize	= reader.readU8();
+		const uint8_t segmentSize	= reader.readU8();
+
+		if ((version != 2) || reader.m_error || ((addressSize != 4) && (addressSize != 8) && (addressSize != 2)))
+			continue;
+
+		std::vector<DwarfUnit>::const_iterator unit = std::upper_bound(m_units.begin(), m_units.end(), infoOffset, compareUnitOffset);
+		if ((unit == m_units.begin()) || ((--unit)->m_offset != infoOffset))
+			continue;
+
+		const uint32_t unitIndex = (uint32_t)(unit - m_units.begin());
+
+		// tuples are aligned to their size, counting from the start of the set
+		const uint64_t tupleSize = segmentSize + 2 * addressSize;
+		const uint64_t start = end - length - (is64 ? 12 : 4);
+		const uint64_t misalign = (reader.m_pos - start) % tupleSize;
+		if (misalign)
+			reader.skip(tupleSize - misalign);
+
+		DwarfReader tuples(aranges.m_data, end, m_sections.m_bigEndian);
+		tuples.skip(reader.m_pos);
+
+		bool hasTuples = false;
+		while (tuples.left() >= tupleSize)
+		{
+			tuples.skip(segmentSize);
+			uint64_t address	= tuples.readN(addressSize);
+			uint64_t size		= tuples.readN(addressSize);
+			if ((address == 0) && (size == 0))
+				break;
+
+			hasTuples = true;
+
+			// discarded code (garbage collected sections) is relocated to zero
+			if ((address == 0) || (size == 0))
+				continue;
+
+			Range range;
+			range.m_low		= address;
+			range.m_high	= address + size;
+			range.m_unit	= unitIndex;
+			m_ranges.push_back(range);
+		}
+
+		// an empty set doesn't prove the unit has no code, let the unit DIE tell
+		if (hasTuples)
+			_covered[unitIndex] = 1;
+	}
+}
+
+uint32_t DwarfUnitIndex::findUnit(uint64_t _address) const
+{
+	std::vector<Range>::const_iterator it = std::upper_bound(m_ranges.begin(), m_ranges.end(), _address, compareRange);
+
+	if (it == m_ranges.begin())
+		return InvalidUnit;
+	--it;
+
+	return _address < it->m_high ? it->m_unit : InvalidUnit;
+}
+
+DwarfUnitIndex::DecodedPtr DwarfUnitIndex::getUnit(uint32_t _unit)
+{
+	if (_unit >= m_entries.size())
+		return DecodedPtr();
+
+	// hits only stamp the entry, and only once per tick so hot units don't keep bouncing its cache line
+	Entry& entry = m_entries[_unit];
+	DecodedPtr hit = std::atomic_load(&entry.m_decoded);
+	if (hit)
+	{
+		const uint64_t now = m_clock.load(std::memory_order_relaxed);
+		if (entry.m_lastUsed.load(std::memory_order_relaxed) != now)
+			entry.m_lastUsed.store(now, std::memory_order_relaxed);
+		return hit;
+	}
+
+	// decoding touches only immutable data, other units stay available meanwhile
+	std::shared_ptr<Decoded> decoded = std::make_shared<Decoded>();
+	decode(_unit, *decoded);
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	hit = std::atomic_load(&entry.m_decoded);
+	if (hit)
+		return hit;
+
+	const uint64_t now = m_clock.load(std::memory_order_relaxed);
+	entry.m_lastUsed.store(now, std::memory_order_relaxed);
+	entry.m_visited	= now - 1;
+	std::atomic_store(&entry.m_decoded, DecodedPtr(decoded));
+	m_resident.push_back(_unit);
+	m_memoryUsed	+= decoded->m_memorySize;
+
+	// units hit since the hand last passed them get a second chance, so the sweep ends within two rounds.
+	// The unit just decoded is never evicted, it may be larger than the whole budget.
+	while ((m_memoryUsed > m_memoryBudget) && (m_resident.size() > 1))
+	{
+		if (m_hand >= m_resident.size())
+			m_hand = 0;
+
+		const uint32_t unit = m_resident[m_hand];
+		Entry& victim = m_entries[unit];
+		if ((unit == _unit) || (victim.m_lastUsed.load(std::memory_order_relaxed) > victim.m_visited))
+		{
+			victim.m_visited = now;
+			++m_hand;
+			continue;
+		}
+
+		m_memoryUsed -= std::atomic_load(&victim.m_decoded)->m_memorySize;
+		std::atomic_store(&victim.m_decoded, DecodedPtr());
+		m_resident[m_hand] = m_resident.back();
+		m_resident.pop_back();
+	}
+
+	// hits from here on are newer than every pass the hand made so far
+	m_clock.store(now + 1, std::memory_order_relaxed);
+	return decoded;
+}
+
+void DwarfUnitIndex::decode(uint32_t _unit, Decoded& _decoded) const
+{
+	_decoded.m_memorySize = sizeof(Decoded);
+
+	DwarfUnit unit = m_units[_unit];
+
+	DwarfAbbrevTable abbrevs;
+	if (!abbrevs.parse(m_sections, unit.m_abbrevOffset))
+		return;
+
+	std::vector<DwarfValue> values;
+	const DwarfAbbrev* abbrev = dwarfReadUnitDie(m_sections, unit, abbrevs, values);
+	if (!abbrev)
+		return;
+
+	const DwarfValue* stmtList	= dwarfFindAttribute(abbrevs, *abbrev, values, DW_AT_stmt_list);
+	const DwarfValue* compDir	= dwarfFindAttribute(abbrevs, *abbrev, values, DW_AT_comp_dir);
+	const char* dir = compDir ? dwarfGetString(m_sections, unit, *compDir) : 0;
+	if (!dir)
+		dir = "";
+
+	// skeleton units keep their line program in the image, so lines never depend on split DWARF files
+	if (stmtList && m_sections.m_line.m_data)
+		_decoded.m_lines.build(m_sections, unit, stmtList->m_value, dir);
+
+	const DwarfValue* dwoName = dwarfFindAttribute(abbrevs, *abbrev, values, DW_AT_dwo_name);
+	if (!dwoName)
+		dwoName = dwarfFindAttribute(abbrevs, *abbrev, values, DW_AT_GNU_dwo_name);
+
+	if ((unit.m_unitType == DW_UT_skeleton) || dwoName)
+	{
+		DwarfSkeleton skeleton;
+		skeleton.m_sections	= &m_sections;
+		skeleton.m_unit		= unit;
+		skeleton.m_stmtList	= stmtList ? stmtList->m_value : ~0ull;
+		skeleton.m_compDir	= dir;
+
+		const char* name = dwoName ? dwarfGetString(m_sections, unit, *dwoName) : 0;
+		decodeSplit(skeleton, name ? name : "", _decoded.m_inlines);
+	}
+	else
+		_decoded.m_inlines.build(m_sections, m_units, _unit);
+
+	_decoded.m_memorySize += _decoded.m_lines.getMemorySize() + _decoded.m_inlines.getMemorySize();
+}
+
+} // namespace rdebug
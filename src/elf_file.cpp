@@ -0,0 +1,711 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <rdebug_pch.h>
+#include <rdebug/src/elf_file.h>
+#include <rdebug/src/symbols_map.h>
+#include <rdebug/src/cxx_demangle.h>
+#include <rdebug/src/decompress.h>
+#include <rdebug/src/thread_pool.h>
+
+#include "../3rd/rust-demangle.h"
+
+#include <algorithm>
+
+namespace rdebug {
+
+// ELF constants, only the ones we need (no dependency on system <elf.h>, not available on Windows)
+enum
+{
+	ELF_CLASS32			= 1,
+	ELF_CLASS64			= 2,
+	ELF_DATA2LSB		= 1,
+	ELF_DATA2MSB		= 2,
+
+	ELF_SHT_SYMTAB		= 2,
+	ELF_SHT_NOTE		= 7,
+	ELF_SHT_NOBITS		= 8,
+	ELF_SHT_DYNSYM		= 11,
+
+	ELF_SHF_ALLOC		= 0x2,
+	ELF_SHF_EXECINSTR	= 0x4,
+	ELF_SHF_COMPRESSED	= 0x800,
+
+	ELF_SHN_UNDEF		= 0,
+	ELF_SHN_LORESERVE	= 0xff00,
+	ELF_SHN_XINDEX		= 0xffff,
+
+	ELF_STB_LOCAL		= 0,
+	ELF_STB_GLOBAL		= 1,
+	ELF_STB_WEAK		= 2,
+
+	ELF_STT_NOTYPE		= 0,
+	ELF_STT_FUNC		= 2,
+	ELF_STT_GNU_IFUNC	= 10,
+
+	ELF_NT_GNU_BUILD_ID	= 3,
+
+	ELF_COMPRESS_NONE	= 0,
+	ELF_COMPRESS_ZLIB	= 1,
+	ELF_COMPRESS_ZSTD	= 2,
+	ELF_COMPRESS_BAD	= 0xffffffff	// unknown type or malformed header, contents are unusable
+};
+
+ElfFile::ElfFile()
+	: m_memory(0)
+	, m_data(0)
+	, m_size(0)
+	, m_is64bit(false)
+	, m_bigEndian(false)
+{
+}
+
+ElfFile::~ElfFile()
+{
+	close();
+}
+
+bool ElfFile::load(const char* _path)
+{
+	close();
+
+	if (!m_file.open(_path))
+		return false;
+
+	m_data	= m_file.data();
+	m_size	= m_file.size();
+	return init();
+}
+
+bool ElfFile::loadMemory(uint8_t* _data, uint64_t _size)
+{
+	close();
+
+	m_memory	= _data;
+	m_data		= _data;
+	m_size		= _size;
+	return init();
+}
+
+bool ElfFile::init()
+{
+	const uint8_t* data = m_data;
+	if (!data || (m_size < 52) ||
+		(data[0] != 0x7f) || (data[1] != 'E') || (data[2] != 'L') || (data[3] != 'F') ||
+		((data[4] != ELF_CLASS32) && (data[4] != ELF_CLASS64)) ||
+		((data[5] != ELF_DATA2LSB) && (data[5] != ELF_DATA2MSB)))
+	{
+		close();
+		return false;
+	}
+
+	m_is64bit	= data[4] == ELF_CLASS64;
+	m_bigEndian	= data[5] == ELF_DATA2MSB;
+
+	if (!parseSections())
+	{
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void ElfFile::close()
+{
+	for (size_t i=0; i<m_buffers.size(); ++i)
+		rtm_free(m_buffers[i]);
+	m_buffers.clear();
+	m_contents.clear();
+	m_sections.clear();
+	m_file.close();
+
+	if (m_memory)
+		rtm_free(m_memory);
+	m_memory	= 0;
+	m_data		= 0;
+	m_size		= 0;
+}
+
+const ElfFile::Section* ElfFile::getSection(uint32_t _index) const
+{
+	if (_index >= m_sections.size())
+		return 0;
+	return &m_sections[_index];
+}
+
+const ElfFile::Section* ElfFile::findSection(const char* _name) const
+{
+	for (size_t i=0; i<m_sections.size(); ++i)
+		if (rtm::strCmp(m_sections[i].m_name, _name) == 0)
+			return &m_sections[i];
+	return 0;
+}
+
+const uint8_t* ElfFile::getSectionData(const Section* _section) const
+{
+	if (!_section || (_section->m_type == ELF_SHT_NOBITS))
+		return 0;
+	if (!inFile(_section->m_offset, _section->m_size))
+		return 0;
+	return m_data + _section->m_offset;
+}
+
+const ElfFile::Section* ElfFile::findDebugSection(const char* _name) const
+{
+	const Section* section = findSection(_name);
+	if (section || (rtm::strCmp(_name, ".debug_", 7) != 0))
+		return section;
+
+	char zname[256];
+	rtm::strlCpy(zname, RTM_NUM_ELEMENTS(zname), ".zdebug_");
+	rtm::strlCat(zname, RTM_NUM_ELEMENTS(zname), _name + 7);
+	return findSection(zname);
+}
+
+/// Size fields of corrupt or hostile images are checked against the best ratio the format can reach,
+/// 1032:1 for DEFLATE and 32768:1 for zstd (4 byte RLE block of 128 KB)
+static bool isPlausibleSize(uint32_t _type, uint64_t _srcSize, uint64_t _size)
+{
+	const uint64_t maxRatio = (_type == ELF_COMPRESS_ZSTD) ? 32768 : 1032;
+	return ((size_t)_size == _size) && (_size / maxRatio <= _srcSize);
+}
+
+uint32_t ElfFile::getCompression(const Section& _section, uint64_t& _headerSize, uint64_t& _size) const
+{
+	const uint8_t* data = getSectionData(&_section);
+	if (!data)
+		return ELF_COMPRESS_NONE;
+
+	// Elf32_Chdr / Elf64_Chdr: type, (reserved), uncompressed size, alignment
+	if (_section.m_flags & ELF_SHF_COMPRESSED)
+	{
+		_headerSize = m_is64bit ? 24 : 12;
+		if (_section.m_size < _headerSize)
+			return ELF_COMPRESS_BAD;
+
+		const uint32_t type = read32(data);
+		_size = m_is64bit ? read64(data + 8) : read32(data + 4);
+		if ((type != ELF_COMPRESS_ZLIB) && (type != ELF_COMPRESS_ZSTD))
+			return ELF_COMPRESS_BAD;
+		return isPlausibleSize(type, _section.m_size - _headerSize, _size) ? type : ELF_COMPRESS_BAD;
+	}
+
+	// legacy GNU format: "ZLIB" and big endian uncompressed size, regardless of the image byte order
+	if (rtm::strCmp(_section.m_name, ".zdebug_", 8) == 0)
+	{
+		_headerSize = 12;
+		if ((_section.m_size < _headerSize) || (memcmp(data, "ZLIB", 4) != 0))
+			return ELF_COMPRESS_BAD;
+
+		_size = 0;
+		for (uint32_t i=4; i<12; ++i)
+			_size = _size << 8 | data[i];
+		return isPlausibleSize(ELF_COMPRESS_ZLIB, _section.m_size - _headerSize, _size) ? (uint32_t)ELF_COMPRESS_ZLIB : (uint32_t)ELF_COMPRESS_BAD;
+	}
+
+	return ELF_COMPRESS_NONE;
+}
+
+const uint8_t* ElfFile::getSectionContents(const Section* _section, uint64_t& _size) const
+{
+	_size = 0;
+	if (!_section)
+		return 0;
+
+	uint64_t headerSize, size;
+	if (getCompression(*_section, headerSize, size) == ELF_COMPRESS_NONE)
+	{
+		const uint8_t* data = getSectionData(_section);
+		_size = data ? _section->m_size : 0;
+		return data;
+	}
+
+	decompressSections(&_section, 1);
+
+	std::lock_guard<std::mutex> lock(m_contentsLock);
+	const Contents& contents = m_contents[_section - &m_sections[0]];
+	_size = contents.m_data ? contents.m_size : 0;
+	return contents.m_data;
+}
+
+struct DecompressTask
+{
+	const DecompressChunk*	m_chunks;
+	uint8_t*				m_results;
+};
+
+static void decompressTask(uint32_t _task, void* _userData)
+{
+	DecompressTask* task = (DecompressTask*)_userData;
+	task->m_results[_task] = decompressChunk(task->m_chunks[_task]) ? 1 : 0;
+}
+
+void ElfFile::decompressSections(const Section* const* _sections, uint32_t _numSections) const
+{
+	std::vector<uint32_t> pending;
+	std::vector<uint32_t> waitFor;
+	std::vector<uint64_t> headerSizes;
+	std::vector<uint8_t*> buffers;
+
+	// sections are claimed under the lock and decoded outside of it, other users of the image aren't blocked
+	{
+		std::lock_guard<std::mutex> lock(m_contentsLock);
+		for (uint32_t i=0; i<_numSections; ++i)
+		{
+			if (!_sections[i])
+				continue;
+
+			const uint32_t index = (uint32_t)(_sections[i] - &m_sections[0]);
+			Contents& contents = m_contents[index];
+			if (contents.m_state == CONTENTS_DECODING)
+			{
+				if (std::find(pending.begin(), pending.end(), index) == pending.end())
+					waitFor.push_back(index);
+				continue;
+			}
+
+			if (contents.m_state == CONTENTS_DONE)
+				continue;
+
+			uint64_t headerSize, size;
+			const uint32_t type = getCompression(m_sections[index], headerSize, size);
+			if (type == ELF_COMPRESS_NONE)
+				continue;
+
+			contents.m_state = CONTENTS_DONE;
+			if ((type == ELF_COMPRESS_BAD) || (size == 0))
+				continue;
+
+			contents.m_state	= CONTENTS_DECODING;
+			contents.m_size		= size;
+			pending.push_back(index);
+			headerSizes.push_back(headerSize);
+		}
+	}
+
+	std::vector<DecompressChunk> chunks;
+	std::vector<uint32_t> chunkSections;
+	buffers.resize(pending.size(), 0);
+	for (size_t i=0; i<pending.size(); ++i)
+	{
+		const Section& section = m_sections[pending[i]];
+		const uint8_t* data = getSectionData(&section);
+		const uint8_t* src = data + headerSizes[i];
+		const uint64_t srcSize = section.m_size - headerSizes[i];
+		const uint64_t size = m_contents[pending[i]].m_size;	// not written by others while claimed
+
+		// buffer per section, one that fails to allocate doesn't take the others down; freed with the image
+		uint8_t* dst = (uint8_t*)rtm_alloc((size_t)size);
+		if (!dst)
+			continue;
+		buffers[i] = dst;
+
+		// zlib streams are sequential, zstd ones split into frames if the compressor wrote several
+		if ((section.m_flags & ELF_SHF_COMPRESSED) && (read32(data) == ELF_COMPRESS_ZSTD))
+			decompressSplitZstd(src, srcSize, dst, size, chunks);
+		else
+		{
+			DecompressChunk chunk = { src, srcSize, dst, size, false };
+			chunks.push_back(chunk);
+		}
+		chunkSections.resize(chunks.size(), (uint32_t)i);
+	}
+
+	// shared pool runs the chunks on the calling thread if it's busy, e.g. when called from a task
+	std::vector<uint8_t> results(chunks.size());
+	if (!chunks.empty())
+	{
+		DecompressTask task = { &chunks[0], &results[0] };
+		threadPoolGet()->run((uint32_t)chunks.size(), decompressTask, &task);
+	}
+
+	std::unique_lock<std::mutex> lock(m_contentsLock);
+	if (!pending.empty())
+	{
+		for (size_t i=0; i<chunks.size(); ++i)
+		{
+			if (!results[i] && buffers[chunkSections[i]])
+			{
+				rtm_free(buffers[chunkSections[i]]);
+				buffers[chunkSections[i]] = 0;
+			}
+		}
+
+		for (size_t i=0; i<pending.size(); ++i)
+		{
+			Contents& contents = m_contents[pending[i]];
+			contents.m_data		= buffers[i];
+			contents.m_state	= CONTENTS_DONE;
+			if (buffers[i])
+				m_buffers.push_back(buffers[i]);
+		}
+		m_contentsDone.notify_all();
+	}
+
+	for (size_t i=0; i<waitFor.size(); ++i)
+		while (m_contents[waitFor[i]].m_state != CONTENTS_DONE)
+			m_contentsDone.wait(lock);
+}
+
+uint16_t ElfFile::read16(const uint8_t* _ptr) const
+{
+	if (m_bigEndian)
+		return (uint16_t)((uint32_t)_ptr[0] << 8 | (uint32_t)_ptr[1]);
+	return (uint16_t)((uint32_t)_ptr[0] | (uint32_t)_ptr[1] << 8);
+}
+
+uint32_t ElfFile::read32(const uint8_t* _ptr) const
+{
+	if (m_bigEndian)
+		return (uint32_t)_ptr[0] << 24 | (uint32_t)_ptr[1] << 16 | (uint32_t)_ptr[2] << 8 | (uint32_t)_ptr[3];
+	return (uint32_t)_ptr[0] | (uint32_t)_ptr[1] << 8 | (uint32_t)_ptr[2] << 16 | (uint32_t)_ptr[3] << 24;
+}
+
+uint64_t ElfFile::read64(const uint8_t* _ptr) const
+{
+	if (m_bigEndian)
+		return (uint64_t)read32(_ptr) << 32 | (uint64_t)read32(_ptr + 4);
+	return (uint64_t)read32(_ptr) | (uint64_t)read32(_ptr + 4) << 32;
+}
+
+bool ElfFile::loadMiniDebugInfo(ElfFile& _elf) const
+{
+	const Section* section = findSection(".gnu_debugdata");
+	const uint8_t* data = getSectionData(section);
+	if (!data)
+		return false;
+
+	uint64_t size;
+	if (!decompressXzSize(data, section->m_size, size) || ((size_t)size != size) || (size < 52))
+		return false;
+
+	uint8_t* buffer = (uint8_t*)rtm_alloc((size_t)size);
+	if (!buffer)
+		return false;
+
+	if (!decompressXz(data, section->m_size, buffer, size))
+	{
+		rtm_free(buffer);
+		return false;
+	}
+
+	return _elf.loadMemory(buffer, size);
+}
+
+bool ElfFile::getBuildID(const uint8_t*& _id, uint32_t& _size) const
+{
+	for (size_t i=0; i<m_sections.size(); ++i)
+	{
+		if (m_sections[i].m_type != ELF_SHT_NOTE)
+			continue;
+
+		const uint8_t* data = getSectionData(&m_sections[i]);
+		if (!data)
+			continue;
+
+		// notes are name size, desc size, type, then name and desc each padded to 4 bytes
+		uint64_t pos = 0;
+		const uint64_t size = m_sections[i].m_size;
+		while (pos + 12 <= size)
+		{
+			const uint64_t nameSize	= read32(data + pos);
+			const uint64_t descSize	= read32(data + pos + 4);
+			const uint32_t type		= read32(data + pos + 8);
+			const uint64_t name		= pos + 12;
+			const uint64_t desc		= name + ((nameSize + 3) & ~3ull);
+			const uint64_t next		= desc + ((descSize + 3) & ~3ull);
+			if (next > size)
+				break;
+
+			if ((type == ELF_NT_GNU_BUILD_ID) && (nameSize == 4) && (rtm::strCmp((const char*)data + name, "GNU", 4) == 0) && descSize)
+			{
+				_id		= data + desc;
+				_size	= (uint32_t)descSize;
+				return true;
+			}
+
+			pos = next;
+		}
+	}
+	return false;
+}
+
+bool ElfFile::getDebugLink(const char*& _name, uint32_t& _crc) const
+{
+	const Section* section = findSection(".gnu_debuglink");
+	const uint8_t* data = getSectionData(section);
+	if (!data)
+		return false;
+
+	// null terminated file name, padded to 4 bytes, then CRC of the debug file
+	const uint8_t* end = (const uint8_t*)memchr(data, 0, (size_t)section->m_size);
+	if (!end || (end == data))
+		return false;
+
+	const uint64_t crcOffset = ((uint64_t)(end - data) + 4) & ~3ull;
+	if (crcOffset + 4 > section->m_size)
+		return false;
+
+	_name	= (const char*)data;
+	_crc	= read32(data + crcOffset);
+	return true;
+}
+
+bool ElfFile::inFile(uint64_t _offset, uint64_t _size) const
+{
+	return (_offset <= m_size) && (_size <= m_size - _offset);
+}
+
+bool ElfFile::parseSections()
+{
+	const uint8_t* data = m_data;
+
+	if (m_is64bit && (m_size < 64))
+		return false;
+
+	uint64_t shoff		= m_is64bit ? read64(data + 40) : read32(data + 32);
+	uint16_t shentsize	= read16(data + (m_is64bit ? 58 : 46));
+	uint32_t shnum		= read16(data + (m_is64bit ? 60 : 48));
+	uint32_t shstrndx	= read16(data + (m_is64bit ? 62 : 50));
+
+	if (shoff == 0)
+		return true;	// no section headers, valid but useless to us
+
+	const uint32_t minEntSize = m_is64bit ? 64 : 40;
+	if ((shentsize < minEntSize) || !inFile(shoff, shentsize))
+		return false;
+
+	// extended numbering, real values are stored in the first section header
+	const uint8_t* sh0 = data + shoff;
+	if (shnum == 0)
+		shnum = (uint32_t)(m_is64bit ? read64(sh0 + 32) : read32(sh0 + 20));
+	if (shstrndx == ELF_SHN_XINDEX)
+		shstrndx = read32(sh0 + (m_is64bit ? 40 : 24));
+
+	if (!inFile(shoff, (uint64_t)shnum * shentsize))
+		return false;
+
+	std::vector<uint32_t> nameOffsets(shnum);
+
+	m_sections.resize(shnum);
+	for (uint32_t i=0; i<shnum; ++i)
+	{
+		const uint8_t* sh = data + shoff + (uint64_t)i * shentsize;
+		Section& s = m_sections[i];
+
+		nameOffsets[i]	= read32(sh);
+		s.m_type		= read32(sh + 4);
+		if (m_is64bit)
+		{
+			s.m_flags	= read64(sh + 8);
+			s.m_addr	= read64(sh + 16);
+			s.m_offset	= read64(sh + 24);
+			s.m_size	= read64(sh + 32);
+			s.m_link	= read32(sh + 40);
+			s.m_info	= read32(sh + 44);
+			s.m_entSize	= read64(sh + 56);
+		}
+		else
+		{
+			s.m_flags	= read32(sh + 8);
+			s.m_addr	= read32(sh + 12);
+			s.m_offset	= read32(sh + 16);
+			s.m_size	= read32(sh + 20);
+			s.m_link	= read32(sh + 24);
+			s.m_info	= read32(sh + 28);
+			s.m_entSize	= read32(sh + 36);
+		}
+	}
+
+	const Section* strtab = shstrndx < shnum ? &m_sections[shstrndx] : 0;
+	const uint8_t* strData = getSectionData(strtab);
+
+	for (uint32_t i=0; i<shnum; ++i)
+	{
+		Section& s = m_sections[i];
+		if (strData && (nameOffsets[i] < strtab->m_size))
+			s.m_name = (const char*)strData + nameOffsets[i];
+		else
+			s.m_name = "";
+	}
+
+	const Contents none = { 0, 0, CONTENTS_UNUSED };
+	m_contents.assign(shnum, none);
+
+	return true;
+}
+
+struct DemangleBuffer
+{
+	char*		m_data;
+	uint32_t	m_size;
+	uint32_t	m_length;
+};
+
+static void demangleBufferCallback(const char* _data, size_t _len, void* _opaque)
+{
+	DemangleBuffer* buffer = (DemangleBuffer*)_opaque;
+	const uint32_t avail = buffer->m_size - buffer->m_length - 1;
+	const uint32_t len = _len < avail ? (uint32_t)_len : avail;
+	rtm::memCopy(&buffer->m_data[buffer->m_length], avail, _data, len);
+	buffer->m_length += len;
+	buffer->m_data[buffer->m_length] = '\0';
+}
+
+/// Demangles a symbol name the same way 'nm -C' does, as an Itanium C++ one unless it's a Rust symbol
+static const char* demangleSymbol(const char* _name, char* _buffer, uint32_t _bufferSize)
+{
+	// legacy Rust names parse as C++ too, but would keep their hash as the last scope
+	if (!isRustSymbol(_name))
+		return cxxDemangle(_name, _buffer, _bufferSize) ? _buffer : _name;
+
+	DemangleBuffer buffer = { _buffer, _bufferSize, 0 };
+	if (rust_demangle_with_callback(_name, 0, demangleBufferCallback, &buffer))
+		return _buffer;
+
+	return _name;
+}
+
+struct ElfSymbol
+{
+	uint64_t	m_value;
+	uint64_t	m_size;
+	const char*	m_name;
+};
+
+static inline bool sortElfSymbols(const ElfSymbol& _s1, const ElfSymbol& _s2)
+{
+	return _s1.m_value < _s2.m_value;
+}
+
+/// Collects function symbols from the first symbol table of the given type, names point into the image.
+/// Returns false if there is no such table.
+static bool collectSymbols(const ElfFile& _elf, uint32_t _type, std::vector<ElfSymbol>& _symbols)
+{
+	const ElfFile::Section* symtab = 0;
+	for (uint32_t i=0; i<_elf.getNumSections(); ++i)
+	{
+		if (_elf.getSection(i)->m_type == _type)
+		{
+			symtab = _elf.getSection(i);
+			break;
+		}
+	}
+
+	if (!symtab || (symtab->m_link >= _elf.getNumSections()))
+		return false;
+
+	const ElfFile::Section* strtab	= _elf.getSection(symtab->m_link);
+	const uint8_t* symData			= _elf.getSectionData(symtab);
+	const uint8_t* strData			= _elf.getSectionData(strtab);
+	const uint64_t entSize			= _elf.is64bit() ? 24 : 16;
+
+	if (!symData || !strData || (symtab->m_entSize && (symtab->m_entSize < entSize)))
+		return false;
+
+	const uint64_t stride	= symtab->m_entSize ? symtab->m_entSize : entSize;
+	const uint64_t numSyms	= symtab->m_size / stride;
+
+	_symbols.reserve(_symbols.size() + (size_t)numSyms);
+
+	for (uint64_t i=1; i<numSyms; ++i)	// entry 0 is always the undefined symbol
+	{
+		const uint8_t* sym = symData + i * stride;
+
+		uint32_t name;
+		uint8_t  info;
+		uint16_t shndx;
+		uint64_t value;
+		uint64_t size;
+
+		if (_elf.is64bit())
+		{
+			name	= _elf.read32(sym);
+			info	= sym[4];
+			shndx	= _elf.read16(sym + 6);
+			value	= _elf.read64(sym + 8);
+			size	= _elf.read64(sym + 16);
+		}
+		else
+		{
+			name	= _elf.read32(sym);
+			value	= _elf.read32(sym + 4);
+			size	= _elf.read32(sym + 8);
+			info	= sym[12];
+			shndx	= _elf.read16(sym + 14);
+		}
+
+		const uint8_t type = info & 0xf;
+		const uint8_t bind = info >> 4;
+
+		if ((type != ELF_STT_FUNC) && (type != ELF_STT_GNU_IFUNC) && (type != ELF_STT_NOTYPE))
+			continue;
+
+		if ((bind != ELF_STB_LOCAL) && (bind != ELF_STB_GLOBAL) && (bind != ELF_STB_WEAK))
+			continue;
+
+		// same filter as 't'/'T'/'W' in nm output: defined in an executable section
+		if ((shndx == ELF_SHN_UNDEF) || (shndx >= ELF_SHN_LORESERVE) || (shndx >= _elf.getNumSections()))
+			continue;
+
+		const ElfFile::Section& section = *_elf.getSection(shndx);
+		if ((section.m_flags & (ELF_SHF_ALLOC | ELF_SHF_EXECINSTR)) != (ELF_SHF_ALLOC | ELF_SHF_EXECINSTR))
+			continue;
+
+		if (name >= strtab->m_size)
+			continue;
+
+		const char* symName = (const char*)strData + name;
+
+		// skip unnamed, local labels and ARM/AArch64 mapping symbols ($a, $t, $x, $d)
+		if ((symName[0] == '\0') || (symName[0] == '$') || ((symName[0] == '.') && (symName[1] == 'L')))
+			continue;
+
+		ElfSymbol s;
+		s.m_value	= value;
+		s.m_size	= size;
+		s.m_name	= symName;
+		_symbols.push_back(s);
+	}
+
+	return true;
+}
+
+bool ElfFile::loadSymbols(SymbolMap& _symMap) const
+{
+	std::vector<ElfSymbol> symbols;
+
+	// names from MiniDebugInfo point into its image, keep it until they are added
+	ElfFile miniDebugInfo;
+	if (!collectSymbols(*this, ELF_SHT_SYMTAB, symbols))
+	{
+		// stripped image, MiniDebugInfo has only the functions missing from .dynsym
+		collectSymbols(*this, ELF_SHT_DYNSYM, symbols);
+		if (loadMiniDebugInfo(miniDebugInfo))
+			collectSymbols(miniDebugInfo, ELF_SHT_SYMTAB, symbols);
+	}
+
+	if (symbols.empty())
+		return false;
+
+	// feed symbols in address order so that aliases are merged by SymbolMap::addSymbol
+	std::stable_sort(symbols.begin(), symbols.end(), sortElfSymbols);
+
+	char demangled[16384];
+
+	for (size_t i=0; i<symbols.size(); ++i)
+	{
+		// don't let a zero sized alias (label) override the size of a real function
+		if (i && (symbols[i].m_value == symbols[i-1].m_value) && (symbols[i].m_size == 0))
+			continue;
+		_symMap.addSymbol(demangleSymbol(symbols[i].m_name, demangled, RTM_NUM_ELEMENTS(demangled)), (int64_t)symbols[i].m_value, symbols[i].m_size, 0, "");
+	}
+
+	_symMap.sort();
+	return true;
+}
+
+} // namespace rdebug
@@ -0,0 +1,124 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_RDEBUG_ELF_FILE_H
+#define RTM_RDEBUG_ELF_FILE_H
+
+#include <rdebug/src/mapped_file.h>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace rdebug {
+
+struct SymbolMap;
+
+/// Memory mapped (or in memory) ELF32/ELF64 image, both byte orders
+class ElfFile
+{
+	public:
+		struct Section
+		{
+			const char*	m_name;
+			uint32_t	m_type;
+			uint64_t	m_flags;
+			uint64_t	m_addr;
+			uint64_t	m_offset;
+			uint64_t	m_size;
+			uint32_t	m_link;
+			uint32_t	m_info;
+			uint64_t	m_entSize;
+		};
+
+	private:
+		enum
+		{
+			CONTENTS_UNUSED,
+			CONTENTS_DECODING,	// claimed by a thread that decodes it outside of the lock
+			CONTENTS_DONE
+		};
+
+		struct Contents
+		{
+			const uint8_t*	m_data;
+			uint64_t		m_size;
+			uint8_t			m_state;
+		};
+
+		MappedFile				m_file;
+		uint8_t*				m_memory;		// owned image, if it was loaded from memory
+		const uint8_t*			m_data;
+		uint64_t				m_size;
+		bool					m_is64bit;
+		bool					m_bigEndian;
+		std::vector<Section>	m_sections;
+
+		mutable std::mutex				m_contentsLock;
+		mutable std::condition_variable	m_contentsDone;
+		mutable std::vector<Contents>	m_contents;		// per section, decompressed on first use
+		mutable std::vector<uint8_t*>	m_buffers;		// one per decompressed section
+
+	public:
+		ElfFile();
+		~ElfFile();
+
+		bool			load(const char* _path);
+
+		/// Takes ownership of a buffer allocated with rtm_alloc, it's released even if loading fails
+		bool			loadMemory(uint8_t* _data, uint64_t _size);
+
+		void			close();
+		bool			isLoaded() const	{ return m_data != 0; }
+		bool			is64bit() const		{ return m_is64bit; }
+		bool			isBigEndian() const	{ return m_bigEndian; }
+
+		uint32_t		getNumSections() const	{ return (uint32_t)m_sections.size(); }
+		const Section*	getSection(uint32_t _index) const;
+		const Section*	findSection(const char* _name) const;
+		const uint8_t*	getSectionData(const Section* _section) const;
+
+		/// Finds a DWARF section by its .debug_* name, falls back to the GNU .zdebug_* variant
+		const Section*	findDebugSection(const char* _name) const;
+
+		/// Uncompressed section contents, SHF_COMPRESSED and .zdebug_* sections are decompressed on first
+		/// use and kept until the image is closed. Returns 0 if there is no data or it fails to decompress.
+		const uint8_t*	getSectionContents(const Section* _section, uint64_t& _size) const;
+
+		/// Decompresses sections that are compressed and weren't used yet, in parallel per section and per zstd frame.
+		/// Sections being decompressed by another thread are waited for.
+		void			decompressSections(const Section* const* _sections, uint32_t _numSections) const;
+
+		/// Fills symbol map with function symbols from .symtab, or from .dynsym and the MiniDebugInfo
+		/// .symtab if the image is stripped
+		bool			loadSymbols(SymbolMap& _symMap) const;
+
+		/// Decompresses the xz compressed MiniDebugInfo image from .gnu_debugdata, returns false if there is none
+		bool			loadMiniDebugInfo(ElfFile& _elf) const;
+
+		/// GNU build ID from the NT_GNU_BUILD_ID note, returns false if the image has none
+		bool			getBuildID(const uint8_t*& _id, uint32_t& _size) const;
+
+		/// Name and CRC32 of the separate debug file from .gnu_debuglink, returns false if the image has none
+		bool			getDebugLink(const char*& _name, uint32_t& _crc) const;
+
+		/// Whole image, for checksums
+		const uint8_t*	getData() const		{ return m_data; }
+		uint64_t		getSize() const		{ return m_size; }
+
+		uint16_t		read16(const uint8_t* _ptr) const;
+		uint32_t		read32(const uint8_t* _ptr) const;
+		uint64_t		read64(const uint8_t* _ptr) const;
+		uint64_t		readAddr(const uint8_t* _ptr) const	{ return m_is64bit ? read64(_ptr) : read32(_ptr); }
+
+	private:
+		bool			init();
+		bool			parseSections();
+		bool			inFile(uint64_t _offset, uint64_t _size) const;
+		uint32_t		getCompression(const Section& _section, uint64_t& _headerSize, uint64_t& _size) const;
+};
+
+} // namespace rdebug
+
+#endif // RTM_RDEBUG_ELF_FILE_H
@@ -0,0 +1,118 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <rdebug_pch.h>
+#include <rdebug/src/mapped_file.h>
+
+#if RTM_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // RTM_PLATFORM_WINDOWS
+
+namespace rdebug {
+
+MappedFile::MappedFile()
+	: m_data(0)
+	, m_size(0)
+#if RTM_PLATFORM_WINDOWS
+	, m_file(INVALID_HANDLE_VALUE)
+	, m_mapping(0)
+#endif // RTM_PLATFORM_WINDOWS
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const char* _path)
+{
+	close();
+
+	if (!_path || (_path[0] == '\0'))
+		return false;
+
+#if RTM_PLATFORM_WINDOWS
+	HANDLE file = CreateFileW(rtm::MultiToWide(_path), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || (size.QuadPart == 0))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mapping)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!data)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_file		= file;
+	m_mapping	= mapping;
+	m_data		= (const uint8_t*)data;
+	m_size		= (uint64_t)size.QuadPart;
+#else
+	int fd = ::open(_path, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || (st.st_size == 0))
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* data = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);	// mapping keeps its own reference to the file
+
+	if (data == MAP_FAILED)
+		return false;
+
+	m_data	= (const uint8_t*)data;
+	m_size	= (uint64_t)st.st_size;
+#endif // RTM_PLATFORM_WINDOWS
+
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (!m_data)
+		return;
+
+#if RTM_PLATFORM_WINDOWS
+	UnmapViewOfFile(m_data);
+	CloseHandle((HANDLE)m_mapping);
+	CloseHandle((HANDLE)m_file);
+	m_file		= INVALID_HANDLE_VALUE;
+	m_mapping	= 0;
+#else
+	munmap((void*)m_data, (size_t)m_size);
+#endif // RTM_PLATFORM_WINDOWS
+
+	m_data	= 0;
+	m_size	= 0;
+}
+
+} // namespace rdebug
@@ -0,0 +1,42 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_RDEBUG_MAPPED_FILE_H
+#define RTM_RDEBUG_MAPPED_FILE_H
+
+#include <rbase/inc/platform.h>
+
+namespace rdebug {
+
+/// Read-only memory mapped view of a whole file
+class MappedFile
+{
+	private:
+		const uint8_t*	m_data;
+		uint64_t		m_size;
+#if RTM_PLATFORM_WINDOWS
+		void*			m_file;
+		void*			m_mapping;
+#endif // RTM_PLATFORM_WINDOWS
+
+	public:
+		MappedFile();
+		~MappedFile();
+
+		bool			open(const char* _path);
+		void			close();
+
+		bool			isOpen() const	{ return m_data != 0; }
+		const uint8_t*	data() const	{ return m_data; }
+		uint64_t		size() const	{ return m_size; }
+
+	private:
+		MappedFile(const MappedFile&);
+		MappedFile& operator = (const MappedFile&);
+};
+
+} // namespace rdebug
+
+#endif // RTM_RDEBUG_MAPPED_FILE_H
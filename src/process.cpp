@@ -4,12 +4,31 @@
 //--------------------------------------------------------------------------//
 
 #include <rdebug_pch.h>
+#include <rdebug/src/process.h>
 
 #include <rbase/inc/path.h>
 
 #if RTM_PLATFORM_WINDOWS
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#include <mutex>
+#else
+#include <spawn.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include <mutex>
+extern char** environ;
+
+#if RTM_PLATFORM_LINUX || RTM_PLATFORM_ANDROID || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+#define RDEBUG_PROCESS_PIPE2	1
+#else
+#define RDEBUG_PROCESS_PIPE2	0
+#endif
 #endif // RTM_PLATFORM_WINDOWS
 
 namespace rdebug {
@@ -198,6 +217,30 @@ struct PipeHandles
 	}
 };
 
+/// Pipes are created non-inheritable, every spawn with inherited handles goes through this lock
+static std::mutex s_spawnLock;
+
+/// Creates the process with inherited handles, standard input and output from the startup info are made
+/// inheritable just for the call. Concurrent spawns don't pick up each other's pipe ends, a write end held
+/// by another child would keep the reader from ever seeing the end of output.
+static BOOL spawnProcess(wchar_t* _cmdLine, STARTUPINFOW* _startInfo, PROCESS_INFORMATION* _procInfo)
+{
+	HANDLE handles[2] = { _startInfo->hStdInput, _startInfo->hStdOutput };
+
+	std::lock_guard<std::mutex> lock(s_spawnLock);
+	for (uint32_t i=0; i<RTM_NUM_ELEMENTS(handles); ++i)
+		if (handles[i])
+			SetHandleInformation(handles[i], HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT);
+
+	BOOL success = CreateProcessW(NULL, _cmdLine, NULL, NULL, TRUE, 0, NULL, NULL, _startInfo, _procInfo);
+
+	for (uint32_t i=0; i<RTM_NUM_ELEMENTS(handles); ++i)
+		if (handles[i])
+			SetHandleInformation(handles[i], HANDLE_FLAG_INHERIT, 0);
+
+	return success;
+}
+
 BOOL createChildProcess(const char* _cmdLine, PipeHandles* _handles, bool _redirectIO, std::string& _buffer)
 {
 	PROCESS_INFORMATION piProcInfo; 
@@ -220,7 +263,7 @@ BOOL createChildProcess(const char* _cmdLine, PipeHandles* _handles, bool _redir
 		siStartInfo.dwFlags		= STARTF_USESTDHANDLES;
 
 	rtm::MultiToWide cmdLine(_cmdLine, false);
-	bSuccess = CreateProcessW(NULL, cmdLine.m_ptr, NULL, NULL, TRUE, 0, NULL, NULL, &siStartInfo, &piProcInfo);  
+	bSuccess = spawnProcess(cmdLine.m_ptr, &siStartInfo, &piProcInfo);
 
 	if (bSuccess) 
 	{
@@ -259,21 +302,9 @@ BOOL createChildProcess(const char* _cmdLine, PipeHandles* _handles, bool _redir
 
 void CreatePipes(PipeHandles* _handles)
 {
-	SECURITY_ATTRIBUTES saAttr; 
- 
-	saAttr.nLength				= sizeof(SECURITY_ATTRIBUTES); 
-	saAttr.bInheritHandle		= TRUE;
-	saAttr.lpSecurityDescriptor	= NULL; 
-
-	CreatePipe(&_handles->m_stdOut_Read, &_handles->m_stdOut_Write, &saAttr, g_bufferSize);
-	SetHandleInformation(_handles->m_stdOut_Read, HANDLE_FLAG_INHERIT, 0);
-
-	saAttr.nLength				= sizeof(SECURITY_ATTRIBUTES); 
-	saAttr.bInheritHandle		= TRUE;
-	saAttr.lpSecurityDescriptor	= NULL; 
-
-	CreatePipe(&_handles->m_stdIn_Read, &_handles->m_stdIn_Write, &saAttr, g_bufferSize);
-	SetHandleInformation(_handles->m_stdIn_Write, HANDLE_FLAG_INHERIT, 0);
+	// none of the ends is inheritable, spawnProcess hands the child ones over
+	CreatePipe(&_handles->m_stdOut_Read, &_handles->m_stdOut_Write, NULL, g_bufferSize);
+	CreatePipe(&_handles->m_stdIn_Read, &_handles->m_stdIn_Write, NULL, g_bufferSize);
 }
 
 DWORD ReadFromPipe(std::string& _buffer, PipeHandles* _handles)
@@ -301,6 +332,52 @@ DWORD ReadFromPipe(std::string& _buffer, PipeHandles* _handles)
 	return retDwRead;
 } 
 
+bool processReadOutputOf(const char* _cmdLine, Coprocess::fnOnOutput _onOutput, void* _userData, bool _redirectIO)
+{
+	PipeHandles handles;
+	CreatePipes(&handles);
+
+	PROCESS_INFORMATION piProcInfo;
+	STARTUPINFOW siStartInfo;
+	ZeroMemory( &piProcInfo, sizeof(PROCESS_INFORMATION) );
+	ZeroMemory( &siStartInfo, sizeof(STARTUPINFOW) );
+	siStartInfo.cb			= sizeof(STARTUPINFOW);
+	siStartInfo.hStdError	= _redirectIO ? handles.m_stdOut_Write : GetStdHandle(STD_ERROR_HANDLE);
+	siStartInfo.hStdOutput	= handles.m_stdOut_Write;
+	siStartInfo.hStdInput	= handles.m_stdIn_Read;
+	siStartInfo.dwFlags		= STARTF_USESTDHANDLES | STARTF_USESHOWWINDOW;
+	siStartInfo.wShowWindow	= SW_HIDE;
+
+	rtm::MultiToWide cmdLine(_cmdLine, false);
+	if (!spawnProcess(cmdLine.m_ptr, &siStartInfo, &piProcInfo))
+		return false;
+
+	// with our copy of the write end closed, reading fails once the process is done and its copy is gone
+	CloseHandle(handles.m_stdOut_Write);
+	handles.m_stdOut_Write = NULL;
+
+	char* buffer = (char*)rtm_alloc(g_bufferSize);
+	for (;;)
+	{
+		DWORD dwRead = 0;
+		if (!ReadFile(handles.m_stdOut_Read, buffer, g_bufferSize, &dwRead, NULL) || (dwRead == 0))
+			break;
+
+		if (_onOutput(buffer, (uint32_t)dwRead, _userData))
+			break;
+	}
+	rtm_free(buffer);
+
+	// if reading stopped early the process fails its next write and exits
+	CloseHandle(handles.m_stdOut_Read);
+	handles.m_stdOut_Read = NULL;
+
+	WaitForSingleObject(piProcInfo.hProcess, INFINITE);
+	CloseHandle(piProcInfo.hThread);
+	CloseHandle(piProcInfo.hProcess);
+	return true;
+}
+
 bool processGetOutputOf(const char* _cmdLine, std::string& _buffer, bool _redirect)
 {
 	PipeHandles handles;
@@ -328,6 +405,140 @@ char* processGetOutputOf(const char* _cmdLine, bool _redirectIO)
 	return 0;
 }
 
+Coprocess::Coprocess()
+	: m_process(0)
+	, m_stdIn(0)
+	, m_stdInRead(0)
+	, m_stdOut(0)
+{
+}
+
+Coprocess::~Coprocess()
+{
+	stop();
+}
+
+bool Coprocess::start(const char* _cmdLine)
+{
+	stop();
+
+	// none of the ends is inheritable, spawnProcess hands the child ones over
+	HANDLE stdInRead, stdInWrite, stdOutRead, stdOutWrite;
+	if (!CreatePipe(&stdOutRead, &stdOutWrite, NULL, g_bufferSize))
+		return false;
+
+	if (!CreatePipe(&stdInRead, &stdInWrite, NULL, g_bufferSize))
+	{
+		CloseHandle(stdOutRead);
+		CloseHandle(stdOutWrite);
+		return false;
+	}
+
+	PROCESS_INFORMATION piProcInfo; 
+	STARTUPINFOW siStartInfo;
+	ZeroMemory( &piProcInfo, sizeof(PROCESS_INFORMATION) );
+	ZeroMemory( &siStartInfo, sizeof(STARTUPINFOW) );
+	siStartInfo.cb			= sizeof(STARTUPINFOW);
+	siStartInfo.hStdError	= GetStdHandle(STD_ERROR_HANDLE);
+	siStartInfo.hStdOutput	= stdOutWrite;
+	siStartInfo.hStdInput	= stdInRead;
+	siStartInfo.dwFlags		= STARTF_USESTDHANDLES | STARTF_USESHOWWINDOW;
+	siStartInfo.wShowWindow	= SW_HIDE;
+
+	rtm::MultiToWide cmdLine(_cmdLine, false);
+	BOOL success = spawnProcess(cmdLine.m_ptr, &siStartInfo, &piProcInfo);
+
+	// child process has its own copies now, read end of stdin is kept only to peek at queued input
+	CloseHandle(stdOutWrite);
+
+	if (!success)
+	{
+		CloseHandle(stdInRead);
+		CloseHandle(stdInWrite);
+		CloseHandle(stdOutRead);
+		return false;
+	}
+
+	CloseHandle(piProcInfo.hThread);
+
+	m_process	= piProcInfo.hProcess;
+	m_stdIn		= stdInWrite;
+	m_stdInRead	= stdInRead;
+	m_stdOut	= stdOutRead;
+	return true;
+}
+
+void Coprocess::stop()
+{
+	if (!m_process)
+		return;
+
+	// closing stdin makes the process exit on its own
+	CloseHandle((HANDLE)m_stdIn);
+	if (WaitForSingleObject((HANDLE)m_process, 1000) == WAIT_TIMEOUT)
+		TerminateProcess((HANDLE)m_process, 0);
+
+	CloseHandle((HANDLE)m_stdInRead);
+	CloseHandle((HANDLE)m_stdOut);
+	CloseHandle((HANDLE)m_process);
+
+	m_process	= 0;
+	m_stdIn		= 0;
+	m_stdInRead	= 0;
+	m_stdOut	= 0;
+}
+
+bool Coprocess::isRunning() const
+{
+	return m_process != 0;
+}
+
+bool Coprocess::transact(const char* _input, uint32_t _inputSize, fnOnOutput _onOutput, void* _userData)
+{
+	if (!m_process)
+		return false;
+
+	// anonymous pipes can't do overlapped I/O, so stdout is drained before every write and no write
+	// is larger than the free space in stdin, neither side ever blocks on a full pipe. Half of the
+	// requested size is used as pipe capacity, the system may round it
+	const DWORD inputCapacity = g_bufferSize / 2;
+
+	char buffer[16 * 1024];
+	uint32_t written = 0;
+	for (;;)
+	{
+		DWORD bytesAvailable = 0;
+		if (!PeekNamedPipe((HANDLE)m_stdOut, NULL, 0, NULL, &bytesAvailable, NULL))
+			return false;
+
+		if (!bytesAvailable && (written < _inputSize))
+		{
+			DWORD queued = 0;
+			if (!PeekNamedPipe((HANDLE)m_stdInRead, NULL, 0, NULL, &queued, NULL))
+				return false;
+
+			if (queued < inputCapacity)
+			{
+				DWORD numWritten = 0;
+				DWORD toWrite = inputCapacity - queued;
+				if (toWrite > _inputSize - written)
+					toWrite = _inputSize - written;
+				if (!WriteFile((HANDLE)m_stdIn, &_input[written], toWrite, &numWritten, NULL))
+					return false;
+				written += numWritten;
+				continue;
+			}
+		}
+
+		// output is pending, or the process has all the input or a full pipe of requests to answer
+		DWORD numRead = 0;
+		if (!ReadFile((HANDLE)m_stdOut, buffer, sizeof(buffer), &numRead, NULL) || (numRead == 0))
+			return false;
+		if (_onOutput(buffer, numRead, _userData))
+			return true;
+	}
+}
+
 #else // RTM_PLATFORM_WINDOWS
 
 bool processIs64bitBinary(const char* _path)
@@ -345,19 +556,411 @@ bool processInjectDLL(const char* _executablePath, const char* _DLLPath, const c
 	return false;
 }
 
+const uint32_t g_bufferSize	= 64 * 4096;
+const uint32_t g_maxArgs	= 256;
+
+/// Splits command line into arguments in place, quotes are handled the same way a shell would
+static uint32_t splitCmdLine(char* _cmdLine, char** _argv, uint32_t _maxArgs)
+{
+	uint32_t numArgs = 0;
+	char* src = _cmdLine;
+	char* dst = _cmdLine;
+
+	while (*src)
+	{
+		while ((*src == ' ') || (*src == '\t') || (*src == '\r') || (*src == '\n'))
+			++src;
+
+		if (!*src)
+			break;
+
+		if (numArgs == _maxArgs - 1)
+			break;
+
+		_argv[numArgs++] = dst;
+
+		char quote = 0;
+		while (*src)
+		{
+			char c = *src++;
+			if (quote)
+			{
+				if (c == quote)
+					quote = 0;
+				else
+				if ((c == '\\') && (quote == '"') && ((*src == '"') || (*src == '\\')))
+					*dst++ = *src++;
+				else
+					*dst++ = c;
+			}
+			else
+			{
+				if ((c == '"') || (c == '\''))
+					quote = c;
+				else
+				if ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n'))
+					break;
+				else
+					*dst++ = c;
+			}
+		}
+		*dst++ = '\0';
+	}
+
+	_argv[numArgs] = 0;
+	return numArgs;
+}
+
+#if !RDEBUG_PROCESS_PIPE2
+/// Held from pipe creation until spawn, pipes are inheritable until FD_CLOEXEC is set
+static std::mutex s_spawnLock;
+#endif
+
+static bool createPipe(int _fds[2], int _nonBlockingEnd)
+{
+#if RDEBUG_PROCESS_PIPE2
+	if (pipe2(_fds, O_CLOEXEC) != 0)
+		return false;
+#else
+	if (pipe(_fds) != 0)
+		return false;
+
+	fcntl(_fds[0], F_SETFD, FD_CLOEXEC);
+	fcntl(_fds[1], F_SETFD, FD_CLOEXEC);
+#endif
+	fcntl(_fds[_nonBlockingEnd], F_SETFL, fcntl(_fds[_nonBlockingEnd], F_GETFL) | O_NONBLOCK);
+	return true;
+}
+
+/// Spawns a process, if _stdIn or _stdOut are given then input or output of the process are redirected to non-blocking pipes
+static pid_t spawnProcess(const char* _cmdLine, int* _stdIn, int* _stdOut, bool _redirectIO)
+{
+	uint32_t len = rtm::strLen(_cmdLine);
+	char* cmdLine = (char*)rtm_alloc(len + 1);
+	rtm::strlCpy(cmdLine, len + 1, _cmdLine);
+
+	char* argv[g_maxArgs];
+	if (splitCmdLine(cmdLine, argv, g_maxArgs) == 0)
+	{
+		rtm_free(cmdLine);
+		return -1;
+	}
+
+#if !RDEBUG_PROCESS_PIPE2
+	std::lock_guard<std::mutex> lock(s_spawnLock);
+#endif
+
+	int inFds[2]	= { -1, -1 };
+	int outFds[2]	= { -1, -1 };
+	if ((_stdIn && !createPipe(inFds, 1)) ||
+		(_stdOut && !createPipe(outFds, 0)))
+	{
+		if (inFds[0] != -1)
+		{
+			close(inFds[0]);
+			close(inFds[1]);
+		}
+		rtm_free(cmdLine);
+		return -1;
+	}
+
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	if (_stdIn)
+		posix_spawn_file_actions_adddup2(&actions, inFds[0], STDIN_FILENO);
+	else
+		posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+
+	if (_stdOut)
+	{
+		posix_spawn_file_actions_adddup2(&actions, outFds[1], STDOUT_FILENO);
+		if (_redirectIO)
+			posix_spawn_file_actions_adddup2(&actions, outFds[1], STDERR_FILENO);
+	}
+
+	pid_t pid = -1;
+	if (posix_spawnp(&pid, argv[0], &actions, 0, argv, environ) != 0)
+		pid = -1;
+
+	posix_spawn_file_actions_destroy(&actions);
+	rtm_free(cmdLine);
+
+	if (_stdIn)
+	{
+		close(inFds[0]);
+		if (pid == -1)
+			close(inFds[1]);
+		else
+			*_stdIn = inFds[1];
+	}
+
+	if (_stdOut)
+	{
+		close(outFds[1]);
+		if (pid == -1)
+			close(outFds[0]);
+		else
+			*_stdOut = outFds[0];
+	}
+
+	return pid;
+}
+
+static int waitProcess(pid_t _pid)
+{
+	int status = 0;
+	while (waitpid(_pid, &status, 0) == -1)
+	{
+		if (errno != EINTR)
+			return -1;
+	}
+
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/// Waits for a process to exit for at most _timeoutMs milliseconds, returns false on timeout
+static bool waitProcess(pid_t _pid, uint32_t _timeoutMs)
+{
+	const uint32_t pollMs = 10;
+	for (uint32_t waited=0; ; waited += pollMs)
+	{
+		int status = 0;
+		pid_t ret = waitpid(_pid, &status, WNOHANG);
+		if (ret == _pid)
+			return true;
+
+		if ((ret == -1) && (errno != EINTR))
+			return true;	// already reaped
+
+		if (waited >= _timeoutMs)
+			return false;
+
+		if (ret == 0)
+			usleep(pollMs * 1000);
+	}
+}
+
 bool processRun(const char* _cmdLine, bool _hideWindow, uint32_t* _exitCode)
 {
-	RTM_UNUSED(_cmdLine);
 	RTM_UNUSED(_hideWindow);
-	RTM_UNUSED(_exitCode);
+
+	pid_t pid = spawnProcess(_cmdLine, 0, 0, false);
+	if (pid == -1)
+		return false;
+
+	int exitCode = waitProcess(pid);
+
+	if (_exitCode)
+		*_exitCode = (uint32_t)exitCode;
+
+	return true;
+}
+
+bool processReadOutputOf(const char* _cmdLine, Coprocess::fnOnOutput _onOutput, void* _userData, bool _redirectIO)
+{
+	int stdOut = -1;
+	pid_t pid = spawnProcess(_cmdLine, 0, &stdOut, _redirectIO);
+	if (pid == -1)
+		return false;
+
+	char* buffer = (char*)rtm_alloc(g_bufferSize);
+
+	pollfd pfd;
+	pfd.fd		= stdOut;
+	pfd.events	= POLLIN;
+
+	for (;;)
+	{
+		pfd.revents = 0;
+		int ret = poll(&pfd, 1, -1);
+		if (ret < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		ssize_t numRead = read(stdOut, buffer, g_bufferSize);
+		if (numRead > 0)
+		{
+			if (_onOutput(buffer, (uint32_t)numRead, _userData))
+				break;
+			continue;
+		}
+
+		if ((numRead < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)))
+			continue;
+
+		break;	// end of output
+	}
+
+	rtm_free(buffer);
+
+	// if reading stopped early the process gets SIGPIPE on its next write
+	close(stdOut);
+	waitProcess(pid);
+	return true;
+}
+
+struct OutputBuffer
+{
+	char*		m_data;
+	uint32_t	m_size;
+	uint32_t	m_capacity;
+};
+
+static bool outputBufferAppend(const char* _data, uint32_t _size, void* _userData)
+{
+	OutputBuffer* output = (OutputBuffer*)_userData;
+	if (output->m_size + _size > output->m_capacity)
+	{
+		while (output->m_size + _size > output->m_capacity)
+			output->m_capacity *= 2;
+		output->m_data = (char*)rtm_realloc(output->m_data, output->m_capacity + 1);
+	}
+
+	memcpy(&output->m_data[output->m_size], _data, _size);
+	output->m_size += _size;
 	return false;
 }
 
 char* processGetOutputOf(const char* _cmdLine, bool _redirectIO)
 {
-	RTM_UNUSED(_cmdLine);
-	RTM_UNUSED(_redirectIO);
-	return 0;
+	// output is gathered straight into the returned buffer, grown as needed
+	OutputBuffer output;
+	output.m_capacity	= g_bufferSize;
+	output.m_size		= 0;
+	output.m_data		= (char*)rtm_alloc(output.m_capacity + 1);
+
+	if (!processReadOutputOf(_cmdLine, outputBufferAppend, &output, _redirectIO) || (output.m_size == 0))
+	{
+		rtm_free(output.m_data);
+		return 0;
+	}
+
+	output.m_data[output.m_size] = '\0';
+	return output.m_data;
+}
+
+Coprocess::Coprocess()
+	: m_pid(-1)
+	, m_stdIn(-1)
+	, m_stdOut(-1)
+{
+}
+
+Coprocess::~Coprocess()
+{
+	stop();
+}
+
+bool Coprocess::start(const char* _cmdLine)
+{
+	stop();
+
+	pid_t pid = spawnProcess(_cmdLine, &m_stdIn, &m_stdOut, false);
+	if (pid == -1)
+		return false;
+
+#if defined(F_SETNOSIGPIPE)
+	fcntl(m_stdIn, F_SETNOSIGPIPE, 1);
+#endif
+
+	m_pid = pid;
+	return true;
+}
+
+void Coprocess::stop()
+{
+	if (m_pid == -1)
+		return;
+
+	// closing stdin makes the process exit on its own, one that doesn't is killed after a second
+	close(m_stdIn);
+	close(m_stdOut);
+	if (!waitProcess(m_pid, 1000))
+	{
+		kill(m_pid, SIGKILL);
+		waitProcess(m_pid);
+	}
+
+	m_pid		= -1;
+	m_stdIn		= -1;
+	m_stdOut	= -1;
+}
+
+bool Coprocess::isRunning() const
+{
+	return m_pid != -1;
+}
+
+bool Coprocess::transact(const char* _input, uint32_t _inputSize, fnOnOutput _onOutput, void* _userData)
+{
+	if (m_pid == -1)
+		return false;
+
+#if !defined(F_SETNOSIGPIPE)
+	// writing to a process that went away raises SIGPIPE, keep it blocked so that it doesn't terminate the host
+	sigset_t sigPipe, oldMask;
+	sigemptyset(&sigPipe);
+	sigaddset(&sigPipe, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &sigPipe, &oldMask);
+#endif
+
+	char buffer[16 * 1024];
+	uint32_t written = 0;
+	bool done	= false;
+	bool failed	= false;
+	while (!done && !failed)
+	{
+		pollfd pfd[2];
+		pfd[0].fd		= m_stdOut;
+		pfd[0].events	= POLLIN;
+		pfd[0].revents	= 0;
+		pfd[1].fd		= m_stdIn;
+		pfd[1].events	= POLLOUT;
+		pfd[1].revents	= 0;
+
+		const nfds_t numFds = (written < _inputSize) ? 2 : 1;
+		if (poll(pfd, numFds, -1) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			failed = true;
+			break;
+		}
+
+		if ((numFds == 2) && pfd[1].revents)
+		{
+			ssize_t numWritten = write(m_stdIn, &_input[written], _inputSize - written);
+			if (numWritten > 0)
+				written += (uint32_t)numWritten;
+			else
+			if ((numWritten < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+				failed = true;
+		}
+
+		if (pfd[0].revents)
+		{
+			ssize_t numRead = read(m_stdOut, buffer, sizeof(buffer));
+			if (numRead > 0)
+				done = _onOutput(buffer, (uint32_t)numRead, _userData);
+			else
+			if ((numRead == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)))
+				failed = true;
+		}
+	}
+
+#if !defined(F_SETNOSIGPIPE)
+	if (failed)
+	{
+		struct timespec zero = { 0, 0 };
+		while (sigtimedwait(&sigPipe, 0, &zero) > 0) {}
+	}
+	pthread_sigmask(SIG_SETMASK, &oldMask, 0);
+#endif
+
+	return !failed;
 }
 
 #endif // RTM_PLATFORM_WINDOWS
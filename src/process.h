@@ -0,0 +1,56 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_RDEBUG_PROCESS_H
+#define RTM_RDEBUG_PROCESS_H
+
+#include <rbase/inc/platform.h>
+
+namespace rdebug {
+
+/// Long running child process that reads requests on stdin and writes answers to stdout
+class Coprocess
+{
+	public:
+		/// Called for every chunk of output read, returns true once all the expected output has arrived
+		typedef bool (*fnOnOutput)(const char* _data, uint32_t _size, void* _userData);
+
+	private:
+#if RTM_PLATFORM_WINDOWS
+		void*		m_process;
+		void*		m_stdIn;
+		void*		m_stdInRead;	// read end of stdin, to see how much input is still queued
+		void*		m_stdOut;
+#else
+		int			m_pid;
+		int			m_stdIn;
+		int			m_stdOut;
+#endif // RTM_PLATFORM_WINDOWS
+
+	public:
+		Coprocess();
+		~Coprocess();
+
+		bool		start(const char* _cmdLine);
+		void		stop();
+		bool		isRunning() const;
+
+		/// Writes the whole input while reading output at the same time, so that requests are pipelined
+		/// and neither side stalls on a full pipe. Returns false if the process went away before answering.
+		bool		transact(const char* _input, uint32_t _inputSize, fnOnOutput _onOutput, void* _userData);
+
+	private:
+		Coprocess(const Coprocess&);
+		Coprocess& operator = (const Coprocess&);
+};
+
+/// Runs a process to completion and hands its output over in chunks as it's read, so that output of
+/// any length is processed in bounded memory. Returning true from _onOutput stops reading early.
+/// Returns false if the process couldn't be started.
+bool processReadOutputOf(const char* _cmdLine, Coprocess::fnOnOutput _onOutput, void* _userData, bool _redirectIO = false);
+
+} // namespace rdebug
+
+#endif // RTM_RDEBUG_PROCESS_H
@@ -4,6 +4,7 @@
 //--------------------------------------------------------------------------//
 
 #include <rdebug_pch.h>
+#include <rdebug/src/thread_pool.h>
 
 #define RTM_LIBHANDLER_DEFINE
 #include <rbase/inc/libhandler.h>
@@ -27,5 +28,6 @@ namespace rdebug {
 
 	void shutDown()
 	{
+		threadPoolShutDown();
 	}
 }
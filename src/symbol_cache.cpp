@@ -0,0 +1,270 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <rdebug_pch.h>
+#include <rdebug/src/symbol_cache.h>
+#include <rdebug/src/elf_file.h>
+#include <rbase/inc/hash.h>
+
+#include <atomic>
+#include <stdio.h>
+
+#if RTM_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // RTM_PLATFORM_WINDOWS
+
+namespace rdebug {
+
+enum
+{
+	CACHE_MAGIC		= 0x43534452,	// 'RDSC'
+	CACHE_VERSION	= 2,
+	CACHE_BYTEORDER	= 0x01020304
+};
+
+/// File starts with the header, arrays follow in the order of CacheLayout, each 8 byte aligned. Search offsets are
+/// 64 byte aligned like the ones SymbolMap builds, mapped files start on a page boundary.
+struct CacheHeader
+{
+	uint32_t	m_magic;
+	uint32_t	m_version;
+	uint32_t	m_byteOrder;
+	uint32_t	m_symbolSize;
+	uint32_t	m_rowSize;
+	uint32_t	m_numSymbols;
+	uint32_t	m_stringsSize;
+	uint32_t	m_numRows;
+	uint32_t	m_numFiles;
+	uint32_t	m_filePathsSize;
+};
+
+struct CacheLayout
+{
+	uint64_t	m_symbols;
+	uint64_t	m_searchOffsets;
+	uint64_t	m_searchIndex;
+	uint64_t	m_strings;
+	uint64_t	m_rows;
+	uint64_t	m_fileOffsets;
+	uint64_t	m_filePaths;
+	uint64_t	m_end;
+};
+
+static inline uint64_t align8(uint64_t _offset)
+{
+	return (_offset + 7) & ~7ull;
+}
+
+static inline uint64_t align64(uint64_t _offset)
+{
+	return (_offset + 63) & ~63ull;
+}
+
+static void cacheGetLayout(const CacheHeader& _header, CacheLayout& _layout)
+{
+	// counts are 32bit, so none of this can overflow
+	_layout.m_symbols		= align8(sizeof(CacheHeader));
+	_layout.m_searchOffsets	= align64(_layout.m_symbols			+ (uint64_t)_header.m_numSymbols * sizeof(SymbolMap::SymbolData));
+	_layout.m_searchIndex	= align8(_layout.m_searchOffsets	+ ((uint64_t)_header.m_numSymbols + 1) * sizeof(int64_t));
+	_layout.m_strings		= align8(_layout.m_searchIndex		+ ((uint64_t)_header.m_numSymbols + 1) * sizeof(uint32_t));
+	_layout.m_rows			= align8(_layout.m_strings			+ _header.m_stringsSize);
+	_layout.m_fileOffsets	= align8(_layout.m_rows				+ (uint64_t)_header.m_numRows * sizeof(DwarfLineTable::Row));
+	_layout.m_filePaths		= align8(_layout.m_fileOffsets		+ (uint64_t)_header.m_numFiles * sizeof(uint32_t));
+	_layout.m_end			= _layout.m_filePaths				+ _header.m_filePathsSize;
+}
+
+static bool cacheWrite(FILE* _file, uint64_t& _pos, uint64_t _offset, const void* _data, uint64_t _size)
+{
+	static const uint8_t padding[64] = { 0 };
+	if ((_offset > _pos) && (fwrite(padding, 1, (size_t)(_offset - _pos), _file) != _offset - _pos))
+		return false;
+
+	_pos = _offset + _size;
+	return !_size || (fwrite(_data, 1, (size_t)_size, _file) == _size);
+}
+
+static void cacheAppendHex(char* _path, uint32_t _pathSize, uint64_t _value, uint32_t _digits)
+{
+	char hex[17];
+	snprintf(hex, sizeof(hex), "%0*llx", (int)_digits, (unsigned long long)_value);
+	rtm::strlCat(_path, _pathSize, hex);
+}
+
+SymbolCache::SymbolCache()
+{
+	memset(&m_symbols, 0, sizeof(m_symbols));
+	memset(&m_lines, 0, sizeof(m_lines));
+}
+
+bool SymbolCache::getPath(const char* _cacheDir, const char* _modulePath, const ElfFile* _elf, char* _path, uint32_t _pathSize)
+{
+	if (!_cacheDir || !_modulePath || (_cacheDir[0] == '\0'))
+		return false;
+
+	rtm::strlCpy(_path, _pathSize, _cacheDir);
+	const uint32_t len = rtm::strLen(_path);
+	if ((_path[len - 1] != '/') && (_path[len - 1] != '\\'))
+		rtm::strlCat(_path, _pathSize, "/");
+	rtm::strlCat(_path, _pathSize, rtm::pathGetFileName(_modulePath));
+	rtm::strlCat(_path, _pathSize, "-");
+
+	// build ID changes with every link, so a rebuilt module never picks up stale tables
+	const uint8_t* buildID;
+	uint32_t buildIDSize;
+	if (_elf && _elf->getBuildID(buildID, buildIDSize))
+	{
+		for (uint32_t i=0; i<buildIDSize; ++i)
+			cacheAppendHex(_path, _pathSize, buildID[i], 2);
+	}
+	else
+	{
+		uint64_t size, modTime;
+#if RTM_PLATFORM_WINDOWS
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if (!GetFileAttributesExW(rtm::MultiToWide(_modulePath), GetFileExInfoStandard, &attributes))
+			return false;
+		size	= (uint64_t)attributes.nFileSizeHigh << 32 | attributes.nFileSizeLow;
+		modTime	= (uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32 | attributes.ftLastWriteTime.dwLowDateTime;
+#else
+		struct stat st;
+		if (stat(_modulePath, &st) != 0)
+			return false;
+		size	= (uint64_t)st.st_size;
+		modTime	= (uint64_t)st.st_mtime;
+#endif // RTM_PLATFORM_WINDOWS
+
+		cacheAppendHex(_path, _pathSize, rtm::hashStr(_modulePath), 8);
+		rtm::strlCat(_path, _pathSize, "-");
+		cacheAppendHex(_path, _pathSize, size, 1);
+		rtm::strlCat(_path, _pathSize, "-");
+		cacheAppendHex(_path, _pathSize, modTime, 1);
+	}
+
+	rtm::strlCat(_path, _pathSize, ".rdsym");
+	return rtm::strLen(_path) + 1 < _pathSize;
+}
+
+bool SymbolCache::save(const char* _path, const SymbolMap& _symbolMap, const DwarfLineTable& _lineTable)
+{
+	const SymbolMap::Tables& symbols	= _symbolMap.getTables();
+	const DwarfLineTable::Tables& lines	= _lineTable.getTables();
+	if (!symbols.m_searchOffsets)
+		return false;
+
+	CacheHeader header;
+	header.m_magic			= CACHE_MAGIC;
+	header.m_version		= CACHE_VERSION;
+	header.m_byteOrder		= CACHE_BYTEORDER;
+	header.m_symbolSize		= sizeof(SymbolMap::SymbolData);
+	header.m_rowSize		= sizeof(DwarfLineTable::Row);
+	header.m_numSymbols		= symbols.m_numSymbols;
+	header.m_stringsSize	= symbols.m_stringsSize;
+	header.m_numRows		= lines.m_numRows;
+	header.m_numFiles		= lines.m_numFiles;
+	header.m_filePathsSize	= lines.m_filePathsSize;
+
+	CacheLayout layout;
+	cacheGetLayout(header, layout);
+
+	// unique per process and call, concurrent writers of the same module don't clobber each other
+	static std::atomic<uint32_t> s_tempCounter(0);
+#if RTM_PLATFORM_WINDOWS
+	const uint32_t pid = (uint32_t)GetCurrentProcessId();
+#else
+	const uint32_t pid = (uint32_t)getpid();
+#endif // RTM_PLATFORM_WINDOWS
+
+	char tempPath[4096];
+	rtm::strlCpy(tempPath, RTM_NUM_ELEMENTS(tempPath), _path);
+	rtm::strlCat(tempPath, RTM_NUM_ELEMENTS(tempPath), ".");
+	cacheAppendHex(tempPath, RTM_NUM_ELEMENTS(tempPath), pid, 1);
+	rtm::strlCat(tempPath, RTM_NUM_ELEMENTS(tempPath), ".");
+	cacheAppendHex(tempPath, RTM_NUM_ELEMENTS(tempPath), s_tempCounter++, 1);
+
+	FILE* file = fopen(tempPath, "wb");
+	if (!file)
+		return false;
+
+	uint64_t pos = 0;
+	bool ok =	cacheWrite(file, pos, 0,						&header,					sizeof(header)) &&
+				cacheWrite(file, pos, layout.m_symbols,			symbols.m_symbols,			(uint64_t)symbols.m_numSymbols * sizeof(SymbolMap::SymbolData)) &&
+				cacheWrite(file, pos, layout.m_searchOffsets,	symbols.m_searchOffsets,	((uint64_t)symbols.m_numSymbols + 1) * sizeof(int64_t)) &&
+				cacheWrite(file, pos, layout.m_searchIndex,		symbols.m_searchIndex,		((uint64_t)symbols.m_numSymbols + 1) * sizeof(uint32_t)) &&
+				cacheWrite(file, pos, layout.m_strings,			symbols.m_strings,			symbols.m_stringsSize) &&
+				cacheWrite(file, pos, layout.m_rows,			lines.m_rows,				(uint64_t)lines.m_numRows * sizeof(DwarfLineTable::Row)) &&
+				cacheWrite(file, pos, layout.m_fileOffsets,		lines.m_fileOffsets,		(uint64_t)lines.m_numFiles * sizeof(uint32_t)) &&
+				cacheWrite(file, pos, layout.m_filePaths,		lines.m_filePaths,			lines.m_filePathsSize);
+
+	ok = (fclose(file) == 0) && ok;
+
+#if RTM_PLATFORM_WINDOWS
+	ok = ok && MoveFileExW(rtm::MultiToWide(tempPath), rtm::MultiToWide(_path), MOVEFILE_REPLACE_EXISTING);
+#else
+	ok = ok && (rename(tempPath, _path) == 0);
+#endif // RTM_PLATFORM_WINDOWS
+
+	if (!ok)
+		remove(tempPath);
+
+	return ok;
+}
+
+bool SymbolCache::load(const char* _path)
+{
+	if (!m_file.open(_path))
+		return false;
+
+	const uint8_t* data = m_file.data();
+	const uint64_t size = m_file.size();
+
+	CacheHeader header;
+	if (size < sizeof(header))
+	{
+		m_file.close();
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+
+	CacheLayout layout;
+	cacheGetLayout(header, layout);
+
+	// everything lookups rely on is checked here, symbol and line tables bounds check string offsets themselves
+	const char* strings		= (const char*)data + layout.m_strings;
+	const char* filePaths	= (const char*)data + layout.m_filePaths;
+	if ((header.m_magic			!= CACHE_MAGIC)						||
+		(header.m_version		!= CACHE_VERSION)					||
+		(header.m_byteOrder		!= CACHE_BYTEORDER)					||
+		(header.m_symbolSize	!= sizeof(SymbolMap::SymbolData))	||
+		(header.m_rowSize		!= sizeof(DwarfLineTable::Row))		||
+		(layout.m_end > size)										||
+		(header.m_stringsSize == 0) || (strings[header.m_stringsSize - 1] != '\0') ||
+		(header.m_filePathsSize && (filePaths[header.m_filePathsSize - 1] != '\0')))
+	{
+		m_file.close();
+		return false;
+	}
+
+	m_symbols.m_symbols			= (const SymbolMap::SymbolData*)(data + layout.m_symbols);
+	m_symbols.m_strings			= strings;
+	m_symbols.m_searchOffsets	= (const int64_t*)(data + layout.m_searchOffsets);
+	m_symbols.m_searchIndex		= (const uint32_t*)(data + layout.m_searchIndex);
+	m_symbols.m_numSymbols		= header.m_numSymbols;
+	m_symbols.m_stringsSize		= header.m_stringsSize;
+
+	m_lines.m_rows				= (const DwarfLineTable::Row*)(data + layout.m_rows);
+	m_lines.m_fileOffsets		= (const uint32_t*)(data + layout.m_fileOffsets);
+	m_lines.m_filePaths			= filePaths;
+	m_lines.m_numRows			= header.m_numRows;
+	m_lines.m_numFiles			= header.m_numFiles;
+	m_lines.m_filePathsSize		= header.m_filePathsSize;
+
+	return true;
+}
+
+} // namespace rdebug
@@ -0,0 +1,48 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_RDEBUG_SYMBOL_CACHE_H
+#define RTM_RDEBUG_SYMBOL_CACHE_H
+
+#include <rdebug/src/mapped_file.h>
+#include <rdebug/src/symbols_map.h>
+#include <rdebug/src/dwarf.h>
+
+namespace rdebug {
+
+class ElfFile;
+
+/// Memory mapped file with sorted symbol and line tables of a single module, written once they are
+/// built so the next session serves lookups straight from the mapping. Tables are stored in native
+/// layout and byte order, a file written by a different build or platform is rejected on load.
+/// Line table is empty for modules whose lines are decoded per compilation unit.
+class SymbolCache
+{
+	private:
+		MappedFile				m_file;
+		SymbolMap::Tables		m_symbols;
+		DwarfLineTable::Tables	m_lines;
+
+	public:
+		SymbolCache();
+
+		/// Cache file path for a module, keyed by GNU build ID or by path, size and modification time
+		/// of the module if it has none. Returns false if the module can't be identified.
+		static bool	getPath(const char* _cacheDir, const char* _modulePath, const ElfFile* _elf, char* _path, uint32_t _pathSize);
+
+		/// Writes tables to a temporary file first and renames it, so readers never see a partial file
+		static bool	save(const char* _path, const SymbolMap& _symbolMap, const DwarfLineTable& _lineTable);
+
+		/// Maps and validates the file, tables stay valid while the cache is alive
+		bool		load(const char* _path);
+		bool		isLoaded() const { return m_file.isOpen(); }
+
+		const SymbolMap::Tables&		getSymbolTables() const { return m_symbols; }
+		const DwarfLineTable::Tables&	getLineTables() const { return m_lines; }
+};
+
+} // namespace rdebug
+
+#endif // RTM_RDEBUG_SYMBOL_CACHE_H
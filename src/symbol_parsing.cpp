@@ -7,6 +7,17 @@
 #include <rdebug/src/pdb_file.h>
 #include <rdebug/src/symbols_types.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define RDEBUG_SYMBOL_PARSING_SSE2	1
+#include <emmintrin.h>
+#else
+#define RDEBUG_SYMBOL_PARSING_SSE2	0
+#endif
+
+#if RTM_COMPILER_MSVC
+#include <intrin.h>
+#endif // RTM_COMPILER_MSVC
+
 namespace rdebug {
 
 	inline static bool charIsDigit(char _c)
@@ -36,27 +47,27 @@ namespace rdebug {
 
 	void parseAddr2LineSymbolInfo(const char* _str, StackFrame& _frame)
 	{
-		size_t len = rtm::strLen(_str);
+		// function name on the first line, file:line on the second one, either \n or \r\n terminated
+		const char* func = _str;
+		const char* funcEnd = func;
+		while (*funcEnd && !charIsEOL(*funcEnd))
+			++funcEnd;
 
-		size_t l = len;
-		int idx = 0;
-		while (--l)
-		{
-			// ugly but we own the data
-			if (_str[l] == '\r') { const_cast<char*>(_str)[l] = '\0'; idx++; }
-			if (_str[l] == '\n') const_cast<char*>(_str)[l] = '\0';
+		const char* file = funcEnd;
+		while (charIsEOL(*file))
+			++file;
 
-			if (idx == 2) break;
-		}
+		const char* fileEnd = file;
+		while (*fileEnd && !charIsEOL(*fileEnd))
+			++fileEnd;
 
-		if (rtm::strCmp(_str, "??") != 0)
-			rtm::strlCpy(_frame.m_func, sizeof(_frame.m_func), _str);
+		if ((funcEnd != func) && (rtm::strCmp(func, "??", 2) != 0))
+			rtm::strlCpy(_frame.m_func, sizeof(_frame.m_func), func, (uint32_t)(funcEnd - func));
 
-		const char* ptr = &_str[l + 2];
-		if (rtm::strCmp(ptr, "??:0") != 0)
+		if ((fileEnd != file) && (file[0] != '?'))
 		{
-			rtm::strlCpy(_frame.m_file, sizeof(_frame.m_file), ptr);
-			len = rtm::strLen(_frame.m_file);
+			rtm::strlCpy(_frame.m_file, sizeof(_frame.m_file), file, (uint32_t)(fileEnd - file));
+			size_t len = rtm::strLen(_frame.m_file);
 			while (len > 0 && _frame.m_file[--len] != ':');
 			_frame.m_line = atoi(&_frame.m_file[len + 1]);
 			_frame.m_file[len] = '\0';
@@ -99,63 +110,148 @@ namespace rdebug {
 		}
 	}
 
-	void parseFile(std::string& _dst, uint32_t& _line, const char*& _buffer)
+	// symbol map kernels, SSE2 is part of every x64 target so there is no runtime dispatch
+	inline static uint32_t countTrailingZeros(uint32_t _value)
 	{
-		while (charIsBlank(*_buffer) && !charIsEOL(*_buffer)) ++_buffer;
-		while (!charIsEOL(*_buffer))
-		{
-			if (*_buffer == ':')
-			{
-				if (charIsDigit(_buffer[1]))
-				{
-					_line = atoi(&_buffer[1]);
-					break;
-				}
-			}
+#if RTM_COMPILER_MSVC
+		unsigned long idx;
+		_BitScanForward(&idx, _value);
+		return (uint32_t)idx;
+#else
+		return (uint32_t)__builtin_ctz(_value);
+#endif // RTM_COMPILER_MSVC
+	}
 
-			_dst += *_buffer;
-			++_buffer;
-		}
+	inline static uint64_t byteSwap64(uint64_t _value)
+	{
+#if RTM_COMPILER_MSVC
+		return _byteswap_uint64(_value);
+#else
+		return __builtin_bswap64(_value);
+#endif // RTM_COMPILER_MSVC
 	}
 
-	void parseSym(std::string& _dst, const char*& _buffer)
+	/// First character in [_str, _end) that is one of the three given, _end if there is none
+	inline static const char* findFirstOf(const char* _str, const char* _end, char _c0, char _c1, char _c2)
 	{
-		while (charIsBlank(*_buffer) && !charIsEOL(*_buffer)) ++_buffer;
-		while (!charIsTab(*_buffer) && !charIsEOL(*_buffer))
+#if RDEBUG_SYMBOL_PARSING_SSE2
+		const __m128i c0 = _mm_set1_epi8(_c0);
+		const __m128i c1 = _mm_set1_epi8(_c1);
+		const __m128i c2 = _mm_set1_epi8(_c2);
+		while (_end - _str >= 16)
 		{
-			_dst += *_buffer;
-			++_buffer;
+			__m128i v	= _mm_loadu_si128((const __m128i*)_str);
+			__m128i eq	= _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, c0), _mm_cmpeq_epi8(v, c1)), _mm_cmpeq_epi8(v, c2));
+			uint32_t mask = (uint32_t)_mm_movemask_epi8(eq);
+			if (mask)
+				return _str + countTrailingZeros(mask);
+			_str += 16;
 		}
+#endif // RDEBUG_SYMBOL_PARSING_SSE2
+
+		while ((_str < _end) && (*_str != _c0) && (*_str != _c1) && (*_str != _c2))
+			++_str;
+		return _str;
 	}
 
-	bool isHex(char _c)
+	/// Value of a hex digit, 0xff for any other character
+	inline static uint32_t hexDigit(char _c)
 	{
 		if ((_c >= '0') && (_c <= '9'))
-			return true;
-		else
-			if ((_c >= 'a') && (_c <= 'f'))
-				return true;
-			else
-				if ((_c >= 'A') && (_c <= 'F'))
-					return true;
-		return false;
+			return _c - '0';
+
+		const char lower = _c | 0x20;
+		if ((lower >= 'a') && (lower <= 'f'))
+			return 10 + (lower - 'a');
+
+		return 0xff;
 	}
 
-	uint64_t fromHex(char _c, bool& _stop)
+	/// Decodes up to 16 hex digits at _str, returns the number of digits decoded
+	inline static uint32_t decodeHex(const char* _str, const char* _end, uint64_t& _value)
 	{
-		if ((_c >= '0') && (_c <= '9'))
-			return (_c - '0');
-		else
-			if ((_c >= 'a') && (_c <= 'f'))
-				return 10 + (_c - 'a');
-			else
-				if ((_c >= 'A') && (_c <= 'F'))
-					return 10 + (_c - 'A');
-		_stop = true;
-		return 0;
+#if RDEBUG_SYMBOL_PARSING_SSE2
+		if (_end - _str >= 16)
+		{
+			// classify all 16 characters at once, letters are folded to lower case
+			const __m128i v			= _mm_loadu_si128((const __m128i*)_str);
+			const __m128i lower		= _mm_or_si128(v, _mm_set1_epi8(0x20));
+			const __m128i isDigit	= _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+			const __m128i isLetter	= _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+			const __m128i nibbles	= _mm_or_si128(	_mm_and_si128(isDigit,	_mm_sub_epi8(v, _mm_set1_epi8('0'))),
+													_mm_and_si128(isLetter,	_mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+
+			const uint32_t count = countTrailingZeros(~(uint32_t)_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)));
+			if (!count)
+				return 0;
+
+			// pairs of nibbles to bytes, most significant digit first, characters past the digits decode to zero
+			const __m128i pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0xff)), 4), _mm_srli_epi16(nibbles, 8));
+			uint64_t bytes;
+			_mm_storel_epi64((__m128i*)&bytes, _mm_packus_epi16(pairs, _mm_setzero_si128()));
+
+			_value = byteSwap64(bytes) >> (4 * (16 - count));
+			return count;
+		}
+#endif // RDEBUG_SYMBOL_PARSING_SSE2
+
+		uint64_t value = 0;
+		uint32_t count = 0;
+		while ((count < 16) && (_str + count < _end))
+		{
+			const uint32_t digit = hexDigit(_str[count]);
+			if (digit == 0xff)
+				break;
+			value = (value << 4) | digit;
+			++count;
+		}
+		_value = value;
+		return count;
+	}
+
+	inline static const char* skipBlanks(const char* _str, const char* _end)
+	{
+		while ((_str < _end) && charIsBlank(*_str))
+			++_str;
+		return _str;
+	}
+
+	inline static const char* skipSpaces(const char* _str, const char* _end)
+	{
+		while ((_str < _end) && charIsSpace(*_str))
+			++_str;
+		return _str;
+	}
+
+	void parseFile(const char*& _dst, uint32_t& _len, uint32_t& _line, const char*& _buffer, const char* _end)
+	{
+		_buffer = skipBlanks(_buffer, _end);
+		_dst = _buffer;
+		for (;;)
+		{
+			_buffer = findFirstOf(_buffer, _end, ':', '\r', '\n');
+			if ((_buffer == _end) || (*_buffer != ':'))
+				break;
+
+			if ((_buffer + 1 < _end) && charIsDigit(_buffer[1]))
+			{
+				_line = atoi(&_buffer[1]);
+				break;
+			}
+			++_buffer;
+		}
+		_len = (uint32_t)(_buffer - _dst);
 	}
 
-	bool parseHex(uint64_t& _offset, const char*& _buffer)
+	void parseSym(const char*& _dst, uint32_t& _len, const char*& _buffer, const char* _end)
+	{
+		_buffer = skipBlanks(_buffer, _end);
+		_dst = _buffer;
+		_buffer = findFirstOf(_buffer, _end, '\t', '\r', '\n');
+		_len = (uint32_t)(_buffer - _dst);
+	}
+
+	bool parseHex(uint64_t& _offset, const char*& _buffer, const char* _end)
 	{
 		const char* buffer = _buffer;
 		if (!buffer)
@@ -164,30 +260,17 @@ namespace rdebug {
 			return true;
 		}
 
-		while (charIsSpace(*buffer)) ++buffer;
+		buffer = skipSpaces(buffer, _end);
 
-		uint64_t offset = 0;
-		if ((buffer[0] == '0') && (buffer[1] == 'x'))
+		if ((_end - buffer >= 2) && (buffer[0] == '0') && (buffer[1] == 'x'))
 			buffer = &buffer[2];
 
-		if (!isHex(*buffer))
-			return false;
-
-		int cnt = 0;
-		do
-		{
-			if (charIsSpace(*buffer))
-				break;
-
-			bool stop = false;
-			offset = (offset << 4) | fromHex(*buffer, stop);
-			++buffer;
-			if (stop)
-				return false;
-			++cnt;
-		} while (*buffer && isHex(*buffer) && !charIsSpace(*buffer));
+		uint64_t offset;
+		uint32_t cnt = decodeHex(buffer, _end, offset);
+		buffer += cnt;
 
-		if ((cnt != 8) && (cnt != 16))
+		// longer runs of digits are not addresses either
+		if (((cnt != 8) && (cnt != 16)) || ((buffer < _end) && (hexDigit(*buffer) != 0xff)))
 			return false;
 
 		_offset = offset;
@@ -195,18 +278,20 @@ namespace rdebug {
 		return true;
 	}
 
-	void parseSymbolMapLineGNU(const char* _line, SymbolMap& _symMap)
+	void parseSymbolMapLineGNU(const char* _line, const char* _end, SymbolMap& _symMap)
 	{
 		// offset  [size] t/T symbol file:line
-		Symbol sym;
-
 		uint64_t offset = 0;
-		bool charIsDigit = parseHex(offset, _line);  // parses offset, advances _line
+		bool charIsDigit = parseHex(offset, _line, _end);  // parses offset, advances _line
 		if (!charIsDigit)
 			return;
 
 		uint64_t size = 0;
-		parseHex(size, _line);
+		parseHex(size, _line, _end);
+
+		_line = skipSpaces(_line, _end);
+		if (_line == _end)
+			return;
 
 		char type = _line[0];
 		++_line;
@@ -214,81 +299,93 @@ namespace rdebug {
 		if ((type != 't') && (type != 'T'))
 			return;
 
-		parseSym(sym.m_name, _line);
-		sym.m_offset = offset;
-		sym.m_size = size;
+		// name and file are referenced in place and copied straight into the symbol map
+		const char* name;
+		uint32_t nameLen;
+		parseSym(name, nameLen, _line, _end);
 
-		parseFile(sym.m_file, sym.m_line, _line);
+		const char* file;
+		uint32_t fileLen;
+		uint32_t line = 0;
+		parseFile(file, fileLen, line, _line, _end);
 
-		_symMap.addSymbol(sym.m_name.c_str(), sym.m_offset, sym.m_size, sym.m_line, sym.m_file.c_str());
+		_symMap.addSymbol(name, nameLen, (int64_t)offset, size, line, file, fileLen);
 	}
 
-	void parseSymbolMapLinePS3SNC(const char* _line, SymbolMap& _symMap)
+	/// Skips a word and the spaces after it
+	inline static const char* skipWord(const char* _str, const char* _end)
 	{
-		// offset  scope Function segment symbol
-		Symbol sym;
+		return skipSpaces(findFirstOf(_str, _end, ' ', '\r', '\n'), _end);
+	}
 
+	void parseSymbolMapLinePS3SNC(const char* _line, const char* _end, SymbolMap& _symMap)
+	{
+		// offset  scope Function segment symbol
 		uint64_t offset = 0;
-		bool charIsDigit = parseHex(offset, _line);
+		bool charIsDigit = parseHex(offset, _line, _end);
 		if (!charIsDigit)
 			return;
 
-		while (!charIsSpace(*_line) && !charIsEOL(*_line)) ++_line;
-		while (charIsSpace(*_line) && !charIsEOL(*_line)) ++_line;
+		_line = skipWord(_line, _end);
 
-		if (rtm::strCmp(_line, "Function", rtm::strLen("Function")) != 0)
+		const uint32_t functionLen = rtm::strLen("Function");
+		if ((_end - _line < (ptrdiff_t)functionLen) || (rtm::strCmp(_line, "Function", functionLen) != 0))
 			return;
 
-		while (!charIsSpace(*_line) && !charIsEOL(*_line)) ++_line;
-		while (charIsSpace(*_line) && !charIsEOL(*_line)) ++_line;
-		while (!charIsSpace(*_line) && !charIsEOL(*_line)) ++_line;
-		while (charIsSpace(*_line) && !charIsEOL(*_line)) ++_line;
+		_line = skipWord(_line, _end);
+		_line = skipWord(_line, _end);
 
-		parseSym(sym.m_name, _line);
-		sym.m_offset = offset;
+		const char* name;
+		uint32_t nameLen;
+		parseSym(name, nameLen, _line, _end);
 
-		_symMap.addSymbol(sym.m_name.c_str(), sym.m_offset, sym.m_size, sym.m_line, sym.m_file.c_str());
+		// no size in the listing, it's derived from the next symbol when the map is sorted
+		_symMap.addSymbol(name, nameLen, (int64_t)offset, 0, 0, "", 0);
 	}
 
-	void parseSymbolMapGNU(const char* _buffer, SymbolMap& _symMap)
+	bool parseSymbolMapChunk(const char* _data, uint32_t _size, void* _userData)
 	{
-		size_t len = rtm::strLen(_buffer);
-		size_t pos = 0;
+		SymbolMapReader* reader = (SymbolMapReader*)_userData;
+		const char* line	= _data;
+		const char* end		= _data + _size;
 
-		while (pos < len)
+		// complete lines are parsed in place, new lines are found with memchr which is vectorized already
+		if (!reader->m_line.empty())
 		{
-			const char* line = &_buffer[pos];
-			parseSymbolMapLineGNU(line, _symMap);
+			const char* eol = (const char*)memchr(line, '\n', (size_t)(end - line));
+			if (!eol)
+			{
+				reader->m_line.insert(reader->m_line.end(), line, end);
+				return false;
+			}
 
-			while (pos < len && !charIsEOL(_buffer[pos]))
-				++pos;
+			reader->m_line.insert(reader->m_line.end(), line, eol);
+			reader->m_parseLine(&reader->m_line[0], &reader->m_line[0] + reader->m_line.size(), *reader->m_symMap);
+			reader->m_line.clear();
+			line = eol + 1;
+		}
 
-			while (pos < len && charIsEOL(_buffer[pos]))
-				++pos;
+		while (const char* eol = (const char*)memchr(line, '\n', (size_t)(end - line)))
+		{
+			reader->m_parseLine(line, eol, *reader->m_symMap);
+			line = eol + 1;
 		}
 
-		_symMap.sort();
+		// partial line is kept until the rest of it arrives
+		reader->m_line.insert(reader->m_line.end(), line, end);
+		return false;
 	}
 
-	void parseSymbolMapPS3(const char* _buffer, SymbolMap& _symMap)
+	void parseSymbolMapEnd(SymbolMapReader& _reader)
 	{
-		size_t len = rtm::strLen(_buffer);
-		size_t pos = 0;
-
-		while (pos < len)
+		// output doesn't have to end with a new line
+		if (!_reader.m_line.empty())
 		{
-			const char* line = &_buffer[pos];
-
-			parseSymbolMapLinePS3SNC(line, _symMap);
-
-			while (pos < len && !charIsEOL(_buffer[pos]))
-				++pos;
-
-			while (pos < len && charIsEOL(_buffer[pos]))
-				++pos;
+			_reader.m_parseLine(&_reader.m_line[0], &_reader.m_line[0] + _reader.m_line.size(), *_reader.m_symMap);
+			_reader.m_line.clear();
 		}
 
-		_symMap.sort();
+		_reader.m_symMap->sort();
 	}
 
 } // namespace rdebug
@@ -6,8 +6,14 @@
 #include <rdebug_pch.h>
 #include <rdebug/src/pdb_file.h>
 #include <rdebug/src/symbols_types.h>
+#include <rdebug/src/elf_file.h>
+#include <rdebug/src/dwarf.h>
+#include <rdebug/src/symbol_cache.h>
+#include <rdebug/src/debug_file.h>
+#include <rdebug/src/cxx_demangle.h>
+#include <rdebug/src/process.h>
+#include <rdebug/src/thread_pool.h>
 #include <rbase/inc/console.h>
-#include <rbase/inc/hash.h>
 
 #include "../3rd/rust-demangle.h"
 #include "../3rd/rust-demangle.c"
@@ -237,13 +243,15 @@ namespace rdebug {
 void parseAddr2LineSymbolInfo(const char* _str, StackFrame& _frame);
 void parsePlayStationSymbolInfo(const char* _str, StackFrame& _frame);
 
-void parseSymbolMapGNU(const char*  _buffer, SymbolMap& _symMap);
-void parseSymbolMapPS3(const char*  _buffer, SymbolMap& _symMap);
+void parseSymbolMapLineGNU(const char* _line, const char* _end, SymbolMap& _symMap);
+void parseSymbolMapLinePS3SNC(const char* _line, const char* _end, SymbolMap& _symMap);
+bool parseSymbolMapChunk(const char* _data, uint32_t _size, void* _userData);
+void parseSymbolMapEnd(SymbolMapReader& _reader);
 
 #if RTM_PLATFORM_WINDOWS
 extern char g_symStore[ResolveInfo::SYM_SERVER_BUFFER_SIZE];
 
-bool loadPDB(Module& _module)
+bool loadPDB(const Module& _module)
 {
 	if (!_module.m_resolver->m_PDBFile)
 	{
@@ -274,173 +282,388 @@ void symbolSetServerSource(const char* _symStore)
 	rtm::strlCpy(g_symStore, ResolveInfo::SYM_SERVER_BUFFER_SIZE, _symStore);
 }
 
-uintptr_t symbolResolverCreate(ModuleInfo* _moduleInfos, uint32_t _numInfos, const char* _executable, module_load_cb _callback, void* _data)
+char	 g_symCache[ResolveInfo::SYM_SERVER_BUFFER_SIZE] = { 0 };
+
+void symbolSetCachePath(const char* _cachePath)
 {
-	RTM_UNUSED_2(_callback, _data);
-	RTM_ASSERT(_moduleInfos, "Either module info array or toolchain desc can't be NULL");
+	rtm::strlCpy(g_symCache, ResolveInfo::SYM_SERVER_BUFFER_SIZE, _cachePath ? _cachePath : "");
+}
 
-	Resolver* resolver = rtm_new<Resolver>();
+uint64_t g_dwarfCacheSize = 256 * 1024 * 1024;
 
-	const char* executablePath = 0;
-	const char* exeName = _executable ? rtm::pathGetFileName(_executable) : 0;
+void symbolSetDwarfCacheSize(uint64_t _bytes)
+{
+	g_dwarfCacheSize = _bytes;
+}
 
-	for (uint32_t i=0; i<_numInfos; ++i)
+void symbolSetDebugFilePath(const char* _debugFilePath)
+{
+	debugFileSetDirectories(_debugFilePath);
+}
+
+inline bool toolchainIsGNU(Toolchain::Type _type)
+{
+	return ((_type == rdebug::Toolchain::GCC) ||
+			(_type == rdebug::Toolchain::PS4) ||
+			(_type == rdebug::Toolchain::PS5));
+}
+
+/// Range of time index segments covered by a module, [base, base + size] inclusive same as ModuleInfo::checkAddress
+static inline void moduleGetSegments(const std::vector<uint64_t>& _starts, const ModuleInfo& _info, uint32_t& _first, uint32_t& _last)
+{
+	const uint64_t end = _info.m_baseAddress + _info.m_size + 1;
+	_first	= (uint32_t)(std::lower_bound(_starts.begin(), _starts.end(), _info.m_baseAddress) - _starts.begin());
+	_last	= end > _info.m_baseAddress ? (uint32_t)(std::lower_bound(_starts.begin(), _starts.end(), end) - _starts.begin()) : (uint32_t)_starts.size();
+}
+
+static void resolverBuildTimeIndex(Resolver* _resolver)
+{
+	const std::vector<Module>& modules	= _resolver->m_modules;
+	std::vector<uint64_t>& starts		= _resolver->m_segmentStarts;
+	std::vector<uint32_t>& first		= _resolver->m_segmentFirst;
+
+	for (uint32_t i=0; i<modules.size(); ++i)
 	{
-		Module module;
-		module.m_module		= _moduleInfos[i];
-		module.m_moduleName	= rtm::pathGetFileName(module.m_module.m_modulePath);
-		module.m_resolver	= rtm_new<ResolveInfo>();
+		const uint64_t base	= modules[i].m_module.m_baseAddress;
+		const uint64_t end	= base + modules[i].m_module.m_size + 1;
+		starts.push_back(base);
+		if (end > base)
+			starts.push_back(end);
+	}
 
-		char tmpName[1024];
-		rtm::strlCpy(tmpName, RTM_NUM_ELEMENTS(tmpName), module.m_moduleName);
-		rtm::strToUpper(tmpName);
+	std::sort(starts.begin(), starts.end());
+	starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
 
-		if ((rtm::striCmp(tmpName,"MTUNERDLL32.DLL") == 0) || (rtm::striCmp(tmpName,"MTUNERDLL64.DLL") == 0))
-			module.m_isRTMdll = true;
+	first.assign(starts.size() + 1, 0);
+	for (uint32_t i=0; i<modules.size(); ++i)
+	{
+		uint32_t segFirst, segLast;
+		moduleGetSegments(starts, modules[i].m_module, segFirst, segLast);
+		for (uint32_t seg=segFirst; seg<segLast; ++seg)
+			++first[seg + 1];
+	}
 
-		const char* ext	= rtm::pathGetExt(tmpName);
-		const bool crossToolChain = ((rtm::striCmp(ext, "ELF") == 0) || (rtm::striCmp(ext, "SELF") == 0)) ? true : false;
+	for (uint32_t seg=0; seg<starts.size(); ++seg)
+		first[seg + 1] += first[seg];
 
-		// on Windows, fix toolchain for each module
-		if (!crossToolChain)
-		{
-#if RTM_PLATFORM_WINDOWS
-			// No Rich Header — use PDB/CodeView debug info as fallback before assuming GCC
-			int hasRH = hasRichHeader(module.m_module.m_modulePath);
-			if (hasRH >= 0)
-			{
-				if (hasRH == 1)
-					module.m_module.m_toolchain.m_type = rdebug::Toolchain::MSVC;
-				else
-				{
-					// No Rich Header — use PDB/CodeView debug info as fallback before assuming GCC
-					if (hasPDBDebugInfo(module.m_module.m_modulePath))
-						module.m_module.m_toolchain.m_type = rdebug::Toolchain::MSVC;
-					else
-						module.m_module.m_toolchain.m_type = rdebug::Toolchain::GCC;
-				}
-			}
-#endif // RTM_PLATFORM_WINDOWS
-		}
+	// modules are ordered by load time here so that each segment's list comes out sorted
+	std::vector<uint32_t> order(modules.size());
+	for (uint32_t i=0; i<order.size(); ++i)
+		order[i] = i;
 
-		if (ext)
+	std::stable_sort(order.begin(), order.end(),
+		[&modules](uint32_t a, uint32_t b)
 		{
-			if ((rtm::striCmp(ext, "EXE") == 0) || crossToolChain)
-				executablePath = _moduleInfos[i].m_modulePath;
+			return modules[a].m_module.m_loadTime < modules[b].m_module.m_loadTime;
+		});
 
-			if (((rtm::striCmp(module.m_moduleName, exeName) == 0)) && crossToolChain)
-				module.m_resolver->m_baseAddress4addr2Line = module.m_module.m_baseAddress;
+	_resolver->m_segmentLoadTimes.resize(first.back());
+	_resolver->m_segmentModules.resize(first.back());
+
+	std::vector<uint32_t> fill(first.begin(), first.end() - 1);
+	for (uint32_t i=0; i<order.size(); ++i)
+	{
+		uint32_t segFirst, segLast;
+		moduleGetSegments(starts, modules[order[i]].m_module, segFirst, segLast);
+		for (uint32_t seg=segFirst; seg<segLast; ++seg)
+		{
+			_resolver->m_segmentLoadTimes[fill[seg]]	= modules[order[i]].m_module.m_loadTime;
+			_resolver->m_segmentModules[fill[seg]++]	= order[i];
 		}
+	}
+}
 
-		if (executablePath)
+/// Probes module toolchain and builds toolchain command lines, loads PDB on Windows unless symbols are
+/// loaded in the background. Returns true if symbols were loaded.
+static bool moduleSetup(Module& _module, const char* _executablePath, bool _crossToolChain, bool _loadSymbols)
+{
+	// on Windows, fix toolchain for each module
+	if (!_crossToolChain)
+	{
+#if RTM_PLATFORM_WINDOWS
+		// No Rich Header — use PDB/CodeView debug info as fallback before assuming GCC
+		int hasRH = hasRichHeader(_module.m_module.m_modulePath);
+		if (hasRH >= 0)
 		{
-			module.m_resolver->m_executablePath = module.m_resolver->scratch(executablePath);
-			module.m_resolver->m_executableName = module.m_resolver->m_executablePath ? rtm::pathGetFileName(module.m_resolver->m_executablePath) : 0;
+			if (hasRH == 1)
+				_module.m_module.m_toolchain.m_type = rdebug::Toolchain::MSVC;
+			else
+			{
+				// No Rich Header — use PDB/CodeView debug info as fallback before assuming GCC
+				if (hasPDBDebugInfo(_module.m_module.m_modulePath))
+					_module.m_module.m_toolchain.m_type = rdebug::Toolchain::MSVC;
+				else
+					_module.m_module.m_toolchain.m_type = rdebug::Toolchain::GCC;
+			}
 		}
+#endif // RTM_PLATFORM_WINDOWS
+	}
 
-		std::string append_nm;
-		std::string append_a2l;
-		std::string append_cppf;
+	// stripped image, symbols and debug info are read from its separate debug file instead. Frames still
+	// report the image as their module.
+	char debugFilePath[1024];
+	const char* symbolsPath = _executablePath;
+	if (_executablePath && toolchainIsGNU(_module.m_module.m_toolchain.m_type) && debugFileFind(_executablePath, debugFilePath, RTM_NUM_ELEMENTS(debugFilePath)))
+		symbolsPath = debugFilePath;
 
-		std::string quote;
+	if (_executablePath)
+	{
+		_module.m_resolver->m_executablePath = _module.m_resolver->scratch(_executablePath);
+		_module.m_resolver->m_executableName = _module.m_resolver->m_executablePath ? rtm::pathGetFileName(_module.m_resolver->m_executablePath) : 0;
+		_module.m_resolver->m_debugFilePath = (symbolsPath == _executablePath) ? _module.m_resolver->m_executablePath : _module.m_resolver->scratch(symbolsPath);
+	}
 
-		if ((module.m_module.m_toolchain.m_type == rdebug::Toolchain::GCC) ||
-			(module.m_module.m_toolchain.m_type == rdebug::Toolchain::PS4) ||
-			(module.m_module.m_toolchain.m_type == rdebug::Toolchain::PS5))
-		{
-			if (module.m_module.m_toolchain.m_type == rdebug::Toolchain::GCC)
-				quote = "\"";
+	std::string append_nm;
+	std::string append_a2l;
+	std::string append_a2lBatch;
 
-			append_nm = "\" -C --print-size --numeric-sort --line-numbers " + quote;
-			append_nm += executablePath;
-			append_nm += quote;
+	std::string quote;
 
-			append_a2l = "\" -f -e " + quote;
-			append_a2l += executablePath;
-			append_a2l += quote + " 0x%x";
+	if ((_module.m_module.m_toolchain.m_type == rdebug::Toolchain::GCC) ||
+		(_module.m_module.m_toolchain.m_type == rdebug::Toolchain::PS4) ||
+		(_module.m_module.m_toolchain.m_type == rdebug::Toolchain::PS5))
+	{
+		if (_module.m_module.m_toolchain.m_type == rdebug::Toolchain::GCC)
+			quote = "\"";
 
-			append_cppf = "\" -t -n ";
-		}
+		append_nm = "\" -C --print-size --numeric-sort --line-numbers " + quote;
+		append_nm += symbolsPath;
+		append_nm += quote;
 
-		if (module.m_module.m_toolchain.m_type == rdebug::Toolchain::PS3SNC)
-		{
-			append_nm = "\" -dsy \"";
-			append_nm += executablePath;
-			append_nm += "\"";
+		append_a2l = "\" -f -e " + quote;
+		append_a2l += symbolsPath;
+		append_a2l += quote + " 0x%llx";
 
-			append_a2l = "\" -a2l 0x%x -i \"";
-			append_a2l += executablePath;
-			append_a2l += "\"";
+		// addresses are read from stdin and echoed back (-a) so answers can be matched to requests
+		append_a2lBatch = "\" -a -f -e " + quote;
+		append_a2lBatch += symbolsPath;
+		append_a2lBatch += quote;
+	}
 
-			append_cppf = "\" -t -n ";
-		}
+	if (_module.m_module.m_toolchain.m_type == rdebug::Toolchain::PS3SNC)
+	{
+		append_nm = "\" -dsy \"";
+		append_nm += symbolsPath;
+		append_nm += "\"";
+
+		append_a2l = "\" -a2l 0x%llx -i \"";
+		append_a2l += symbolsPath;
+		append_a2l += "\"";
+	}
 
 #if RTM_PLATFORM_WINDOWS
-		append_nm = ".exe" + append_nm;
-		append_a2l = ".exe" + append_a2l;
-		append_cppf = ".exe" + append_cppf;
+	append_nm = ".exe" + append_nm;
+	append_a2l = ".exe" + append_a2l;
+	append_a2lBatch = ".exe" + append_a2lBatch;
 #endif
 
-		quote = "\"";
+	quote = "\"";
 
-		switch (module.m_module.m_toolchain.m_type)
-		{
-		case rdebug::Toolchain::MSVC:
-			module.m_resolver->m_parseSym		= 0;
-			module.m_resolver->m_parseSymMap	= 0;
-			module.m_resolver->m_symbolStore	= 0;
-			module.m_resolver->m_tc_addr2line	= 0;
-			module.m_resolver->m_tc_nm			= 0;
-			module.m_resolver->m_tc_cppfilt		= 0;
-			break;
+	switch (_module.m_module.m_toolchain.m_type)
+	{
+	case rdebug::Toolchain::MSVC:
+		_module.m_resolver->m_parseSym		= 0;
+		_module.m_resolver->m_parseSymMapLine	= 0;
+		_module.m_resolver->m_symbolStore	= 0;
+		_module.m_resolver->m_tc_addr2line	= 0;
+		_module.m_resolver->m_tc_nm			= 0;
+		break;
+
+	case rdebug::Toolchain::GCC:
+	case rdebug::Toolchain::PS4:
+	case rdebug::Toolchain::PS5:
+		_module.m_resolver->m_parseSym		= parseAddr2LineSymbolInfo;
+		_module.m_resolver->m_parseSymMapLine	= parseSymbolMapLineGNU;
+		_module.m_resolver->m_symbolStore	= 0;
+		_module.m_resolver->m_tc_addr2line	= _module.m_resolver->scratch((quote + _module.m_module.m_toolchain.m_toolchainPath + _module.m_module.m_toolchain.m_toolchainPrefix + "addr2line" + append_a2l).c_str());
+		_module.m_resolver->m_tc_addr2lineBatch	= _module.m_resolver->scratch((quote + _module.m_module.m_toolchain.m_toolchainPath + _module.m_module.m_toolchain.m_toolchainPrefix + "addr2line" + append_a2lBatch).c_str());
+		_module.m_resolver->m_tc_nm			= _module.m_resolver->scratch((quote + _module.m_module.m_toolchain.m_toolchainPath + _module.m_module.m_toolchain.m_toolchainPrefix + "nm" + append_nm).c_str());
+		break;
+
+	case rdebug::Toolchain::PS3SNC:
+		_module.m_resolver->m_parseSym		= parsePlayStationSymbolInfo;
+		_module.m_resolver->m_parseSymMapLine	= parseSymbolMapLinePS3SNC;
+		_module.m_resolver->m_symbolStore	= 0;
+		_module.m_resolver->m_tc_addr2line	= _module.m_resolver->scratch((quote + _module.m_module.m_toolchain.m_toolchainPath + _module.m_module.m_toolchain.m_toolchainPrefix + "ps3bin" + append_a2l).c_str());
+		_module.m_resolver->m_tc_nm			= _module.m_resolver->scratch((quote + _module.m_module.m_toolchain.m_toolchainPath + _module.m_module.m_toolchain.m_toolchainPrefix + "ps3bin" + append_nm).c_str());
+		break;
+
+	case rdebug::Toolchain::Unknown:
+		rtm::Console::info("Toolchain is not configured, no symbols can be resolved!\n");
+	};
+
+	_module.m_resolver->m_symbolStore = _module.m_resolver->scratch(_module.m_module.m_toolchain.m_toolchainPath);
+
+	// PDB lookups go through DIA, only tables built by rdebug itself are cached
+	if ((g_symCache[0] != '\0') && (_module.m_module.m_toolchain.m_type != rdebug::Toolchain::MSVC))
+		_module.m_resolver->m_symbolCache = _module.m_resolver->scratch(g_symCache);
 
-		case rdebug::Toolchain::GCC:
-		case rdebug::Toolchain::PS4:
-		case rdebug::Toolchain::PS5:
-			module.m_resolver->m_parseSym		= parseAddr2LineSymbolInfo;
-			module.m_resolver->m_parseSymMap	= parseSymbolMapGNU;
-			module.m_resolver->m_symbolStore	= 0;
-			module.m_resolver->m_tc_addr2line	= module.m_resolver->scratch((quote + module.m_module.m_toolchain.m_toolchainPath + module.m_module.m_toolchain.m_toolchainPrefix + "addr2line" + append_a2l).c_str());
-			module.m_resolver->m_tc_nm			= module.m_resolver->scratch((quote + module.m_module.m_toolchain.m_toolchainPath + module.m_module.m_toolchain.m_toolchainPrefix + "nm" + append_nm).c_str());
-			module.m_resolver->m_tc_cppfilt		= module.m_resolver->scratch((quote + module.m_module.m_toolchain.m_toolchainPath + module.m_module.m_toolchain.m_toolchainPrefix + "c++filt" + append_cppf).c_str());
-			break;
+#if RTM_PLATFORM_WINDOWS
+	return _loadSymbols && loadPDB(_module);
+#else
+	RTM_UNUSED(_loadSymbols);
+	return false;
+#endif // RTM_PLATFORM_WINDOWS
+}
 
-		case rdebug::Toolchain::PS3SNC:
-			module.m_resolver->m_parseSym		= parsePlayStationSymbolInfo;
-			module.m_resolver->m_parseSymMap	= parseSymbolMapPS3;
-			module.m_resolver->m_symbolStore	= 0;
-			module.m_resolver->m_tc_addr2line	= module.m_resolver->scratch((quote + module.m_module.m_toolchain.m_toolchainPath + module.m_module.m_toolchain.m_toolchainPrefix + "ps3bin" + append_a2l).c_str());
-			module.m_resolver->m_tc_nm			= module.m_resolver->scratch((quote + module.m_module.m_toolchain.m_toolchainPath + module.m_module.m_toolchain.m_toolchainPrefix + "ps3bin" + append_nm).c_str());
-			module.m_resolver->m_tc_cppfilt		= module.m_resolver->scratch((quote + module.m_module.m_toolchain.m_toolchainPath + module.m_module.m_toolchain.m_toolchainPrefix + "ps3name" + append_cppf).c_str());
-			break;
+#if RTM_PLATFORM_WINDOWS
+/// DIA is created through COM, worker threads initialize it for the duration of a task
+struct ComScope
+{
+	HRESULT m_result;
 
-		case rdebug::Toolchain::Unknown:
-			rtm::Console::info("Toolchain is not configured, no symbols can be resolved!\n");
-		};
+	ComScope()	{ m_result = ::CoInitializeEx(0, COINIT_MULTITHREADED); }
+	~ComScope()	{ if (SUCCEEDED(m_result)) ::CoUninitialize(); }
+};
+#endif // RTM_PLATFORM_WINDOWS
 
-		module.m_resolver->m_symbolStore = module.m_resolver->scratch(module.m_module.m_toolchain.m_toolchainPath);
+/// Modules set up concurrently, one task per module
+struct ModuleSetup
+{
+	Module*				m_modules;
+	const char**		m_executablePaths;
+	const uint8_t*		m_crossToolChain;
+	bool				m_loadSymbols;
+	module_load_cb		m_callback;
+	void*				m_data;
+	std::mutex			m_callbackLock;
+};
+
+static void moduleSetupTask(uint32_t _task, void* _userData)
+{
+	ModuleSetup* setup = (ModuleSetup*)_userData;
 
 #if RTM_PLATFORM_WINDOWS
-		if (loadPDB(module) && _callback)
-			_callback(module.m_moduleName, _data);
-#endif
+	ComScope com;
+#endif // RTM_PLATFORM_WINDOWS
 
-		resolver->m_modules.push_back(module);
+	Module& module = setup->m_modules[_task];
+	if (moduleSetup(module, setup->m_executablePaths[_task], setup->m_crossToolChain[_task] != 0, setup->m_loadSymbols) && setup->m_callback)
+	{
+		// progress is reported from worker threads, one module at a time
+		std::lock_guard<std::mutex> lock(setup->m_callbackLock);
+		setup->m_callback(module.m_moduleName, setup->m_data);
+	}
+}
+
+static void resolverStartLoading(Resolver* _resolver, SymbolLoad::Enum _onQuery);
+
+static Resolver* resolverCreate(ModuleInfo* _moduleInfos, uint32_t _numInfos, const char* _executable, module_load_cb _callback, void* _data, bool _loadSymbols)
+{
+	RTM_ASSERT(_moduleInfos, "Either module info array or toolchain desc can't be NULL");
+
+	Resolver* resolver = rtm_new<Resolver>();
+
+	const char* executablePath = 0;
+	const char* exeName = _executable ? rtm::pathGetFileName(_executable) : 0;
+
+	std::vector<Module> modules;
+	std::vector<const char*> executablePaths;
+	std::vector<uint8_t> crossToolChains;
+	modules.reserve(_numInfos);
+	executablePaths.reserve(_numInfos);
+	crossToolChains.reserve(_numInfos);
+
+	// cheap serial pass, each module uses the last executable path seen before it
+	for (uint32_t i=0; i<_numInfos; ++i)
+	{
+		Module module;
+		module.m_module		= _moduleInfos[i];
+		module.m_resolver	= rtm_new<ResolveInfo>();
+
+		const char* moduleName = rtm::pathGetFileName(module.m_module.m_modulePath);
+
+		char tmpName[1024];
+		rtm::strlCpy(tmpName, RTM_NUM_ELEMENTS(tmpName), moduleName);
+		rtm::strToUpper(tmpName);
+
+		if ((rtm::striCmp(tmpName,"MTUNERDLL32.DLL") == 0) || (rtm::striCmp(tmpName,"MTUNERDLL64.DLL") == 0))
+			module.m_isRTMdll = true;
+
+		const char* ext	= rtm::pathGetExt(tmpName);
+		const bool crossToolChain = ((rtm::striCmp(ext, "ELF") == 0) || (rtm::striCmp(ext, "SELF") == 0)) ? true : false;
+
+		if (ext)
+		{
+			if ((rtm::striCmp(ext, "EXE") == 0) || crossToolChain)
+				executablePath = _moduleInfos[i].m_modulePath;
+
+			if (((rtm::striCmp(moduleName, exeName) == 0)) && crossToolChain)
+				module.m_resolver->m_baseAddress4addr2Line = module.m_module.m_baseAddress;
+		}
+
+		modules.push_back(module);
+		executablePaths.push_back(executablePath);
+		crossToolChains.push_back(crossToolChain ? 1 : 0);
 	}
 
-	std::sort(&resolver->m_modules[0], &resolver->m_modules[resolver->m_modules.size()-1],
-		[](const Module& a, const Module& b)
-		{ 
-			return a.m_module.m_baseAddress < b.m_module.m_baseAddress; 
+	// sort by base address through indices, modules are large and each one is moved only once
+	std::vector<uint32_t> order(modules.size());
+	for (uint32_t i=0; i<order.size(); ++i)
+		order[i] = i;
+
+	std::sort(order.begin(), order.end(),
+		[&modules](uint32_t a, uint32_t b)
+		{
+			return modules[a].m_module.m_baseAddress < modules[b].m_module.m_baseAddress;
 		});
 
+	std::vector<const char*> sortedExecutablePaths(order.size());
+	std::vector<uint8_t> sortedCrossToolChains(order.size());
+	resolver->m_moduleBases.reserve(modules.size());
+	resolver->m_moduleSizes.reserve(modules.size());
+	resolver->m_modules.reserve(modules.size());
+	for (uint32_t i=0; i<order.size(); ++i)
+	{
+		const Module& module = modules[order[i]];
+		resolver->m_moduleBases.push_back(module.m_module.m_baseAddress);
+		resolver->m_moduleSizes.push_back(module.m_module.m_size);
+		resolver->m_modules.push_back(module);
+		sortedExecutablePaths[i] = executablePaths[order[i]];
+		sortedCrossToolChains[i] = crossToolChains[order[i]];
+
+		// name points into the module path, so it's set once the module is in its final place
+		Module& placed = resolver->m_modules[i];
+		placed.m_moduleName = rtm::pathGetFileName(placed.m_module.m_modulePath);
+	}
+
+	// probing files, building command lines and loading PDBs is independent per module
+	if (!resolver->m_modules.empty())
+	{
+		ModuleSetup setup;
+		setup.m_modules			= &resolver->m_modules[0];
+		setup.m_executablePaths	= &sortedExecutablePaths[0];
+		setup.m_crossToolChain	= &sortedCrossToolChains[0];
+		setup.m_loadSymbols		= _loadSymbols;
+		setup.m_callback		= _callback;
+		setup.m_data			= _data;
+
+		threadPoolGet()->run((uint32_t)resolver->m_modules.size(), moduleSetupTask, &setup);
+	}
+
+	resolverBuildTimeIndex(resolver);
+
+	return resolver;
+}
+
+uintptr_t symbolResolverCreate(ModuleInfo* _moduleInfos, uint32_t _numInfos, const char* _executable, module_load_cb _callback, void* _data)
+{
+	return (uintptr_t)resolverCreate(_moduleInfos, _numInfos, _executable, _callback, _data, true);
+}
+
+uintptr_t symbolResolverCreateAsync(ModuleInfo* _moduleInfos, uint32_t _numInfos, const char* _executable, SymbolLoad::Enum _onQuery, module_load_cb _callback, void* _data)
+{
+	Resolver* resolver = resolverCreate(_moduleInfos, _numInfos, _executable, 0, 0, false);
+	resolver->m_loadCallback		= _callback;
+	resolver->m_loadCallbackData	= _data;
+	resolverStartLoading(resolver, _onQuery);
 	return (uintptr_t)resolver;
 }
 
 uintptr_t symbolResolverCreateForCurrentProcess()
 {
 #if RTM_PLATFORM_WINDOWS
-	rtm::FixedArray<ModuleInfo, Resolver::MAX_MODULES> modules;
+	std::vector<ModuleInfo> modules;
 
 	HMODULE kerneldll32	= ::GetModuleHandleA("kernel32");
 	HMODULE psapiDLL	= ::LoadLibraryA("Psapi.dll");
@@ -495,6 +718,8 @@ uintptr_t symbolResolverCreateForCurrentProcess()
 						ModuleInfo module;
 						module.m_baseAddress	= modBase;
 						module.m_size			= modSize;
+						module.m_loadTime		= 0;
+						module.m_unloadTime		= ~0ull;
 						rtm::strlCpy(module.m_modulePath, RTM_NUM_ELEMENTS(module.m_modulePath), modulePath.m_ptr);
 						modules.push_back(module);
 			        }
@@ -511,6 +736,8 @@ uintptr_t symbolResolverCreateForCurrentProcess()
 			ModuleInfo module;
 			module.m_baseAddress	= modBase;
 			module.m_size			= modSize;
+			module.m_loadTime		= 0;
+			module.m_unloadTime		= ~0ull;
 			rtm::strlCpy(module.m_modulePath, RTM_NUM_ELEMENTS(module.m_modulePath), exePath.m_ptr);
 			modules.push_back(module);
 			cap = Module32NextW(snapshot, &me);
@@ -519,7 +746,10 @@ uintptr_t symbolResolverCreateForCurrentProcess()
 		CloseHandle(snapshot);
 	}
 
-	return symbolResolverCreate(&modules[0], modules.size(), 0);
+	if (modules.empty())
+		return 0;
+
+	return symbolResolverCreate(&modules[0], (uint32_t)modules.size(), 0);
 #else
 	return 0;
 #endif
@@ -530,6 +760,13 @@ void symbolResolverDelete(uintptr_t _resolver)
 	RTM_ASSERT(_resolver, "Invalid resolver!");
 	Resolver* resolver = (Resolver*)_resolver;
 
+	// modules not reached by the background loader yet are skipped, the one being loaded is finished
+	if (resolver->m_loader.joinable())
+	{
+		resolver->m_stopLoading = true;
+		resolver->m_loader.join();
+	}
+
 	for (uint32_t i=0; i<resolver->m_modules.size(); ++i)
 	{
 		Module& module = resolver->m_modules[i];
@@ -546,16 +783,25 @@ ResolveInfo::ResolveInfo()
 	m_scratch				= (char*)rtm_alloc(sizeof(char) *  SCRATCH_MEM_SIZE);
 	m_scratchPos			= 0;
 	m_tc_addr2line			= 0;
+	m_tc_addr2lineBatch		= 0;
+	m_addr2line				= 0;
 	m_tc_nm					= 0;
-	m_tc_cppfilt			= 0;
 	m_executablePath		= 0;
 	m_executableName		= 0;
+	m_debugFilePath			= 0;
 	m_parseSym				= 0;
-	m_parseSymMap			= 0;
+	m_parseSymMapLine		= 0;
 	m_baseAddress4addr2Line = 0;
 	m_symbolStore			= 0;
-	m_symbolMapInitialized	= false;
+	m_symbolMap				= 0;
 	m_symbolCache			= 0;
+	m_elfFile				= 0;
+	m_lineTable				= 0;
+	m_unitIndex				= 0;
+	m_cache					= 0;
+	m_cacheSaved			= false;
+	m_symbolsPending		= false;
+	m_skipWhilePending		= false;
 #if RTM_PLATFORM_WINDOWS
 	m_PDBFile				= 0;
 #endif // RTM_PLATFORM_WINDOWS
@@ -567,6 +813,18 @@ ResolveInfo::~ResolveInfo()
 	if (m_PDBFile)
 		rtm_delete<PDBFile>(m_PDBFile);
 #endif // RTM_PLATFORM_WINDOWS
+	if (m_symbolMap)
+		rtm_delete<SymbolMap>(m_symbolMap);
+	if (m_lineTable)
+		rtm_delete<DwarfLineTable>(m_lineTable);
+	if (m_unitIndex)
+		rtm_delete<DwarfUnitIndex>(m_unitIndex);
+	if (m_elfFile)
+		rtm_delete<ElfFile>(m_elfFile);
+	if (m_cache)
+		rtm_delete<SymbolCache>(m_cache);	// after the tables, they may point into it
+	if (m_addr2line)
+		rtm_delete<Coprocess>(m_addr2line);
 	rtm_free(m_scratch);
 }
 
@@ -649,24 +907,501 @@ inline const Module* addressGetModule(uintptr_t _resolver, uint64_t _address)
 {
 	const Resolver* resolver = (Resolver*)_resolver;
 
-	int32_t minIndex = 0;
-	int32_t maxIndex = resolver->m_modules.size() - 1;
+	// last module starting at or below the address is the only candidate
+	std::vector<uint64_t>::const_iterator it = std::upper_bound(resolver->m_moduleBases.begin(), resolver->m_moduleBases.end(), _address);
+	if (it == resolver->m_moduleBases.begin())
+		return 0;
+
+	const size_t index = (it - resolver->m_moduleBases.begin()) - 1;
+	if (_address - resolver->m_moduleBases[index] > resolver->m_moduleSizes[index])
+		return 0;
+
+	return &resolver->m_modules[index];
+}
+
+inline const Module* addressGetModule(uintptr_t _resolver, uint64_t _address, uint64_t _operationTime)
+{
+	const Resolver* resolver = (Resolver*)_resolver;
+
+	std::vector<uint64_t>::const_iterator it = std::upper_bound(resolver->m_segmentStarts.begin(), resolver->m_segmentStarts.end(), _address);
+	if (it == resolver->m_segmentStarts.begin())
+		return 0;
+
+	const size_t seg = (it - resolver->m_segmentStarts.begin()) - 1;
+	std::vector<uint64_t>::const_iterator first	= resolver->m_segmentLoadTimes.begin() + resolver->m_segmentFirst[seg];
+	std::vector<uint64_t>::const_iterator last	= resolver->m_segmentLoadTimes.begin() + resolver->m_segmentFirst[seg + 1];
+
+	// last module loaded at or before the operation, earlier ones at this address were unloaded by then
+	std::vector<uint64_t>::const_iterator loaded = std::upper_bound(first, last, _operationTime);
+	if (loaded == first)
+		return 0;
+
+	const Module& module = resolver->m_modules[resolver->m_segmentModules[loaded - resolver->m_segmentLoadTimes.begin() - 1]];
+	return module.m_module.checkAddressAndTime(_address, _operationTime) ? &module : 0;
+}
 
-	while (minIndex <= maxIndex)
+/// Publishes lazily built object, if another thread got there first its object is kept and ours is released
+template <typename T>
+static T* publishOnce(std::atomic<T*>& _ptr, T* _object)
+{
+	T* published = 0;
+	if (_ptr.compare_exchange_strong(published, _object, std::memory_order_acq_rel, std::memory_order_acquire))
+		return _object;
+
+	rtm_delete<T>(_object);
+	return published;
+}
+
+/// Opens module image for native symbol and debug info access, returns 0 if it's not an ELF image
+static ElfFile* moduleGetElf(const Module* _module)
+{
+	ResolveInfo* info = _module->m_resolver;
+	ElfFile* elf = info->m_elfFile.load(std::memory_order_acquire);
+	if (!elf)
 	{
-		uint32_t curIndex = minIndex + (maxIndex - minIndex ) / 2;
+		elf = rtm_new<ElfFile>();
+		if (toolchainIsGNU(_module->m_module.m_toolchain.m_type) && info->m_debugFilePath)
+			elf->load(info->m_debugFilePath);
 
-		const Module& module = resolver->m_modules[curIndex];
-		if (module.m_module.checkAddress(_address))
-			return &module;
+		elf = publishOnce(info->m_elfFile, elf);
+	}
+	return elf->isLoaded() ? elf : 0;
+}
 
-		if (_address < module.m_module.m_baseAddress)
-			maxIndex = curIndex - 1;
+/// Maps module's symbol cache file, returns 0 if caching is off or there is no valid file yet
+static const SymbolCache* moduleGetCache(const Module* _module)
+{
+	ResolveInfo* info = _module->m_resolver;
+	if (!info->m_symbolCache)
+		return 0;
+
+	SymbolCache* cache = info->m_cache.load(std::memory_order_acquire);
+	if (!cache)
+	{
+		cache = rtm_new<SymbolCache>();
+
+		char path[4096];
+		if (SymbolCache::getPath(info->m_symbolCache, info->m_debugFilePath, moduleGetElf(_module), path, RTM_NUM_ELEMENTS(path)))
+			cache->load(path);
+
+		cache = publishOnce(info->m_cache, cache);
+	}
+	return cache->isLoaded() ? cache : 0;
+}
+
+static const SymbolMap* moduleGetSymbolMap(const Module* _module);
+static const DwarfLineTable* moduleGetLineTable(const Module* _module);
+static DwarfUnitIndex* moduleGetUnitIndex(const Module* _module);
+
+/// Writes freshly built tables to the symbol cache. Lines are only included when the whole line table is
+/// needed anyway, images with a unit index decode units as addresses hit them and cache symbols alone.
+static void moduleSaveCache(const Module* _module)
+{
+	ResolveInfo* info = _module->m_resolver;
+	if (!info->m_symbolCache || moduleGetCache(_module) || info->m_cacheSaved.exchange(true))
+		return;
+
+	const SymbolMap* symbolMap = moduleGetSymbolMap(_module);
+	if (symbolMap->empty())
+		return;
+
+	DwarfLineTable noLines;
+	const DwarfLineTable* lineTable = &noLines;
+	if (!moduleGetUnitIndex(_module))
+	{
+		moduleGetLineTable(_module);
+		lineTable = info->m_lineTable.load(std::memory_order_acquire);
+	}
+
+	char path[4096];
+	if (SymbolCache::getPath(info->m_symbolCache, info->m_debugFilePath, moduleGetElf(_module), path, RTM_NUM_ELEMENTS(path)))
+		SymbolCache::save(path, *symbolMap, *lineTable);
+}
+
+static const SymbolMap* moduleGetSymbolMap(const Module* _module)
+{
+	ResolveInfo* info = _module->m_resolver;
+	SymbolMap* symbolMap = info->m_symbolMap.load(std::memory_order_acquire);
+	if (symbolMap)
+		return symbolMap;
+
+	symbolMap = rtm_new<SymbolMap>();
+
+	const SymbolCache* cache = moduleGetCache(_module);
+	if (cache)
+	{
+		symbolMap->attach(cache->getSymbolTables());
+		return publishOnce(info->m_symbolMap, symbolMap);
+	}
+
+	// read the symbol table directly, no need to spawn nm and parse its output. MiniDebugInfo of stripped
+	// images is decompressed here, the cache saved below keeps the result so it's done once per build ID.
+	ElfFile* elf = moduleGetElf(_module);
+	if ((!elf || !elf->loadSymbols(*symbolMap)) && info->m_tc_nm && (rtm::strLen(info->m_tc_nm) != 0))
+	{
+		char cmdline[4096 * 2];
+		rtm::strlCpy(cmdline, RTM_NUM_ELEMENTS(cmdline), info->m_tc_nm);
+
+		// output is parsed as it's read, error messages don't parse as symbols and are skipped
+		SymbolMapReader reader;
+		reader.m_parseLine	= info->m_parseSymMapLine;
+		reader.m_symMap		= symbolMap;
+		if (processReadOutputOf(cmdline, parseSymbolMapChunk, &reader, true))
+			parseSymbolMapEnd(reader);
+	}
+
+	symbolMap = publishOnce(info->m_symbolMap, symbolMap);
+	moduleSaveCache(_module);
+	return symbolMap;
+}
+
+static const DwarfLineTable* moduleGetLineTable(const Module* _module)
+{
+	ResolveInfo* info = _module->m_resolver;
+	DwarfLineTable* lineTable = info->m_lineTable.load(std::memory_order_acquire);
+	if (!lineTable)
+	{
+		lineTable = rtm_new<DwarfLineTable>();
+
+		const SymbolCache* cache = moduleGetCache(_module);
+		if (cache)
+		{
+			lineTable->attach(cache->getLineTables());
+			lineTable = publishOnce(info->m_lineTable, lineTable);
+		}
 		else
-			minIndex = curIndex + 1;
+		{
+			ElfFile* elf = moduleGetElf(_module);
+			if (elf && !lineTable->build(*elf))
+			{
+				rtm_delete<DwarfLineTable>(lineTable);
+				lineTable = rtm_new<DwarfLineTable>();
+			}
+
+			lineTable = publishOnce(info->m_lineTable, lineTable);
+			moduleSaveCache(_module);
+		}
 	}
+	return lineTable->empty() ? 0 : lineTable;
+}
 
-	return 0;
+/// Index of compilation units, returns 0 if the image has no .debug_info. Split DWARF files are looked for next to the image.
+static DwarfUnitIndex* moduleGetUnitIndex(const Module* _module)
+{
+	ResolveInfo* info = _module->m_resolver;
+	DwarfUnitIndex* unitIndex = info->m_unitIndex.load(std::memory_order_acquire);
+	if (!unitIndex)
+	{
+		unitIndex = rtm_new<DwarfUnitIndex>();
+
+		ElfFile* elf = moduleGetElf(_module);
+		if (elf && !unitIndex->build(*elf, info->m_executablePath, g_dwarfCacheSize))
+		{
+			rtm_delete<DwarfUnitIndex>(unitIndex);
+			unitIndex = rtm_new<DwarfUnitIndex>();
+		}
+
+		unitIndex = publishOnce(info->m_unitIndex, unitIndex);
+	}
+	return unitIndex->empty() ? 0 : unitIndex;
+}
+
+/// Loads everything queries need from the module
+static void moduleLoadSymbols(const Module* _module)
+{
+	ResolveInfo* info = _module->m_resolver;
+
+	// whoever comes second waits for the first one to finish this module
+	std::lock_guard<std::mutex> lock(info->m_loadLock);
+	if (!info->m_symbolsPending.load(std::memory_order_relaxed))
+		return;
+
+#if RTM_PLATFORM_WINDOWS
+	loadPDB(*_module);
+#endif // RTM_PLATFORM_WINDOWS
+
+	if (info->m_tc_addr2line && (info->m_tc_addr2line[0] != '\0'))
+	{
+		moduleGetSymbolMap(_module);
+
+		// units are decoded as addresses hit them, whole line table is only built when there's no index
+		// to find them by
+		if (!moduleGetUnitIndex(_module))
+			moduleGetLineTable(_module);
+	}
+
+	info->m_symbolsPending.store(false, std::memory_order_release);
+}
+
+static bool moduleHasSymbols(const Module* _module)
+{
+	ResolveInfo* info = _module->m_resolver;
+#if RTM_PLATFORM_WINDOWS
+	if (info->m_PDBFile && info->m_PDBFile->isLoaded())
+		return true;
+#endif // RTM_PLATFORM_WINDOWS
+
+	const SymbolMap* symbolMap = info->m_symbolMap.load(std::memory_order_acquire);
+	return symbolMap && !symbolMap->empty();
+}
+
+/// Returns true if the module can be queried, loads its symbols first if a query is allowed to wait for them
+static bool moduleSymbolsReady(const Module* _module)
+{
+	ResolveInfo* info = _module->m_resolver;
+	if (!info->m_symbolsPending.load(std::memory_order_acquire))
+		return true;
+
+	if (info->m_skipWhilePending)
+		return false;
+
+	moduleLoadSymbols(_module);
+	return true;
+}
+
+static void moduleLoadTask(uint32_t _task, void* _userData)
+{
+	Resolver* resolver = (Resolver*)_userData;
+	if (resolver->m_stopLoading.load(std::memory_order_relaxed))
+		return;
+
+#if RTM_PLATFORM_WINDOWS
+	ComScope com;
+#endif // RTM_PLATFORM_WINDOWS
+
+	// a query may have loaded the module already, it's reported either way
+	const Module& module = resolver->m_modules[_task];
+	moduleLoadSymbols(&module);
+	if (moduleHasSymbols(&module) && resolver->m_loadCallback)
+	{
+		// progress is reported from loader threads, one module at a time
+		std::lock_guard<std::mutex> lock(resolver->m_loadCallbackLock);
+		resolver->m_loadCallback(module.m_moduleName, resolver->m_loadCallbackData);
+	}
+}
+
+static void resolverLoadSymbols(Resolver* _resolver)
+{
+	threadPoolGet()->run((uint32_t)_resolver->m_modules.size(), moduleLoadTask, _resolver);
+}
+
+static void resolverStartLoading(Resolver* _resolver, SymbolLoad::Enum _onQuery)
+{
+	for (uint32_t i=0; i<_resolver->m_modules.size(); ++i)
+	{
+		ResolveInfo* info = _resolver->m_modules[i].m_resolver;
+		info->m_symbolsPending		= true;
+		info->m_skipWhilePending	= (_onQuery == SymbolLoad::Skip);
+	}
+
+	_resolver->m_loader = std::thread(resolverLoadSymbols, _resolver);
+}
+
+/// Resolves frames from symbol table and DWARF line table of the module image, without running toolchain.
+/// Addresses are sorted, so that each table is walked once in a single forward sweep.
+static bool moduleResolveNative(const Module* _module, const uint64_t* _addresses, StackFrame* const* _frames, uint32_t _numAddresses)
+{
+	ResolveInfo* info = _module->m_resolver;
+	if (!moduleGetElf(_module))
+		return false;
+
+	const SymbolMap* symbolMap	= moduleGetSymbolMap(_module);
+	DwarfUnitIndex* unitIndex	= moduleGetUnitIndex(_module);
+
+	// mapped symbol cache may hold the whole line table, otherwise lines come from decoded units
+	const DwarfLineTable* lineTable = (!unitIndex || moduleGetCache(_module)) ? moduleGetLineTable(_module) : 0;
+
+	uint32_t symbolCursor	= 0;
+	uint32_t nodeCursor		= 0;
+	uint32_t lineCursor		= 0;
+
+	uint32_t currentUnit = DwarfUnitIndex::InvalidUnit;
+	DwarfUnitIndex::DecodedPtr decoded;
+
+	SymbolView sym;
+	for (uint32_t i=0; i<_numAddresses; ++i)
+	{
+		StackFrame& frame = *_frames[i];
+		rtm::strlCpy(frame.m_moduleName, RTM_NUM_ELEMENTS(frame.m_moduleName), info->m_executableName);
+
+		// same address space as addr2line
+		const uint64_t address = _addresses[i] - info->m_baseAddress4addr2Line;
+
+		if (symbolMap->findSymbol(address, sym, symbolCursor))
+			rtm::strlCpy(frame.m_func, RTM_NUM_ELEMENTS(frame.m_func), sym.m_name);
+
+		// sorted addresses hit units one after another, cursors are only valid within a unit
+		uint32_t unit = unitIndex ? unitIndex->findUnit(address) : DwarfUnitIndex::InvalidUnit;
+		if (unit != currentUnit)
+		{
+			currentUnit	= unit;
+			decoded		= (unit != DwarfUnitIndex::InvalidUnit) ? unitIndex->getUnit(unit) : DwarfUnitIndex::DecodedPtr();
+			nodeCursor	= 0;
+			if (!lineTable)
+				lineCursor = 0;
+		}
+
+		// line table location belongs to the innermost inlined function, report it the same way addr2line does
+		const DwarfInlineIndex* inlineIndex = decoded ? &decoded->m_inlines : 0;
+		if (inlineIndex && !inlineIndex->empty())
+		{
+			uint32_t node = inlineIndex->findNode(address, nodeCursor);
+			if ((node != DwarfInlineIndex::InvalidNode) && (inlineIndex->getNode(node).m_callFile != DwarfInlineIndex::InvalidString))
+			{
+				const char* name = inlineIndex->getString(inlineIndex->getNode(node).m_name);
+				if (name)
+					rtm::strlCpy(frame.m_func, RTM_NUM_ELEMENTS(frame.m_func), name);
+			}
+		}
+
+		const DwarfLineTable* lines = lineTable ? lineTable : (decoded ? &decoded->m_lines : 0);
+
+		const char* file;
+		uint32_t line;
+		if (lines && lines->findLine(address, file, line, lineCursor))
+		{
+			rtm::strlCpy(frame.m_file, RTM_NUM_ELEMENTS(frame.m_file), file);
+			rtm::pathCanonicalize(frame.m_file);
+			frame.m_line = line;
+		}
+	}
+
+	return true;
+}
+
+/// State of a pipelined addr2line run, answers come back in the same order the requests were written
+struct Addr2LineBatch
+{
+	const ResolveInfo*	m_info;
+	const uint64_t*		m_addresses;
+	StackFrame* const*	m_frames;
+	uint32_t			m_numAddresses;
+	uint32_t			m_current;
+	uint32_t			m_responseLine;
+	bool				m_failed;
+	std::string			m_line;
+	std::string			m_response;
+};
+
+/// Handles single line of addr2line output, returns false once there's nothing more to read
+static bool addr2LineOnLine(Addr2LineBatch& _batch)
+{
+	if (!_batch.m_line.empty() && (_batch.m_line[_batch.m_line.size() - 1] == '\r'))
+		_batch.m_line.resize(_batch.m_line.size() - 1);
+
+	switch (_batch.m_responseLine)
+	{
+	case 0:
+		// echoed address, answer must belong to the oldest outstanding request
+		if (strtoull(_batch.m_line.c_str(), 0, 16) + _batch.m_info->m_baseAddress4addr2Line != _batch.m_addresses[_batch.m_current])
+		{
+			_batch.m_failed = true;
+			return false;
+		}
+		break;
+
+	case 1:
+		_batch.m_response = _batch.m_line;
+		_batch.m_response += '\n';
+		break;
+
+	case 2:
+		{
+			_batch.m_response += _batch.m_line;
+
+			StackFrame& frame = *_batch.m_frames[_batch.m_current];
+			_batch.m_info->m_parseSym(_batch.m_response.c_str(), frame);
+			rtm::pathCanonicalize(frame.m_file);
+
+			_batch.m_responseLine = 0;
+			return ++_batch.m_current < _batch.m_numAddresses;
+		}
+	};
+
+	++_batch.m_responseLine;
+	return true;
+}
+
+static bool addr2LineOnOutput(const char* _data, uint32_t _size, void* _userData)
+{
+	Addr2LineBatch* batch = (Addr2LineBatch*)_userData;
+
+	const char* data	= _data;
+	const char* end		= _data + _size;
+	while (data < end)
+	{
+		const char* eol = (const char*)memchr(data, '\n', end - data);
+		if (!eol)
+		{
+			batch->m_line.append(data, end - data);
+			break;
+		}
+
+		batch->m_line.append(data, eol - data);
+		data = eol + 1;
+
+		if (!addr2LineOnLine(*batch))
+			return true;
+
+		batch->m_line.clear();
+	}
+
+	return false;
+}
+
+/// Resolves addresses with a long running addr2line process of the module, all the requests are streamed
+/// through it at once. Returns number of frames resolved, from the start of the array.
+static uint32_t moduleResolveAddr2Line(const Module* _module, const uint64_t* _addresses, StackFrame* const* _frames, uint32_t _numAddresses)
+{
+	ResolveInfo* info = _module->m_resolver;
+	if (!_numAddresses)
+		return 0;
+
+	// there is a single process per module, requests from different threads take turns
+	std::lock_guard<std::mutex> lock(info->m_addr2lineLock);
+
+	if (!info->m_tc_addr2lineBatch || (info->m_tc_addr2lineBatch[0] == '\0'))
+		return 0;
+
+	if (!info->m_addr2line)
+	{
+		info->m_addr2line = rtm_new<Coprocess>();
+		if (!info->m_addr2line->start(info->m_tc_addr2lineBatch))
+		{
+			// toolchain can't be started, don't try again
+			rtm_delete<Coprocess>(info->m_addr2line);
+			info->m_addr2line			= 0;
+			info->m_tc_addr2lineBatch	= 0;
+			return 0;
+		}
+	}
+
+	std::string input;
+	input.reserve(_numAddresses * 20);
+	for (uint32_t i=0; i<_numAddresses; ++i)
+	{
+		char address[32];
+		snprintf(address, sizeof(address), "0x%llx\n", (unsigned long long)(_addresses[i] - info->m_baseAddress4addr2Line));
+		input += address;
+	}
+
+	Addr2LineBatch batch;
+	batch.m_info			= info;
+	batch.m_addresses		= _addresses;
+	batch.m_frames			= _frames;
+	batch.m_numAddresses	= _numAddresses;
+	batch.m_current			= 0;
+	batch.m_responseLine	= 0;
+	batch.m_failed			= false;
+
+	if (!info->m_addr2line->transact(input.c_str(), (uint32_t)input.size(), addr2LineOnOutput, &batch) || batch.m_failed)
+	{
+		// answers can't be matched to requests anymore, start with a fresh process next time
+		rtm_delete<Coprocess>(info->m_addr2line);
+		info->m_addr2line = 0;
+	}
+
+	return batch.m_current;
 }
 
 struct StringData
@@ -687,88 +1422,333 @@ void rustDemangleCallback(const char* data, size_t len, void* opaque)
 	str->m_data[str->m_length] = '\0';
 }
 
-void symbolResolverGetFrame(uintptr_t _resolver, uint64_t _address, StackFrame* _frame)
+/// Demangles function name of a resolved frame as an Itanium C++ one, or as a Rust one if it has a Rust
+/// v0 prefix or a legacy hash. Legacy Rust names parse as C++ too, but would keep the hash as the last scope.
+static void demangleFrame(StackFrame& _frame)
 {
-	rtm::strlCpy(_frame->m_moduleName, RTM_NUM_ELEMENTS(_frame->m_moduleName), "Unknown");
-	rtm::strlCpy(_frame->m_file, RTM_NUM_ELEMENTS(_frame->m_file), "Unknown");
-	rdebug::addressToString(_address, _frame->m_func);
-	_frame->m_line = 0;
+	if (rtm::strCmp(_frame.m_func, "Unknown") == 0)
+		return;
 
-	Resolver* resolver = (Resolver*)_resolver;
-	if (!resolver)
+	StringData str;
+	if (!isRustSymbol(_frame.m_func))
+	{
+		if (cxxDemangle(_frame.m_func, str.m_data, RTM_NUM_ELEMENTS(_frame.m_func)))
+			rtm::strlCpy(_frame.m_func, RTM_NUM_ELEMENTS(_frame.m_func), str.m_data);
 		return;
+	}
 
-	const Module* module = addressGetModule(_resolver, _address);
-	if (!module)
+	if (rust_demangle_with_callback(_frame.m_func, 0, rustDemangleCallback, &str))
+		rtm::strlCpy(_frame.m_func, RTM_NUM_ELEMENTS(_frame.m_func), str.m_data);
+}
+
+static void initFrame(uint64_t _address, StackFrame& _frame)
+{
+	rtm::strlCpy(_frame.m_moduleName, RTM_NUM_ELEMENTS(_frame.m_moduleName), "Unknown");
+	rtm::strlCpy(_frame.m_file, RTM_NUM_ELEMENTS(_frame.m_file), "Unknown");
+	rdebug::addressToString(_address, _frame.m_func);
+	_frame.m_line = 0;
+}
+
+/// Resolves sorted addresses that all belong to the given module
+static void moduleResolveFrames(const Module* _module, const uint64_t* _addresses, StackFrame* const* _frames, uint32_t _numAddresses)
+{
+	ResolveInfo* info = _module->m_resolver;
+
+	if (!moduleSymbolsReady(_module))
+	{
+		// symbols are still loading, report module and offset within it
+		for (uint32_t i=0; i<_numAddresses; ++i)
+		{
+			rtm::strlCpy(_frames[i]->m_moduleName, RTM_NUM_ELEMENTS(_frames[i]->m_moduleName), _module->m_moduleName);
+			rdebug::addressToString(_addresses[i] - _module->m_module.m_baseAddress, _frames[i]->m_func);
+		}
 		return;
+	}
 
 #if RTM_PLATFORM_WINDOWS
-	if (module->m_resolver->m_PDBFile && module->m_resolver->m_PDBFile->isLoaded())
+	// frames not found in PDB are left to the toolchain, if there is one
+	std::vector<uint64_t>	notFoundAddresses;
+	std::vector<StackFrame*>	notFoundFrames;
+
+	if (info->m_PDBFile && info->m_PDBFile->isLoaded())
 	{
-		bool found = module->m_resolver->m_PDBFile->getSymbolByAddress(_address - module->m_module.m_baseAddress, *_frame);
-		rtm::strlCpy(_frame->m_moduleName, RTM_NUM_ELEMENTS(_frame->m_moduleName), rtm::pathGetFileName(module->m_module.m_modulePath));
+		for (uint32_t i=0; i<_numAddresses; ++i)
+		{
+			StackFrame& frame = *_frames[i];
+			bool found = info->m_PDBFile->getSymbolByAddress(_addresses[i] - _module->m_module.m_baseAddress, frame);
+			rtm::strlCpy(frame.m_moduleName, RTM_NUM_ELEMENTS(frame.m_moduleName), rtm::pathGetFileName(_module->m_module.m_modulePath));
 
-		StringData str;
-		if (rust_demangle_with_callback(_frame->m_func, 0, rustDemangleCallback, &str))
-			rtm::strlCpy(_frame->m_func, RTM_NUM_ELEMENTS(_frame->m_func), str.m_data);
+			StringData str;
+			if (isRustSymbol(frame.m_func) && rust_demangle_with_callback(frame.m_func, 0, rustDemangleCallback, &str))
+				rtm::strlCpy(frame.m_func, RTM_NUM_ELEMENTS(frame.m_func), str.m_data);
+
+			if (!found)
+			{
+				notFoundAddresses.push_back(_addresses[i]);
+				notFoundFrames.push_back(&frame);
+			}
+		}
 
-		if (found)
+		if (notFoundAddresses.empty())
 			return;
+
+		_addresses		= &notFoundAddresses[0];
+		_frames			= &notFoundFrames[0];
+		_numAddresses	= (uint32_t)notFoundAddresses.size();
 	}
 #endif // RTM_PLATFORM_WINDOWS
 
-	if (module->m_resolver->m_tc_addr2line && (module->m_resolver->m_tc_addr2line[0] != '\0'))
+	if (!info->m_tc_addr2line || (info->m_tc_addr2line[0] == '\0'))
+		return;
+
+	if (!moduleResolveNative(_module, _addresses, _frames, _numAddresses))
 	{
-		rtm::strlCpy(_frame->m_moduleName, RTM_NUM_ELEMENTS(_frame->m_moduleName), module->m_resolver->m_executableName);
+		for (uint32_t i=0; i<_numAddresses; ++i)
+			rtm::strlCpy(_frames[i]->m_moduleName, RTM_NUM_ELEMENTS(_frames[i]->m_moduleName), info->m_executableName);
 
-		constexpr int MAX_CMDLINE_SIZE = 16384 + 8192;
-		char cmdline[MAX_CMDLINE_SIZE];
-	#if RTM_PLATFORM_WINDOWS && RTM_COMPILER_MSVC
-		sprintf_s(cmdline, MAX_CMDLINE_SIZE, module->m_resolver->m_tc_addr2line, _address - module->m_resolver->m_baseAddress4addr2Line);
-	#else
-		snprintf(cmdline, MAX_CMDLINE_SIZE, module->m_resolver->m_tc_addr2line, _address - module->m_resolver->m_baseAddress4addr2Line);
-	#endif
-		char* procOut = processGetOutputOf(cmdline, true);
-		if (procOut && !rtm::strStr(procOut, "No such file"))
+		// whatever the coprocess couldn't answer is resolved by running the toolchain for each address
+		for (uint32_t i=moduleResolveAddr2Line(_module, _addresses, _frames, _numAddresses); i<_numAddresses; ++i)
 		{
-			module->m_resolver->m_parseSym(&procOut[0], *_frame);
-			rtm::pathCanonicalize(_frame->m_file);
+			constexpr int MAX_CMDLINE_SIZE = 16384 + 8192;
+			char cmdline[MAX_CMDLINE_SIZE];
+
+		#if RTM_PLATFORM_WINDOWS && RTM_COMPILER_MSVC
+			sprintf_s(cmdline, MAX_CMDLINE_SIZE, info->m_tc_addr2line, (unsigned long long)(_addresses[i] - info->m_baseAddress4addr2Line));
+		#else
+			snprintf(cmdline, MAX_CMDLINE_SIZE, info->m_tc_addr2line, (unsigned long long)(_addresses[i] - info->m_baseAddress4addr2Line));
+		#endif
+			char* procOut = processGetOutputOf(cmdline, true);
+			if (procOut && !rtm::strStr(procOut, "No such file"))
+			{
+				info->m_parseSym(&procOut[0], *_frames[i]);
+				rtm::pathCanonicalize(_frames[i]->m_file);
+			}
 			processReleaseOutput(procOut);
 		}
+	}
 
-		if (rtm::strCmp(_frame->m_func, "Unknown") != 0)
-			if (rtm::strLen(module->m_resolver->m_tc_cppfilt) != 0)
+	for (uint32_t i=0; i<_numAddresses; ++i)
+		demangleFrame(*_frames[i]);
+}
+
+void symbolResolverGetFrame(uintptr_t _resolver, uint64_t _address, StackFrame* _frame)
+{
+	initFrame(_address, *_frame);
+
+	Resolver* resolver = (Resolver*)_resolver;
+	if (!resolver)
+		return;
+
+	const Module* module = addressGetModule(_resolver, _address);
+	if (!module)
+		return;
+
+	moduleResolveFrames(module, &_address, &_frame, 1);
+}
+
+void symbolResolverGetFrameAtTime(uintptr_t _resolver, uint64_t _address, uint64_t _operationTime, StackFrame* _frame)
+{
+	initFrame(_address, *_frame);
+
+	Resolver* resolver = (Resolver*)_resolver;
+	if (!resolver)
+		return;
+
+	const Module* module = addressGetModule(_resolver, _address, _operationTime);
+	if (!module)
+		return;
+
+	moduleResolveFrames(module, &_address, &_frame, 1);
+}
+
+/// Addresses of a batch sorted and deduplicated, each with the frame it is resolved into
+struct FrameBatch
+{
+	/// Contiguous run of addresses belonging to a single module
+	struct Task
+	{
+		const Module*	m_module;
+		uint32_t		m_start;
+		uint32_t		m_count;
+	};
+
+	const uint64_t*				m_inAddresses;
+	StackFrame*					m_inFrames;
+	uint32_t					m_numInAddresses;
+	std::vector<uint32_t>		m_order;
+	std::vector<uint64_t>		m_addresses;
+	std::vector<StackFrame*>	m_frames;
+	std::vector<Task>			m_tasks;
+
+	FrameBatch(uintptr_t _resolver, const uint64_t* _addresses, StackFrame* _frames, uint32_t _numAddresses, uint32_t _maxTaskSize)
+		: m_inAddresses(_addresses)
+		, m_inFrames(_frames)
+		, m_numInAddresses(_numAddresses)
+	{
+		// sort indices by address, equal addresses end up next to each other and are resolved only once
+		m_order.resize(_numAddresses);
+		for (uint32_t i=0; i<_numAddresses; ++i)
+			m_order[i] = i;
+
+		std::sort(m_order.begin(), m_order.end(),
+			[_addresses](uint32_t a, uint32_t b)
 			{
-#if RTM_PLATFORM_WINDOWS && RTM_COMPILER_MSVC
-				sprintf_s(cmdline, MAX_CMDLINE_SIZE, "%s%s", module->m_resolver->m_tc_cppfilt, _frame->m_func);
-#else
-				snprintf(cmdline, MAX_CMDLINE_SIZE, "%s%s", module->m_resolver->m_tc_cppfilt, _frame->m_func);
-#endif
-				procOut = processGetOutputOf(cmdline, true);
-				if (procOut)
-				{
-					size_t len = rtm::strLen(procOut);
-					size_t s = 0;
-					while (s < len)
-					{
-						if ((procOut[s] == '\r') ||
-							(procOut[s] == '\n'))
-						{
-							procOut[s] = 0;
-							break;
-						}
-						++s;
-					}
-					rtm::strlCpy(_frame->m_func, RTM_NUM_ELEMENTS(_frame->m_func), procOut);
+				return _addresses[a] < _addresses[b];
+			});
 
-					StringData str;
-					if (rust_demangle_with_callback(_frame->m_func, 0, rustDemangleCallback, &str))
-						rtm::strlCpy(_frame->m_func, RTM_NUM_ELEMENTS(_frame->m_func), str.m_data);
+		m_addresses.reserve(_numAddresses);
+		m_frames.reserve(_numAddresses);
 
-					processReleaseOutput(procOut);
-				}
+		for (uint32_t i=0; i<_numAddresses; ++i)
+		{
+			const uint64_t address = _addresses[m_order[i]];
+			if (m_addresses.empty() || (m_addresses.back() != address))
+			{
+				initFrame(address, _frames[m_order[i]]);
+				m_addresses.push_back(address);
+				m_frames.push_back(&_frames[m_order[i]]);
+			}
+		}
+
+		if (!_resolver)
+			return;
+
+		// modules are sorted by base address too, so each one gets a contiguous run of addresses
+		uint32_t start = 0;
+		while (start < m_addresses.size())
+		{
+			const Module* module = addressGetModule(_resolver, m_addresses[start]);
+
+			uint32_t end = start + 1;
+			while ((end < m_addresses.size()) && (end - start < _maxTaskSize) && (addressGetModule(_resolver, m_addresses[end]) == module))
+				++end;
+
+			if (module)
+			{
+				Task task = { module, start, end - start };
+				m_tasks.push_back(task);
 			}
+
+			start = end;
+		}
+	}
+
+	void resolve(uint32_t _task)
+	{
+		const Task& task = m_tasks[_task];
+		moduleResolveFrames(task.m_module, &m_addresses[task.m_start], &m_frames[task.m_start], task.m_count);
+	}
+
+	/// Duplicates get a copy of the frame resolved for the first occurrence
+	void copyDuplicates()
+	{
+		const StackFrame* resolved = 0;
+		for (uint32_t i=0; i<m_numInAddresses; ++i)
+		{
+			StackFrame& frame = m_inFrames[m_order[i]];
+			if (i && (m_inAddresses[m_order[i]] == m_inAddresses[m_order[i-1]]))
+				frame = *resolved;
+			else
+				resolved = &frame;
+		}
+	}
+};
+
+void symbolResolverGetFrames(uintptr_t _resolver, const uint64_t* _addresses, StackFrame* _frames, uint32_t _numAddresses)
+{
+	if (!_addresses || !_frames || (_numAddresses == 0))
+		return;
+
+	FrameBatch batch(_resolver, _addresses, _frames, _numAddresses, 0xffffffff);
+	for (uint32_t i=0; i<batch.m_tasks.size(); ++i)
+		batch.resolve(i);
+
+	batch.copyDuplicates();
+}
+
+static void resolveFrameBatchTask(uint32_t _task, void* _userData)
+{
+	((FrameBatch*)_userData)->resolve(_task);
+}
+
+void symbolResolverGetFramesParallel(uintptr_t _resolver, const uint64_t* _addresses, StackFrame* _frames, uint32_t _numAddresses, uint32_t _numThreads)
+{
+	if (!_addresses || !_frames || (_numAddresses == 0))
+		return;
+
+	// modules are split into chunks small enough to balance the load, but big enough for the sorted sweep to pay off
+	const uint32_t MAX_TASK_SIZE = 4096;
+
+	FrameBatch batch(_resolver, _addresses, _frames, _numAddresses, MAX_TASK_SIZE);
+
+	threadPoolGet()->run((uint32_t)batch.m_tasks.size(), resolveFrameBatchTask, &batch, _numThreads);
+
+	batch.copyDuplicates();
+}
+
+uint32_t symbolResolverGetInlineFrames(uintptr_t _resolver, uint64_t _address, StackFrame* _frames, uint32_t _maxFrames)
+{
+	if (!_frames || (_maxFrames == 0))
+		return 0;
+
+	symbolResolverGetFrame(_resolver, _address, &_frames[0]);
+
+	const Module* module = addressGetModule(_resolver, _address);
+	if (!module || !moduleSymbolsReady(module) || !module->m_resolver->m_tc_addr2line || (module->m_resolver->m_tc_addr2line[0] == '\0'))
+		return 1;
+
+	DwarfUnitIndex* unitIndex = moduleGetUnitIndex(module);
+	if (!unitIndex)
+		return 1;
+
+	const uint64_t address = _address - module->m_resolver->m_baseAddress4addr2Line;
+
+	// held until the frames are filled, eviction can't pull the strings away
+	const uint32_t unit = unitIndex->findUnit(address);
+	DwarfUnitIndex::DecodedPtr decoded = (unit != DwarfUnitIndex::InvalidUnit) ? unitIndex->getUnit(unit) : DwarfUnitIndex::DecodedPtr();
+	if (!decoded)
+		return 1;
+
+	const DwarfInlineIndex* inlineIndex = &decoded->m_inlines;
+
+	uint32_t numFrames = 1;
+	uint32_t node = inlineIndex->findNode(address);
+	while ((node != DwarfInlineIndex::InvalidNode) && (numFrames < _maxFrames))
+	{
+		const DwarfInlineIndex::Node& callee = inlineIndex->getNode(node);
+		if (callee.m_callFile == DwarfInlineIndex::InvalidString)
+			break;	// reached the outermost (not inlined) function
+
+		// caller frame, location is the call site of the inlined function
+		StackFrame& frame = _frames[numFrames++];
+		rtm::strlCpy(frame.m_moduleName, RTM_NUM_ELEMENTS(frame.m_moduleName), _frames[0].m_moduleName);
+		rtm::strlCpy(frame.m_file, RTM_NUM_ELEMENTS(frame.m_file), inlineIndex->getString(callee.m_callFile));
+		rtm::pathCanonicalize(frame.m_file);
+		frame.m_line = callee.m_callLine;
+		rdebug::addressToString(_address, frame.m_func);
+
+		// outermost function is named from symbol table, same as in the first frame
+		const char* name = 0;
+		if (callee.m_parent != DwarfInlineIndex::InvalidNode)
+		{
+			const DwarfInlineIndex::Node& caller = inlineIndex->getNode(callee.m_parent);
+			if (caller.m_callFile != DwarfInlineIndex::InvalidString)
+				name = inlineIndex->getString(caller.m_name);
+		}
+
+		SymbolView sym;
+		if (!name && moduleGetSymbolMap(module)->findSymbol(address, sym))
+			rtm::strlCpy(frame.m_func, RTM_NUM_ELEMENTS(frame.m_func), sym.m_name);
+		else
+		if (name)
+			rtm::strlCpy(frame.m_func, RTM_NUM_ELEMENTS(frame.m_func), name);
+
+		demangleFrame(frame);
+
+		node = callee.m_parent;
 	}
+
+	return numFrames;
 }
 
 uint64_t symbolResolverGetAddressID(uintptr_t _resolver, uint64_t _address)
@@ -784,6 +1764,9 @@ uint64_t symbolResolverGetAddressID(uintptr_t _resolver, uint64_t _address)
 	if (module->m_isRTMdll)
 		return 0;
 
+	if (!moduleSymbolsReady(module))
+		return _address;
+
 #if RTM_PLATFORM_WINDOWS
 	if (module->m_resolver->m_PDBFile)
 	{
@@ -792,26 +1775,9 @@ uint64_t symbolResolverGetAddressID(uintptr_t _resolver, uint64_t _address)
 	}
 #endif // RTM_PLATFORM_WINDOWS
 
-	if (module->m_resolver->m_tc_nm && (rtm::strLen(module->m_resolver->m_tc_nm) != 0) && (!module->m_resolver->m_symbolMapInitialized))
-	{
-		char cmdline[4096 * 2];
-		rtm::strlCpy(cmdline, RTM_NUM_ELEMENTS(cmdline), module->m_resolver->m_tc_nm);
-
-		const char* procOut = processGetOutputOf(cmdline, true);
-
-		if (procOut)
-		{
-			if (!rtm::strStr(procOut, "No such file"))
-				module->m_resolver->m_parseSymMap(procOut, module->m_resolver->m_symbolMap);
-			module->m_resolver->m_symbolMapInitialized = true;
-
-			processReleaseOutput(procOut);
-		}
-	}
-
-	rdebug::Symbol sym;;
-	if (module->m_resolver->m_symbolMap.findSymbol(_address, sym))
-		return (uint64_t)rtm::hashStr(sym.m_name.c_str());
+	uint32_t id;
+	if (moduleGetSymbolMap(module)->findSymbolID(_address, id))
+		return (uint64_t)id;
 	else
 		return _address;
 }
@@ -5,94 +5,250 @@
 
 #include <rdebug_pch.h>
 #include <rdebug/src/symbols_map.h>
+#include <rbase/inc/hash.h>
 
 #include <algorithm>
 
+#if RTM_COMPILER_MSVC
+#include <intrin.h>
+#endif // RTM_COMPILER_MSVC
+
 namespace rdebug {
 
+SymbolMap::SymbolMap()
+	: m_searchOffsets(0)
+	, m_sorted(true)
+{
+	// offset 0 is the empty string, used for symbols without a file
+	m_strings.push_back('\0');
+	memset(&m_tables, 0, sizeof(m_tables));
+}
+
+SymbolMap::~SymbolMap()
+{
+	if (m_searchOffsets)
+		rtm_free(m_searchOffsets);
+}
+
+void SymbolMap::attach(const Tables& _tables)
+{
+	m_tables = _tables;
+}
+
+uint32_t SymbolMap::addString(const char* _str, uint32_t _len)
+{
+	if (_len == 0)
+		return 0;
+
+	uint32_t offset = (uint32_t)m_strings.size();
+	m_strings.insert(m_strings.end(), _str, _str + _len);
+	m_strings.push_back('\0');
+	return offset;
+}
+
+uint32_t SymbolMap::addFile(const char* _file, uint32_t _len)
+{
+	if (_len == 0)
+		return 0;
+
+	// symbols are usually grouped by file, so the last one added is the likely match
+	if (!m_symbols.empty())
+	{
+		const char* last = &m_strings[m_symbols[m_symbols.size()-1].m_file];
+		if ((rtm::strCmp(last, _file, _len) == 0) && (last[_len] == '\0'))
+			return m_symbols[m_symbols.size()-1].m_file;
+	}
+
+	std::string file(_file, _len);
+	std::unordered_map<std::string, uint32_t>::const_iterator it = m_fileIds.find(file);
+	if (it != m_fileIds.end())
+		return it->second;
+
+	uint32_t offset = addString(_file, _len);
+	m_fileIds[file] = offset;
+	return offset;
+}
+
 void SymbolMap::addSymbol(const char* _name, int64_t _offset, uint64_t _size, uint32_t _line, const char* _file)
+{
+	addSymbol(_name, rtm::strLen(_name), _offset, _size, _line, _file, rtm::strLen(_file));
+}
+
+void SymbolMap::addSymbol(const char* _name, uint32_t _nameLen, int64_t _offset, uint64_t _size, uint32_t _line, const char* _file, uint32_t _fileLen)
 {
 	SymbolData data;
-	data.m_offset		= _offset;
-	data.m_size			= _size;
-	data.m_line			= _line;
-	data.m_stringsIndex = 0;
-	
+	data.m_offset	= _offset;
+	data.m_size		= _size < 0xffffffff ? (uint32_t)_size : 0xffffffff;
+	data.m_line		= _line;
+	data.m_file		= addFile(_file, _fileLen);
+	data.m_name		= addString(_name, _nameLen);
+	data.m_id		= 0;
+
 	if (!m_symbols.empty())
 	{
-		SymbolData& s = m_symbols[m_symbols.size()-1];
 		// same offset means same symbol, so update it instead of adding a new one
-		if (s.m_offset == _offset)
+		SymbolData& last = m_symbols[m_symbols.size()-1];
+		if (last.m_offset == _offset)
 		{
-			// reuse the same string index for the symbol with the same offset
-			data.m_stringsIndex = s.m_stringsIndex;
-			m_symbols[m_symbols.size()-1] = data;
-			m_symbolStrings[data.m_stringsIndex].m_file = _file;
-			m_symbolStrings[data.m_stringsIndex].m_name = _name;
+			last = data;
 			return;
 		}
+
+		if (_offset < last.m_offset)
+			m_sorted = false;
 	}
 
-	m_symbolStrings.push_back({ _file, _name });
-	data.m_stringsIndex = (uint32_t)m_symbolStrings.size() - 1;
 	m_symbols.push_back(data);
 }
 
-bool SymbolMap::findSymbol(uint64_t _address, Symbol& _symbol)
+void SymbolMap::getSymbol(const SymbolData& _data, SymbolView& _symbol) const
 {
-	size_t len = m_symbols.size();
+	_symbol.m_offset	= _data.m_offset;
+	_symbol.m_size		= _data.m_size;
+	_symbol.m_line		= _data.m_line;
+	_symbol.m_file		= getString(_data.m_file);
+	_symbol.m_name		= getString(_data.m_name);
+}
+
+static inline uint32_t countTrailingOnes(uint32_t _value)
+{
+#if RTM_COMPILER_MSVC
+	unsigned long idx;
+	return _BitScanForward(&idx, ~_value) ? (uint32_t)idx : 32;
+#else
+	return ~_value ? (uint32_t)__builtin_ctz(~_value) : 32;
+#endif // RTM_COMPILER_MSVC
+}
+
+static inline void prefetch(const void* _ptr)
+{
+#if RTM_COMPILER_MSVC && defined(_M_ARM64)
+	__prefetch(_ptr);
+#elif RTM_COMPILER_MSVC
+	_mm_prefetch((const char*)_ptr, _MM_HINT_T0);
+#else
+	__builtin_prefetch(_ptr);
+#endif // RTM_COMPILER_MSVC
+}
+
+const SymbolMap::SymbolData* SymbolMap::lookup(uint64_t _address) const
+{
+	const uint32_t len = m_tables.m_numSymbols;
 	if (!len)
 		return 0;
 
-	// Handle single-element case
-	if (len == 1)
+	// branchless descent, every step goes left or right so there is no early exit. The eight
+	// grandchildren three levels down are adjacent, prefetch them while the current level is compared.
+	const int64_t* offsets = m_tables.m_searchOffsets;
+	uint32_t k = 1;
+	while (k <= len)
 	{
-		SymbolData& sym = m_symbols[0];
-		if (uint64_t(_address - sym.m_offset) < sym.m_size)
-		{
-			_symbol.m_offset	= sym.m_offset;
-			_symbol.m_size		= sym.m_size;
-			_symbol.m_line		= sym.m_line;
-			_symbol.m_file		= m_symbolStrings[sym.m_stringsIndex].m_file;
-			_symbol.m_name		= m_symbolStrings[sym.m_stringsIndex].m_name;
-			return true;
-		}
-		return false;
+		prefetch((const char*)offsets + (uintptr_t)k * 8 * sizeof(int64_t));
+		k = 2 * k + (offsets[k] <= (int64_t)_address);
 	}
 
-	size_t sidx = 0;
-	size_t eidx = len - 1;
+	// undo the right turns taken after the last left one, k is then the first offset above the address
+	k >>= countTrailingOnes(k) + 1;
+	uint32_t above = k ? m_tables.m_searchIndex[k] : len;
+	if (!above || (above > len))
+		return 0;
 
-	while (eidx > sidx)
-	{
-		size_t midx = (sidx + eidx) / 2;
-		SymbolData sym = m_symbols[midx];
+	const SymbolData& sym = m_tables.m_symbols[above - 1];
+	if (uint64_t(_address - sym.m_offset) >= sym.m_size)
+		return 0;
 
-		if (sym.m_offset < (int64_t)_address)
-			sidx = midx;
-		else
-			eidx = midx;
+	return &sym;
+}
 
-		if (eidx-sidx == 1)
-		{
-			sym = m_symbols[sidx];
+static inline bool compareSymbolOffset(uint64_t _address, const SymbolMap::SymbolData& _sym)
+{
+	return (int64_t)_address < _sym.m_offset;
+}
 
-			if (uint64_t(_address - sym.m_offset) >= sym.m_size)
-			{
-				sym = m_symbols[eidx];
-				if (uint64_t(_address - sym.m_offset) >= sym.m_size)
-					return false;
-			}
+const SymbolMap::SymbolData* SymbolMap::lookup(uint64_t _address, uint32_t& _cursor) const
+{
+	const SymbolData* begin	= m_tables.m_symbols;
+	const SymbolData* end	= m_tables.m_symbols + m_tables.m_numSymbols;
+	if (begin == end)
+		return 0;
 
-			_symbol.m_offset	= sym.m_offset;
-			_symbol.m_size		= sym.m_size;
-			_symbol.m_line		= sym.m_line;
-			_symbol.m_file		= m_symbolStrings[sym.m_stringsIndex].m_file;
-			_symbol.m_name		= m_symbolStrings[sym.m_stringsIndex].m_name;
-			return true;
-		}
-	}
-	return false;
+	// symbols before the previous hit can't match, and the next address often falls in the same symbol
+	const SymbolData* first = begin + (_cursor < m_tables.m_numSymbols ? _cursor : 0);
+	const SymbolData* it;
+	if ((first + 1 < end) && (first->m_offset <= (int64_t)_address) && ((int64_t)_address < (first + 1)->m_offset))
+		it = first + 1;
+	else
+		it = std::upper_bound(first, end, _address, compareSymbolOffset);
+
+	if (it == begin)
+		return 0;
+
+	_cursor = (uint32_t)(it - begin - 1);
+
+	const SymbolData& sym = *(it - 1);
+	if (uint64_t(_address - sym.m_offset) >= sym.m_size)
+		return 0;
+
+	return &sym;
+}
+
+bool SymbolMap::findSymbol(uint64_t _address, SymbolView& _symbol) const
+{
+	const SymbolData* sym = lookup(_address);
+	if (!sym)
+		return false;
+
+	getSymbol(*sym, _symbol);
+	return true;
+}
+
+bool SymbolMap::findSymbol(uint64_t _address, SymbolView& _symbol, uint32_t& _cursor) const
+{
+	const SymbolData* sym = lookup(_address, _cursor);
+	if (!sym)
+		return false;
+
+	getSymbol(*sym, _symbol);
+	return true;
+}
+
+bool SymbolMap::findSymbolID(uint64_t _address, uint32_t& _id) const
+{
+	const SymbolData* sym = lookup(_address);
+	if (!sym)
+		return false;
+
+	_id = sym->m_id;
+	return true;
+}
+
+static inline void copySymbol(const SymbolView& _view, Symbol& _symbol)
+{
+	_symbol.m_offset	= _view.m_offset;
+	_symbol.m_size		= _view.m_size;
+	_symbol.m_line		= _view.m_line;
+	_symbol.m_file		= _view.m_file;
+	_symbol.m_name		= _view.m_name;
+}
+
+bool SymbolMap::findSymbol(uint64_t _address, Symbol& _symbol) const
+{
+	SymbolView view;
+	if (!findSymbol(_address, view))
+		return false;
+
+	copySymbol(view, _symbol);
+	return true;
+}
+
+bool SymbolMap::findSymbol(uint64_t _address, Symbol& _symbol, uint32_t& _cursor) const
+{
+	SymbolView view;
+	if (!findSymbol(_address, view, _cursor))
+		return false;
+
+	copySymbol(view, _symbol);
+	return true;
 }
 
 static inline bool sortSymbols(const SymbolMap::SymbolData& _s1, const SymbolMap::SymbolData& _s2)
@@ -105,12 +261,59 @@ static inline bool isInvalid(const SymbolMap::SymbolData& _sym)
 	return _sym.m_size == 0;
 }
 
+uint32_t SymbolMap::buildSearchIndex(uint32_t _symbol, uint32_t _node)
+{
+	// in-order walk of the implicit tree places sorted symbols in breadth first order
+	if (_node < m_searchIndex.size())
+	{
+		_symbol = buildSearchIndex(_symbol, 2 * _node);
+		m_searchOffsets[_node]	= m_symbols[_symbol].m_offset;
+		m_searchIndex[_node]	= _symbol++;
+		_symbol = buildSearchIndex(_symbol, 2 * _node + 1);
+	}
+	return _symbol;
+}
+
+void SymbolMap::buildSearchIndex()
+{
+	// slot 0 is unused so that children of node k are at 2k and 2k+1. Offsets are cache line aligned,
+	// the eight grandchildren lookup prefetches then share a single line.
+	if (m_searchOffsets)
+		rtm_free(m_searchOffsets);
+	m_searchOffsets = (int64_t*)rtm_alloc((m_symbols.size() + 1) * sizeof(int64_t), 64);
+	if (!m_searchOffsets)
+		m_symbols.clear();	// lookups find nothing rather than touch a missing index
+	else
+		memset(m_searchOffsets, 0, (m_symbols.size() + 1) * sizeof(int64_t));
+
+	m_searchIndex.assign(m_symbols.size() + 1, 0);
+	if (m_searchOffsets)
+		buildSearchIndex(0, 1);
+
+	m_tables.m_symbols			= m_symbols.empty() ? 0 : &m_symbols[0];
+	m_tables.m_strings			= &m_strings[0];
+	m_tables.m_searchOffsets	= m_searchOffsets;
+	m_tables.m_searchIndex		= &m_searchIndex[0];
+	m_tables.m_numSymbols		= (uint32_t)m_symbols.size();
+	m_tables.m_stringsSize		= (uint32_t)m_strings.size();
+}
+
 void SymbolMap::sort()
 {
+	// map is complete, interning table is not needed anymore
+	std::unordered_map<std::string, uint32_t>().swap(m_fileIds);
+
 	if (!m_symbols.size())
+	{
+		buildSearchIndex();
 		return;
+	}
+
+	// nm --numeric-sort output and ELF symbol tables arrive in order already
+	if (!m_sorted)
+		std::sort(m_symbols.begin(), m_symbols.end(), sortSymbols);
+	m_sorted = true;
 
-	std::sort(m_symbols.begin(), m_symbols.end(), sortSymbols);
 	std::vector<SymbolData>::iterator it	= m_symbols.begin();
 	std::vector<SymbolData>::iterator end	= m_symbols.end();
 
@@ -123,7 +326,8 @@ void SymbolMap::sort()
 			if (next != end)
 			{
 				SymbolData& nextSym = *(it + 1);
-				sym.m_size = nextSym.m_offset - sym.m_offset;
+				uint64_t size = nextSym.m_offset - sym.m_offset;
+				sym.m_size = size < 0xffffffff ? (uint32_t)size : 0xffffffff;
 			}
 			else
 			{
@@ -135,6 +339,15 @@ void SymbolMap::sort()
 
 	auto itInvalid = std::remove_if(m_symbols.begin(), m_symbols.end(), isInvalid);
 	m_symbols.erase(itInvalid, m_symbols.end());
+
+	// names can be kilobytes long once demangled, hash them once instead of on every ID query
+	for (size_t i=0; i<m_symbols.size(); ++i)
+		m_symbols[i].m_id = rtm::hashStr(&m_strings[m_symbols[i].m_name]);
+
+	m_symbols.shrink_to_fit();
+	m_strings.shrink_to_fit();
+
+	buildSearchIndex();
 }
 
 } // namespace rdebug
@@ -9,6 +9,7 @@
 #include <rbase/inc/containers.h>
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 namespace rdebug {
 
@@ -21,28 +22,81 @@ struct Symbol
 	std::string		m_name;
 };
 
+/// Non owning lookup result, strings point into the map's storage and stay valid while the map is alive
+struct SymbolView
+{
+	int64_t			m_offset;
+	uint64_t		m_size;
+	uint32_t		m_line;
+	const char*		m_file;
+	const char*		m_name;
+};
+
 struct SymbolMap
 {
+	/// Hot lookup data, names and file paths are offsets into the string arena
 	struct SymbolData
 	{
 		int64_t			m_offset;
-		uint64_t		m_size;
+		uint32_t		m_size;
 		uint32_t		m_line;
-		uint32_t		m_stringsIndex;
+		uint32_t		m_name;
+		uint32_t		m_file;			// interned, symbols from the same file share it
+		uint32_t		m_id;			// hash of the name, computed once the map is sorted
 	};
 
-	struct SymbolStrings
+	/// Sorted lookup tables, either owned by the vectors below or mapped from a symbol cache file
+	struct Tables
 	{
-		std::string		m_file;
-		std::string		m_name;
+		const SymbolData*	m_symbols;
+		const char*			m_strings;
+		const int64_t*		m_searchOffsets;	// m_numSymbols + 1 entries
+		const uint32_t*		m_searchIndex;		// m_numSymbols + 1 entries
+		uint32_t			m_numSymbols;
+		uint32_t			m_stringsSize;
 	};
 
-	std::vector<SymbolData>		m_symbols;
-	std::vector<SymbolStrings>	m_symbolStrings;
+	Tables										m_tables;
+	std::vector<SymbolData>						m_symbols;
+	std::vector<char>							m_strings;	// append-only arena of null terminated strings
+	std::unordered_map<std::string, uint32_t>	m_fileIds;	// interning table, released once the map is sorted
+	int64_t*									m_searchOffsets;	// symbol offsets in Eytzinger (breadth first) order, built by sort, cache line aligned
+	std::vector<uint32_t>						m_searchIndex;		// Eytzinger slot to symbol index
+	bool										m_sorted;			// symbols were added in ascending offset order so far
+
+	SymbolMap();
+	~SymbolMap();
+
+	void		addSymbol(const char* _name, int64_t _offset, uint64_t _size, uint32_t _line, const char* _file);
+	void		addSymbol(const char* _name, uint32_t _nameLen, int64_t _offset, uint64_t _size, uint32_t _line, const char* _file, uint32_t _fileLen);
+	void		sort();
+	/// Serves lookups from tables owned by someone else, they have to outlive the map
+	void		attach(const Tables& _tables);
+	const Tables& getTables() const { return m_tables; }
+	bool		empty() const { return m_tables.m_numSymbols == 0; }
+
+	bool		findSymbol(uint64_t _address, SymbolView& _symbol) const;
+	/// Same as above for a sweep over ascending addresses, _cursor starts at 0 and carries the previous hit
+	bool		findSymbol(uint64_t _address, SymbolView& _symbol, uint32_t& _cursor) const;
+	/// Precomputed ID of the symbol containing the address, same for all addresses within a function
+	bool		findSymbolID(uint64_t _address, uint32_t& _id) const;
+	/// Copying variants, for callers that keep the symbol around
+	bool		findSymbol(uint64_t _address, Symbol& _symbol) const;
+	bool		findSymbol(uint64_t _address, Symbol& _symbol, uint32_t& _cursor) const;
+
+	const char*	getString(uint32_t _offset) const { return _offset < m_tables.m_stringsSize ? &m_tables.m_strings[_offset] : ""; }
+
+	private:
+		uint32_t	addString(const char* _str, uint32_t _len);
+		uint32_t	addFile(const char* _file, uint32_t _len);
+		uint32_t	buildSearchIndex(uint32_t _symbol, uint32_t _node);
+		void		buildSearchIndex();
+		const SymbolData* lookup(uint64_t _address) const;
+		const SymbolData* lookup(uint64_t _address, uint32_t& _cursor) const;
+		void		getSymbol(const SymbolData& _data, SymbolView& _symbol) const;
 
-	void	addSymbol(const char* _name, int64_t _offset, uint64_t _size, uint32_t _line, const char* _file);
-	void	sort();
-	bool	findSymbol(uint64_t _address, Symbol& _symbol);
+		SymbolMap(const SymbolMap&);
+		SymbolMap& operator=(const SymbolMap&);
 };
 
 } // namespace rdebug
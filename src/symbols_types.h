@@ -8,38 +8,64 @@
 
 #include <rdebug/inc/rdebug.h>
 #include <rdebug/src/symbols_map.h>
-#include <rbase/inc/containers.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 class PDBFile;
 
 namespace rdebug {
 
+class ElfFile;
+class DwarfLineTable;
+class DwarfUnitIndex;
+class SymbolCache;
+class Coprocess;
+
 struct ResolveInfo
 {
 	static const uint32_t SYM_SERVER_BUFFER_SIZE = 32 * 1024;
 	static const uint32_t SCRATCH_MEM_SIZE = 64 * 1024;
 
 	typedef void(*fnParseSymbol)(const char* _buff, StackFrame& _frame);
-	typedef void(*fnParseSymbolMap)(const char* _buffer, SymbolMap& _symMap);
+	typedef void(*fnParseSymbolMapLine)(const char* _line, const char* _end, SymbolMap& _symMap);	// _end is past the last character, new line excluded
 
 	char*				m_scratch;
 	uint32_t			m_scratchPos;
 	const char*			m_tc_addr2line;
+	const char*			m_tc_addr2lineBatch;
 	const char*			m_tc_nm;
-	const char*			m_tc_cppfilt;
 	const char*			m_executablePath;
 	const char*			m_executableName;
+	const char*			m_debugFilePath;	// symbols and debug info are read from it, the image itself unless it's stripped
 #if RTM_PLATFORM_WINDOWS
 	PDBFile*			m_PDBFile;
 #endif // RTM_PLATFORM_WINDOWS
 
 	fnParseSymbol		m_parseSym;
-	fnParseSymbolMap	m_parseSymMap;
+	fnParseSymbolMapLine	m_parseSymMapLine;
 	uint64_t			m_baseAddress4addr2Line;
 	const char*			m_symbolStore;
-	SymbolMap			m_symbolMap;
-	bool				m_symbolMapInitialized;
-	const char*			m_symbolCache;
+	const char*			m_symbolCache;		// directory with symbol cache files, see symbolSetCachePath
+
+	// built on first use off to the side and published once, lookups never lock
+	std::atomic<SymbolMap*>			m_symbolMap;
+	std::atomic<ElfFile*>			m_elfFile;
+	std::atomic<DwarfLineTable*>	m_lineTable;
+	std::atomic<DwarfUnitIndex*>	m_unitIndex;	// lines and inlines of units decoded on demand
+	std::atomic<SymbolCache*>		m_cache;		// tables above are served from it if it was loaded
+	std::atomic<bool>				m_cacheSaved;
+
+	// toolchain process answers one batch of requests at a time
+	std::mutex			m_addr2lineLock;
+	Coprocess*			m_addr2line;
+
+	// symbols loaded in the background, queries check it before touching them
+	std::atomic<bool>	m_symbolsPending;
+	bool				m_skipWhilePending;	// query doesn't wait, frame gets module and offset only
+	std::mutex			m_loadLock;
 
 	ResolveInfo();
 	~ResolveInfo();
@@ -47,6 +73,15 @@ struct ResolveInfo
 	char* scratch(const char* _str);
 };
 
+/// Feeds toolchain symbol map output to a line parser as it's read, only a line split between two
+/// reads is copied. See parseSymbolMapChunk and parseSymbolMapEnd.
+struct SymbolMapReader
+{
+	ResolveInfo::fnParseSymbolMapLine	m_parseLine;
+	SymbolMap*							m_symMap;
+	std::vector<char>					m_line;
+};
+
 struct Module
 {
 	ModuleInfo		m_module;
@@ -66,11 +101,33 @@ struct Module
 
 struct Resolver
 {
-	static const uint32_t MAX_MODULES = 512;
-
-	typedef rtm::FixedArray<Module, MAX_MODULES> ModuleArray;
-
-	ModuleArray	m_modules;
+	// searched on every lookup, so kept apart from the bulky module data, sorted by base address
+	std::vector<uint64_t>	m_moduleBases;
+	std::vector<uint64_t>	m_moduleSizes;
+
+	// paths, toolchain and resolve state, same order as above
+	std::vector<Module>		m_modules;
+
+	// time aware lookup, address space is split at every module boundary and each segment
+	// lists modules that ever covered it, ordered by load time
+	std::vector<uint64_t>	m_segmentStarts;
+	std::vector<uint32_t>	m_segmentFirst;		// range of each segment in the two arrays below, one extra entry at the end
+	std::vector<uint64_t>	m_segmentLoadTimes;
+	std::vector<uint32_t>	m_segmentModules;
+
+	// background symbol loading, see symbolResolverCreateAsync
+	std::thread				m_loader;
+	std::atomic<bool>		m_stopLoading;
+	module_load_cb			m_loadCallback;
+	void*					m_loadCallbackData;
+	std::mutex				m_loadCallbackLock;
+
+	Resolver()
+	{
+		m_stopLoading		= false;
+		m_loadCallback		= 0;
+		m_loadCallbackData	= 0;
+	}
 };
 
 } // namespace rdebug
@@ -0,0 +1,260 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#include <rdebug_pch.h>
+#include <rdebug/src/thread_pool.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace rdebug {
+
+/// Range of tasks owned by a worker, front and back packed together so both ends move with a single CAS.
+/// Ranges are kept on separate cache lines.
+struct alignas(64) TaskRange
+{
+	std::atomic<uint64_t>	m_range;
+
+	TaskRange() : m_range(0) {}
+
+	static uint64_t pack(uint32_t _front, uint32_t _back) { return ((uint64_t)_back << 32) | _front; }
+
+	/// Owner takes tasks from the front
+	bool pop(uint32_t& _task)
+	{
+		uint64_t range = m_range.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			const uint32_t front	= (uint32_t)range;
+			const uint32_t back		= (uint32_t)(range >> 32);
+			if (front >= back)
+				return false;
+
+			if (m_range.compare_exchange_weak(range, pack(front + 1, back), std::memory_order_acq_rel, std::memory_order_relaxed))
+			{
+				_task = front;
+				return true;
+			}
+		}
+	}
+
+	/// Other workers take tasks from the back
+	bool steal(uint32_t& _task)
+	{
+		uint64_t range = m_range.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			const uint32_t front	= (uint32_t)range;
+			const uint32_t back		= (uint32_t)(range >> 32);
+			if (front >= back)
+				return false;
+
+			if (m_range.compare_exchange_weak(range, pack(front, back - 1), std::memory_order_acq_rel, std::memory_order_relaxed))
+			{
+				_task = back - 1;
+				return true;
+			}
+		}
+	}
+};
+
+struct ThreadPoolWorkers
+{
+	std::vector<std::thread>	m_threads;
+	TaskRange*					m_ranges;
+	std::atomic<bool>			m_busy;
+	std::mutex					m_lock;
+	std::condition_variable		m_wake;			// workers wait here for a run
+	std::condition_variable		m_done;			// run waits here for workers to finish
+	uint64_t					m_generation;	// bumped for every run
+	uint32_t					m_numWorkers;	// in the current run, calling thread included
+	uint32_t					m_numActive;	// workers still busy with the current run
+	ThreadPool::fnTask			m_task;
+	void*						m_userData;
+	bool						m_stop;
+};
+
+static void workerRun(TaskRange* _ranges, uint32_t _numWorkers, uint32_t _worker, ThreadPool::fnTask _task, void* _userData)
+{
+	uint32_t task;
+	for (;;)
+	{
+		if (_ranges[_worker].pop(task))
+		{
+			_task(task, _userData);
+			continue;
+		}
+
+		// tasks are never added, so once every range is empty the work is done
+		bool stolen = false;
+		for (uint32_t i=1; i<_numWorkers; ++i)
+		{
+			if (_ranges[(_worker + i) % _numWorkers].steal(task))
+			{
+				_task(task, _userData);
+				stolen = true;
+				break;
+			}
+		}
+
+		if (!stolen)
+			return;
+	}
+}
+
+static void workerThread(ThreadPoolWorkers* _workers, uint32_t _worker)
+{
+	uint64_t generation = 0;
+
+	std::unique_lock<std::mutex> lock(_workers->m_lock);
+	for (;;)
+	{
+		while (!_workers->m_stop && (_workers->m_generation == generation))
+			_workers->m_wake.wait(lock);
+
+		if (_workers->m_stop)
+			return;
+
+		generation = _workers->m_generation;
+		if (_worker >= _workers->m_numWorkers)
+			continue;
+
+		const uint32_t		numWorkers	= _workers->m_numWorkers;
+		ThreadPool::fnTask	task		= _workers->m_task;
+		void*				userData	= _workers->m_userData;
+
+		lock.unlock();
+		workerRun(_workers->m_ranges, numWorkers, _worker, task, userData);
+		lock.lock();
+
+		if (--_workers->m_numActive == 0)
+			_workers->m_done.notify_one();
+	}
+}
+
+ThreadPool::ThreadPool(uint32_t _numThreads)
+	: m_numThreads(_numThreads)
+{
+	if (m_numThreads == 0)
+		m_numThreads = std::thread::hardware_concurrency();
+
+	if (m_numThreads == 0)
+		m_numThreads = 1;
+
+	m_workers = rtm_new<ThreadPoolWorkers>();
+	m_workers->m_ranges		= (TaskRange*)rtm_alloc(sizeof(TaskRange) * m_numThreads, 64);
+	m_workers->m_generation	= 0;
+	m_workers->m_numWorkers	= 0;
+	m_workers->m_numActive	= 0;
+	m_workers->m_task		= 0;
+	m_workers->m_userData	= 0;
+	m_workers->m_stop		= false;
+	m_workers->m_busy.store(false, std::memory_order_relaxed);
+
+	for (uint32_t i=0; i<m_numThreads; ++i)
+		new (&m_workers->m_ranges[i]) TaskRange();
+
+	// worker 0 is the thread calling run
+	m_workers->m_threads.reserve(m_numThreads - 1);
+	for (uint32_t i=1; i<m_numThreads; ++i)
+		m_workers->m_threads.push_back(std::thread(workerThread, m_workers, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_workers->m_lock);
+		m_workers->m_stop = true;
+	}
+	m_workers->m_wake.notify_all();
+
+	for (size_t i=0; i<m_workers->m_threads.size(); ++i)
+		m_workers->m_threads[i].join();
+
+	for (uint32_t i=0; i<m_numThreads; ++i)
+		m_workers->m_ranges[i].~TaskRange();
+
+	rtm_free(m_workers->m_ranges);
+	rtm_delete<ThreadPoolWorkers>(m_workers);
+}
+
+void ThreadPool::run(uint32_t _numTasks, fnTask _task, void* _userData, uint32_t _maxThreads)
+{
+	if (_numTasks == 0)
+		return;
+
+	uint32_t numWorkers = m_numThreads < _numTasks ? m_numThreads : _numTasks;
+	if (_maxThreads && (_maxThreads < numWorkers))
+		numWorkers = _maxThreads;
+
+	bool idle = false;
+	if ((numWorkers == 1) || !m_workers->m_busy.compare_exchange_strong(idle, true, std::memory_order_acquire))
+	{
+		for (uint32_t i=0; i<_numTasks; ++i)
+			_task(i, _userData);
+		return;
+	}
+
+	TaskRange* ranges = m_workers->m_ranges;
+	for (uint32_t i=0; i<numWorkers; ++i)
+	{
+		const uint32_t front	= (uint32_t)(((uint64_t)_numTasks * i) / numWorkers);
+		const uint32_t back		= (uint32_t)(((uint64_t)_numTasks * (i + 1)) / numWorkers);
+		ranges[i].m_range.store(TaskRange::pack(front, back), std::memory_order_relaxed);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_workers->m_lock);
+		m_workers->m_task		= _task;
+		m_workers->m_userData	= _userData;
+		m_workers->m_numWorkers	= numWorkers;
+		m_workers->m_numActive	= numWorkers - 1;
+		++m_workers->m_generation;
+	}
+	m_workers->m_wake.notify_all();
+
+	workerRun(ranges, numWorkers, 0, _task, _userData);
+
+	{
+		std::unique_lock<std::mutex> lock(m_workers->m_lock);
+		while (m_workers->m_numActive)
+			m_workers->m_done.wait(lock);
+	}
+
+	m_workers->m_busy.store(false, std::memory_order_release);
+}
+
+static std::atomic<ThreadPool*>	s_threadPool(0);
+static std::mutex				s_threadPoolLock;
+
+ThreadPool* threadPoolGet()
+{
+	ThreadPool* pool = s_threadPool.load(std::memory_order_acquire);
+	if (pool)
+		return pool;
+
+	std::lock_guard<std::mutex> lock(s_threadPoolLock);
+	pool = s_threadPool.load(std::memory_order_relaxed);
+	if (!pool)
+	{
+		pool = rtm_new<ThreadPool>();
+		s_threadPool.store(pool, std::memory_order_release);
+	}
+	return pool;
+}
+
+void threadPoolShutDown()
+{
+	std::lock_guard<std::mutex> lock(s_threadPoolLock);
+	ThreadPool* pool = s_threadPool.exchange(0, std::memory_order_acq_rel);
+	if (pool)
+		rtm_delete<ThreadPool>(pool);
+}
+
+} // namespace rdebug
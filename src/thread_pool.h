@@ -0,0 +1,50 @@
+//--------------------------------------------------------------------------//
+/// Copyright 2025 Milos Tosic. All Rights Reserved.                       ///
+/// License: http://www.opensource.org/licenses/BSD-2-Clause               ///
+//--------------------------------------------------------------------------//
+
+#ifndef RTM_RDEBUG_THREAD_POOL_H
+#define RTM_RDEBUG_THREAD_POOL_H
+
+#include <rbase/inc/platform.h>
+
+namespace rdebug {
+
+struct ThreadPoolWorkers;
+
+/// Runs a set of independent tasks on worker threads. Tasks are split into contiguous ranges, one per
+/// worker, so that neighbouring tasks run on the same thread. A worker that runs out of its own tasks
+/// steals them from the end of another worker's range. Workers are started once and sleep between runs.
+class ThreadPool
+{
+	public:
+		typedef void (*fnTask)(uint32_t _task, void* _userData);
+
+	private:
+		uint32_t			m_numThreads;
+		ThreadPoolWorkers*	m_workers;
+
+	public:
+		/// Zero threads means one per hardware thread
+		ThreadPool(uint32_t _numThreads = 0);
+		~ThreadPool();
+
+		uint32_t	getNumThreads() const { return m_numThreads; }
+
+		/// Runs tasks [0, _numTasks) on at most _maxThreads threads (zero for all of them) and returns once
+		/// all are done, calling thread works too. If the pool is busy with another run, nested one from a
+		/// task included, tasks run on the calling thread alone.
+		void		run(uint32_t _numTasks, fnTask _task, void* _userData, uint32_t _maxThreads = 0);
+
+	private:
+		ThreadPool(const ThreadPool&);
+		ThreadPool& operator = (const ThreadPool&);
+};
+
+/// Pool shared by the library, started on first use and stopped by shutDown
+ThreadPool* threadPoolGet();
+void threadPoolShutDown();
+
+} // namespace rdebug
+
+#endif // RTM_RDEBUG_THREAD_POOL_H